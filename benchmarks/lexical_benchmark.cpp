@@ -0,0 +1,257 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+
+extern "C" {
+#include "../src/lexical_fsm.h"
+#include "../src/lexical_stream.h"
+}
+
+namespace ifj {
+    namespace benchmarks {
+        namespace {
+            /**
+             * Token mixes of the generated sources
+             */
+            enum CorpusMix {
+                IDENTIFIERS,
+                LITERALS,
+                COMMENTS,
+                OPERATORS,
+                CORPUS_MIX_COUNT,
+            };
+
+            const char *mix_names[CORPUS_MIX_COUNT] = {"identifiers", "literals", "comments", "operators"};
+
+            const char *words[] = {"value", "counter", "result", "index", "total", "name", "buffer", "length"};
+
+            /**
+             * Linear congruential generator, so the corpora are the same on every platform
+             */
+            class CorpusRandom {
+            public:
+                unsigned next(unsigned bound) {
+                    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+                    return (unsigned) (state >> 33) % bound;
+                }
+
+                const char *word() {
+                    return words[next(sizeof(words) / sizeof(words[0]))];
+                }
+
+            private:
+                unsigned long long state = 2022;
+            };
+
+            void append_identifiers(std::string &source, CorpusRandom &random) {
+                source += "$" + std::string(random.word()) + "_" + std::to_string(random.next(100)) + " = ";
+                if (random.next(2)) {
+                    source += std::string(random.word()) + "_function($" + random.word() + ", $" + random.word() +
+                              ");\n";
+                } else {
+                    source += "$" + std::string(random.word()) + "_" + std::to_string(random.next(100)) + ";\n";
+                }
+            }
+
+            void append_literals(std::string &source, CorpusRandom &random) {
+                source += "$" + std::string(random.word()) + " = \"" + random.word() + " " + random.word() +
+                          " \\\"quoted\\\" \\x41 \\n\" . " + std::to_string(random.next(1000000)) + " . " +
+                          std::to_string(random.next(1000)) + "." + std::to_string(random.next(1000)) + "e-" +
+                          std::to_string(random.next(10)) + " . '" + random.word() + "';\n";
+            }
+
+            void append_comments(std::string &source, CorpusRandom &random) {
+                source += "// " + std::string(random.word()) + " " + random.word() + " " + random.word() + "\n/* " +
+                          random.word() + " " + random.word() + "\n * " + random.word() + " */\n# " +
+                          random.word() + "\n$" + random.word() + " = 1;\n";
+            }
+
+            void append_operators(std::string &source, CorpusRandom &random) {
+                const char *operators[] = {"+", "-", "*", "/", ".", "===", "!==", "<", "<=", ">", ">="};
+                source += "$a=($b";
+                for (int i = 0; i < 6; i++) {
+                    source += operators[random.next(sizeof(operators) / sizeof(operators[0]))];
+                    source += "$" + std::string(1, (char) ('a' + random.next(26)));
+                }
+                source += ");\n";
+            }
+
+            /**
+             * Generates IFJ22 source of a token mix
+             * @param mix token mix
+             * @param size minimal size in bytes
+             * @return source code
+             */
+            std::string generate_corpus(CorpusMix mix, size_t size) {
+                CorpusRandom random;
+                std::string source = "<?php\ndeclare(strict_types=1);\n";
+                source.reserve(size + 256);
+
+                while (source.size() < size) {
+                    switch (mix) {
+                        case IDENTIFIERS:
+                            append_identifiers(source, random);
+                            break;
+                        case LITERALS:
+                            append_literals(source, random);
+                            break;
+                        case COMMENTS:
+                            append_comments(source, random);
+                            break;
+                        default:
+                            append_operators(source, random);
+                            break;
+                    }
+                }
+
+                return source;
+            }
+
+            /**
+             * Gets path of a generated corpus, generating it when it does not exist yet. Corpora are kept in
+             * LEXICAL_BENCHMARK_CORPUS directory (lexical_corpus by default) and have LEXICAL_BENCHMARK_SIZE bytes
+             * (16 MiB by default)
+             * @param mix token mix
+             * @return path of the corpus
+             */
+            std::string corpus_path(CorpusMix mix) {
+                const char *directory = getenv("LEXICAL_BENCHMARK_CORPUS");
+                const char *size_text = getenv("LEXICAL_BENCHMARK_SIZE");
+                size_t size = size_text != nullptr ? strtoull(size_text, nullptr, 10) : 16 << 20;
+                std::string path = std::string(directory != nullptr ? directory : "lexical_corpus") + "/" +
+                                   mix_names[mix] + "_" + std::to_string(size) + ".php";
+
+                struct stat path_stat{};
+                if (stat(path.c_str(), &path_stat) == 0) return path;
+
+                mkdir(directory != nullptr ? directory : "lexical_corpus", 0755);
+                std::string source = generate_corpus(mix, size);
+                FILE *file = fopen(path.c_str(), "wb");
+                if (file == nullptr || fwrite(source.data(), 1, source.size(), file) != source.size()) {
+                    fprintf(stderr, "Failed to write corpus %s\n", path.c_str());
+                    exit(EXIT_FAILURE);
+                }
+
+                fclose(file);
+                return path;
+            }
+
+            /**
+             * Reads whole corpus into memory
+             * @param path path of the corpus
+             * @return corpus contents
+             */
+            std::string read_corpus(const std::string &path) {
+                std::string source;
+                char buffer[1 << 16];
+                FILE *file = fopen(path.c_str(), "rb");
+                size_t read;
+
+                while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) source.append(buffer, read);
+
+                fclose(file);
+                return source;
+            }
+
+            /**
+             * Reports bytes and tokens processed per second
+             * @param state benchmark state
+             * @param bytes corpus size
+             * @param tokens number of tokens in the corpus
+             */
+            void set_throughput(benchmark::State &state, size_t bytes, size_t tokens) {
+                state.SetLabel(mix_names[state.range(0)]);
+                state.SetBytesProcessed((int64_t) (state.iterations() * bytes));
+                state.counters["tokens/s"] = benchmark::Counter((double) (state.iterations() * tokens),
+                                                                benchmark::Counter::kIsRate);
+            }
+
+            void NextToken(benchmark::State &state) {
+                std::string path = corpus_path((CorpusMix) state.range(0));
+                string_t *token = string_base_init();
+                size_t bytes = 0;
+                size_t tokens = 0;
+
+                for (auto _: state) {
+                    FILE *file = fopen(path.c_str(), "rb");
+                    tokens = 0;
+
+                    while (get_next_token(file, token) != END_OF_FILE) tokens++;
+
+                    bytes = (size_t) ftell(file);
+                    fclose(file);
+                }
+
+                set_throughput(state, bytes, tokens);
+                string_free(token);
+            }
+
+            void Token(benchmark::State &state) {
+                std::string path = corpus_path((CorpusMix) state.range(0));
+                size_t bytes = 0;
+                size_t tokens = 0;
+
+                for (auto _: state) {
+                    FILE *file = fopen(path.c_str(), "rb");
+                    lexical_token_t *token;
+                    tokens = 0;
+
+                    while ((token = get_token(file))->type != END_OF_FILE) {
+                        tokens++;
+                        free_lexical_token(token);
+                    }
+
+                    free_lexical_token(token);
+                    bytes = (size_t) ftell(file);
+                    fclose(file);
+                }
+
+                set_throughput(state, bytes, tokens);
+            }
+
+            void NextSpan(benchmark::State &state) {
+                std::string source = read_corpus(corpus_path((CorpusMix) state.range(0)));
+                size_t tokens = 0;
+
+                for (auto _: state) {
+                    lexical_source_t *lexical_source = lexical_source_from_memory(source.data(), source.size());
+                    lexical_span_t span;
+                    tokens = 0;
+
+                    while (get_next_span(lexical_source, &span) != END_OF_FILE) tokens++;
+
+                    lexical_source_close(lexical_source);
+                }
+
+                set_throughput(state, source.size(), tokens);
+            }
+
+            void Stream(benchmark::State &state) {
+                std::string source = read_corpus(corpus_path((CorpusMix) state.range(0)));
+                size_t tokens = 0;
+
+                for (auto _: state) {
+                    lexical_source_t *lexical_source = lexical_source_from_memory(source.data(), source.size());
+                    lexical_stream_t *stream = state.range(1) > 1
+                                               ? lexical_stream_init_parallel(lexical_source, state.range(1))
+                                               : lexical_stream_init(lexical_source);
+
+                    tokens = stream->count - 1;
+                    lexical_stream_free(stream);
+                    lexical_source_close(lexical_source);
+                }
+
+                set_throughput(state, source.size(), tokens);
+            }
+
+            BENCHMARK(NextToken)->DenseRange(IDENTIFIERS, OPERATORS)->Unit(benchmark::kMillisecond);
+            BENCHMARK(Token)->DenseRange(IDENTIFIERS, OPERATORS)->Unit(benchmark::kMillisecond);
+            BENCHMARK(NextSpan)->DenseRange(IDENTIFIERS, OPERATORS)->Unit(benchmark::kMillisecond);
+            BENCHMARK(Stream)->ArgsProduct({benchmark::CreateDenseRange(IDENTIFIERS, OPERATORS, 1), {1, 4}})
+                    ->Unit(benchmark::kMillisecond)->UseRealTime();
+        }
+    }
+}
@@ -0,0 +1,322 @@
+#include <benchmark/benchmark.h>
+#include <cctype>
+#include <cstring>
+#include <string>
+
+extern "C" {
+#include "../src/str.h"
+#include "../src/arena.h"
+#include "../src/lexical_fsm.h"
+#include "../src/code_generator.h"
+
+#ifdef STRING_BENCHMARK_COUNT_ALLOCS
+static size_t allocation_count = 0;
+
+void *__real_malloc(size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    allocation_count++;
+    return __real_malloc(size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    allocation_count++;
+    return __real_realloc(ptr, size);
+}
+#endif
+}
+
+namespace ifj {
+    namespace benchmarks {
+        namespace {
+            /**
+             * Counts malloc and realloc calls made by the string layer while the benchmark runs and reports them
+             * as allocs/op
+             */
+            class AllocationCounter {
+            public:
+                explicit AllocationCounter(benchmark::State &state) : state(state) {
+#ifdef STRING_BENCHMARK_COUNT_ALLOCS
+                    start = allocation_count;
+#endif
+                }
+
+                ~AllocationCounter() {
+#ifdef STRING_BENCHMARK_COUNT_ALLOCS
+                    state.counters["allocs/op"] = benchmark::Counter((double) (allocation_count - start),
+                                                                     benchmark::Counter::kAvgIterations);
+#endif
+                }
+
+            private:
+                benchmark::State &state;
+                size_t start = 0;
+            };
+
+            const char *identifier = "$variable_name_12";
+            const char *literal = "\"Hello, world!\\n\\tvalue #1 is \\\"quoted\\\" and 100% \\x41SCII\"";
+
+            /**
+             * Builds a string literal of about the given length from the sample literal
+             * @param length minimal length of the literal
+             * @return string literal with quotes
+             */
+            std::string make_literal(int64_t length) {
+                std::string data = std::string(literal).substr(0, strlen(literal) - 1);
+                while (data.length() < (size_t) length)
+                    data += "lorem ipsum #\\n";
+                return data + '"';
+            }
+
+            void AppendChar(benchmark::State &state) {
+                AllocationCounter counter(state);
+
+                for (auto _: state) {
+                    string_t *str = string_base_init();
+
+                    for (int64_t i = 0; i < state.range(0); i++)
+                        string_append_char(str, 'a');
+
+                    benchmark::DoNotOptimize(str->value);
+                    string_free(str);
+                }
+
+                state.SetComplexityN(state.range(0));
+                state.SetBytesProcessed(state.iterations() * state.range(0));
+            }
+
+            void AppendString(benchmark::State &state) {
+                AllocationCounter counter(state);
+
+                for (auto _: state) {
+                    string_t *str = string_base_init();
+
+                    for (int64_t i = 0; i < state.range(0); i += 8)
+                        string_append_string(str, "abcdefgh");
+
+                    benchmark::DoNotOptimize(str->value);
+                    string_free(str);
+                }
+
+                state.SetComplexityN(state.range(0));
+                state.SetBytesProcessed(state.iterations() * state.range(0));
+            }
+
+            void TokenBuilding(benchmark::State &state) {
+                const char *token = state.range(0) ? literal : identifier;
+                size_t length = strlen(token);
+                AllocationCounter counter(state);
+
+                for (auto _: state) {
+                    string_t *str = string_base_init();
+
+                    for (size_t i = 0; i < length; i++)
+                        string_append_char(str, token[i]);
+
+                    benchmark::DoNotOptimize(str->value);
+                    string_free(str);
+                }
+
+                state.SetBytesProcessed(state.iterations() * length);
+            }
+
+            void TempNameFormatting(benchmark::State &state) {
+                AllocationCounter counter(state);
+                int tmp_var_counter = 0;
+
+                for (auto _: state) {
+                    string_t *tmp_name = string_init("$$__TMP_");
+                    string_append_int(tmp_name, ++tmp_var_counter);
+
+                    string_t *label = string_init("$$__COND_");
+                    string_append_int(label, tmp_var_counter);
+                    STRING_APPEND_LITERAL(label, "_END");
+
+                    benchmark::DoNotOptimize(tmp_name->value);
+                    benchmark::DoNotOptimize(label->value);
+                    string_free(label);
+                    string_free(tmp_name);
+                }
+            }
+
+            void LiteralDecoding(benchmark::State &state) {
+                std::string data = make_literal(state.range(0));
+                lexical_source_t *source = lexical_source_from_memory(data.c_str(), data.length());
+                lexical_span_t span{};
+                span.type = STRING;
+                span.length = data.length();
+                AllocationCounter counter(state);
+
+                for (auto _: state) {
+                    string_t *decoded = lexical_span_string(source, &span);
+                    benchmark::DoNotOptimize(decoded->value);
+                    string_free(decoded);
+                }
+
+                state.SetBytesProcessed(state.iterations() * data.length());
+                lexical_source_close(source);
+            }
+
+            void LiteralEscaping(benchmark::State &state) {
+                std::string data = make_literal(state.range(0));
+                lexical_source_t *source = lexical_source_from_memory(data.c_str(), data.length());
+                lexical_span_t span{};
+                span.type = STRING;
+                span.length = data.length();
+                syntax_abstract_tree_t node{};
+                node.type = SYN_NODE_STRING;
+                AllocationCounter counter(state);
+
+                // the literal is decoded by the lexical analyser and escaped by the code generator
+                for (auto _: state) {
+                    node.value = lexical_span_string(source, &span);
+                    process_node_value(&node);
+                    benchmark::DoNotOptimize(node.value->value);
+                    string_free(node.value);
+                }
+
+                state.SetBytesProcessed(state.iterations() * data.length());
+                lexical_source_close(source);
+            }
+
+            void QuoteStripping(benchmark::State &state) {
+                std::string data = "\"" + std::string(state.range(0), '7') + "\"";
+                string_t *value = string_init(data.c_str());
+                AllocationCounter counter(state);
+
+                for (auto _: state) {
+                    string_t *without_quotes = string_substr(value, 1, (int) value->length - 1);
+                    benchmark::DoNotOptimize(without_quotes->value);
+                    string_free(without_quotes);
+                }
+
+                state.SetBytesProcessed(state.iterations() * state.range(0));
+                string_free(value);
+            }
+
+            void QuoteSlicing(benchmark::State &state) {
+                std::string data = "\"" + std::string(state.range(0), '7') + "\"";
+                string_t *value = string_init(data.c_str());
+                AllocationCounter counter(state);
+
+                for (auto _: state)
+                    benchmark::DoNotOptimize(string_slice(value, 1, value->length - 1));
+
+                state.SetBytesProcessed(state.iterations() * state.range(0));
+                string_free(value);
+            }
+
+            void Replace(benchmark::State &state) {
+                string_t *value = string_init("null");
+                AllocationCounter counter(state);
+
+                for (auto _: state) {
+                    string_replace(value, (char *) (state.range(0) ? "a much longer replacement value" : "nil"));
+                    benchmark::DoNotOptimize(value->value);
+                    string_replace(value, (char *) "null");
+                }
+
+                string_free(value);
+            }
+
+            void ArenaTokenBuilding(benchmark::State &state) {
+                arena_t *arena = arena_init();
+                arena_t *previous = set_compilation_arena(arena);
+                size_t length = strlen(literal);
+                AllocationCounter counter(state);
+
+                for (auto _: state) {
+                    for (int i = 0; i < 1000; i++) {
+                        string_t *str = string_base_init();
+
+                        for (size_t j = 0; j < length; j++)
+                            string_append_char(str, literal[j]);
+
+                        benchmark::DoNotOptimize(str->value);
+                        string_free(str);
+                    }
+
+                    arena_reset(arena);
+                }
+
+                state.SetBytesProcessed(state.iterations() * 1000 * length);
+                set_compilation_arena(previous);
+                arena_destroy(arena);
+            }
+
+            int to_lower(int c) {
+                return tolower(c);
+            }
+
+            void ConvertByToLower(benchmark::State &state) {
+                std::string data(state.range(0), 'K');
+                string_t *str = string_init(data.c_str());
+
+                for (auto _: state) {
+                    string_convert_by(str, to_lower);
+                    str->value[0] = 'K';
+                    benchmark::DoNotOptimize(str->value);
+                }
+
+                state.SetBytesProcessed(state.iterations() * state.range(0));
+                string_free(str);
+            }
+
+            void ToLower(benchmark::State &state) {
+                std::string data(state.range(0), 'K');
+                string_t *str = string_init(data.c_str());
+
+                for (auto _: state) {
+                    string_to_lower(str);
+                    str->value[0] = 'K';
+                    benchmark::DoNotOptimize(str->value);
+                }
+
+                state.SetBytesProcessed(state.iterations() * state.range(0));
+                string_free(str);
+            }
+
+            int is_digit(int c) {
+                return isdigit(c);
+            }
+
+            void CheckByIsDigit(benchmark::State &state) {
+                std::string data(state.range(0), '5');
+                string_t *str = string_init(data.c_str());
+
+                for (auto _: state)
+                    benchmark::DoNotOptimize(string_check_by(str, is_digit));
+
+                state.SetBytesProcessed(state.iterations() * state.range(0));
+                string_free(str);
+            }
+
+            void IsDigits(benchmark::State &state) {
+                std::string data(state.range(0), '5');
+                string_t *str = string_init(data.c_str());
+
+                for (auto _: state)
+                    benchmark::DoNotOptimize(string_is_digits(str));
+
+                state.SetBytesProcessed(state.iterations() * state.range(0));
+                string_free(str);
+            }
+
+            BENCHMARK(AppendChar)->RangeMultiplier(4)->Range(1 << 10, 1 << 23)->Complexity(benchmark::oN);
+            BENCHMARK(AppendString)->RangeMultiplier(4)->Range(1 << 10, 1 << 23)->Complexity(benchmark::oN);
+            BENCHMARK(TokenBuilding)->Arg(0)->Arg(1);
+            BENCHMARK(TempNameFormatting);
+            BENCHMARK(LiteralDecoding)->RangeMultiplier(16)->Range(64, 1 << 16);
+            BENCHMARK(LiteralEscaping)->RangeMultiplier(16)->Range(64, 1 << 16);
+            BENCHMARK(QuoteStripping)->RangeMultiplier(16)->Range(16, 1 << 16);
+            BENCHMARK(QuoteSlicing)->RangeMultiplier(16)->Range(16, 1 << 16);
+            BENCHMARK(Replace)->Arg(0)->Arg(1);
+            BENCHMARK(ArenaTokenBuilding);
+            BENCHMARK(ConvertByToLower)->RangeMultiplier(8)->Range(8, 1 << 12);
+            BENCHMARK(ToLower)->RangeMultiplier(8)->Range(8, 1 << 12);
+            BENCHMARK(CheckByIsDigit)->RangeMultiplier(8)->Range(8, 1 << 12);
+            BENCHMARK(IsDigits)->RangeMultiplier(8)->Range(8, 1 << 12);
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#include <benchmark/benchmark.h>
+#include <string>
+
+extern "C" {
+#include "../src/arena.h"
+#include "../src/symtable.h"
+#include "../src/syntax_analyzer.h"
+#include "../src/syntax_tree_pool.h"
+}
+
+namespace ifj {
+    namespace benchmarks {
+        namespace {
+            size_t visited_nodes = 0;
+
+            void count_tree_node(syntax_abstract_tree_t *tree) {
+                visited_nodes += tree->type == SYN_NODE_IDENTIFIER;
+            }
+
+            void count_pool_node(syntax_tree_pool_t *pool, syntax_node_index_t index) {
+                visited_nodes += pool->kinds[index] == 0;
+            }
+
+            /**
+             * Generates IFJ22 program with a function declaration, calls, conditions and loops on separate lines
+             * @param lines number of program lines
+             * @return source code
+             */
+            std::string generate_program(int64_t lines) {
+                std::string source = "<?php\ndeclare(strict_types=1);\n"
+                                     "function f(int $x, string $s): float {\n return $x * 1.5;\n}\n";
+
+                for (int64_t line = 5; line < lines; line += 6) {
+                    std::string index = std::to_string(line);
+                    source += "$a" + index + " = f(" + index + ", \"value " + index + "\") . 2.5;\n"
+                              "if ($a" + index + " < " + index + ") {\n"
+                              " write($a" + index + ", \"\\n\");\n"
+                              "} else {\n"
+                              " while ($a" + index + ") { $a" + index + " = $a" + index + " - 1; }\n"
+                              "}\n";
+                }
+
+                return source;
+            }
+
+            /**
+             * Parses generated program
+             * @param lines number of program lines
+             * @return syntax tree of the program
+             */
+            syntax_abstract_tree_t *parse_program(int64_t lines) {
+                std::string source = generate_program(lines);
+                lexical_source_t *lexical_source = lexical_source_from_memory(source.data(), source.size());
+                syntax_abstract_tree_t *tree = load_syntax_tree_source(lexical_source);
+                lexical_source_close(lexical_source);
+
+                return tree;
+            }
+
+            /**
+             * Counts bytes held by syntax tree nodes and their values
+             * @param tree syntax tree
+             * @return number of bytes
+             */
+            size_t tree_bytes(syntax_abstract_tree_t *tree) {
+                if (!tree) return 0;
+
+                size_t bytes = ARENA_ALIGN(sizeof(syntax_abstract_tree_t));
+                if (tree->value != NULL)
+                    bytes += sizeof(string_t) + (STRING_IS_INLINE(tree->value) ? 0 : tree->value->capacity);
+
+                if (tree->statement_count != 0)
+                    bytes += ARENA_ALIGN(tree->statement_count * sizeof(syntax_abstract_tree_t *));
+                for (uint32_t i = 0; i < tree->statement_count; i++) bytes += tree_bytes(tree->statements[i]);
+
+                return bytes + tree_bytes(tree->left) + tree_bytes(tree->middle) + tree_bytes(tree->right);
+            }
+
+            void PointerTreeWalk(benchmark::State &state) {
+                syntax_abstract_tree_t *tree = parse_program(state.range(0));
+
+                for (auto _: state) {
+                    visited_nodes = 0;
+                    process_tree_using(tree, count_tree_node, PREORDER);
+                    benchmark::DoNotOptimize(visited_nodes);
+                }
+
+                state.counters["bytes/line"] = (double) tree_bytes(tree) / (double) state.range(0);
+                dispose_syntax_trees();
+                dispose_symtable();
+            }
+
+            void PoolTreeWalk(benchmark::State &state) {
+                syntax_abstract_tree_t *tree = parse_program(state.range(0));
+                syntax_tree_pool_t *pool = syntax_tree_pool_init();
+                syntax_node_index_t root = syntax_tree_pool_from_tree(pool, tree);
+
+                for (auto _: state) {
+                    visited_nodes = 0;
+                    syntax_tree_pool_process(pool, root, count_pool_node, PREORDER);
+                    benchmark::DoNotOptimize(visited_nodes);
+                }
+
+                state.counters["bytes/line"] = (double) syntax_tree_pool_bytes(pool) / (double) state.range(0);
+                syntax_tree_pool_free(pool);
+                dispose_syntax_trees();
+                dispose_symtable();
+            }
+
+            BENCHMARK(PointerTreeWalk)->Arg(1200)->Arg(4800)->Unit(benchmark::kMicrosecond);
+            BENCHMARK(PoolTreeWalk)->Arg(1200)->Arg(4800)->Unit(benchmark::kMicrosecond);
+        }
+    }
+}
@@ -0,0 +1,158 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22.
+ * @authors
+ *   xmoise01, Nikita Moiseev
+ *
+ * @file arena.c
+ * @brief Bump-pointer arena allocator
+ * @date 17.10.2026
+ */
+
+#include "arena.h"
+#include "errors.h"
+#include <stdio.h>
+#include <string.h>
+
+#define ARENA_CHUNK_DATA(chunk) ((char *) (chunk) + ARENA_ALIGN(sizeof(arena_chunk_t)))
+
+// every thread compiles with its own arena
+static __thread arena_t *compilation_arena = NULL;
+
+/**
+ * Allocates new chunk which can hold at least size bytes and makes it arena head
+ * @param arena pointer to the arena
+ * @param size number of bytes
+ * @return pointer to the chunk, NULL if allocation failed
+ */
+static arena_chunk_t *arena_add_chunk(arena_t *arena, size_t size) {
+    size_t capacity = arena->head ? arena->head->capacity * 2 : ARENA_CHUNK_SIZE;
+    if (capacity > ARENA_MAX_CHUNK_SIZE)
+        capacity = ARENA_MAX_CHUNK_SIZE;
+    if (capacity < size)
+        capacity = size;
+
+    arena_chunk_t *chunk = (arena_chunk_t *) malloc(ARENA_ALIGN(sizeof(arena_chunk_t)) + capacity);
+    if (chunk == NULL) return NULL;
+
+    chunk->next = arena->head;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+
+    arena->head = chunk;
+    return chunk;
+}
+
+arena_t *arena_init() {
+    arena_t *arena = (arena_t *) malloc(sizeof(arena_t));
+    if (arena == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for arena");
+    }
+
+    arena->head = NULL;
+    arena->last = NULL;
+    return arena;
+}
+
+void *arena_alloc(arena_t *arena, size_t size) {
+    size = size ? ARENA_ALIGN(size) : ARENA_ALIGNMENT;
+
+    arena_chunk_t *chunk = arena->head;
+    if (chunk == NULL || chunk->capacity - chunk->used < size) {
+        chunk = arena_add_chunk(arena, size);
+        if (chunk == NULL) return NULL;
+    }
+
+    char *ptr = ARENA_CHUNK_DATA(chunk) + chunk->used;
+    chunk->used += size;
+    arena->last = ptr;
+
+    return ptr;
+}
+
+bool arena_contains(arena_t *arena, const void *ptr) {
+    const char *address = (const char *) ptr;
+
+    for (arena_chunk_t *chunk = arena->head; chunk != NULL; chunk = chunk->next) {
+        char *data = ARENA_CHUNK_DATA(chunk);
+        if (address >= data && address < data + chunk->capacity) return true;
+    }
+
+    return false;
+}
+
+void arena_reset(arena_t *arena) {
+    arena_chunk_t *largest = arena->head;
+
+    while (largest != NULL && largest->next != NULL) {
+        arena_chunk_t *chunk = largest->next;
+        largest->next = chunk->next;
+        free(chunk);
+    }
+
+    if (largest != NULL)
+        largest->used = 0;
+
+    arena->last = NULL;
+}
+
+void arena_destroy(arena_t *arena) {
+    if (arena == NULL) return;
+
+    arena_reset(arena);
+    free(arena->head);
+    free(arena);
+}
+
+arena_t *set_compilation_arena(arena_t *arena) {
+    arena_t *previous = compilation_arena;
+    compilation_arena = arena;
+    return previous;
+}
+
+arena_t *get_compilation_arena() {
+    return compilation_arena;
+}
+
+void *compilation_malloc(size_t size) {
+    if (compilation_arena == NULL) return malloc(size);
+
+    return arena_alloc(compilation_arena, size);
+}
+
+void *compilation_realloc(void *ptr, size_t old_size, size_t new_size) {
+    if (ptr == NULL) return compilation_malloc(new_size);
+
+    if (compilation_arena == NULL || !arena_contains(compilation_arena, ptr)) return realloc(ptr, new_size);
+
+    arena_chunk_t *head = compilation_arena->head;
+    if (ptr == compilation_arena->last) {
+        size_t offset = (char *) ptr - ARENA_CHUNK_DATA(head);
+        size_t size = new_size ? ARENA_ALIGN(new_size) : ARENA_ALIGNMENT;
+
+        if (head->capacity - offset >= size) {
+            head->used = offset + size;
+            return ptr;
+        }
+    }
+
+    void *new_ptr = arena_alloc(compilation_arena, new_size);
+    if (new_ptr == NULL) return NULL;
+
+    memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+    return new_ptr;
+}
+
+void compilation_free(void *ptr) {
+    if (ptr == NULL) return;
+
+    if (compilation_arena == NULL || !arena_contains(compilation_arena, ptr)) {
+        free(ptr);
+        return;
+    }
+
+    if (ptr == compilation_arena->last) {
+        arena_chunk_t *head = compilation_arena->head;
+        head->used = (char *) ptr - ARENA_CHUNK_DATA(head);
+        compilation_arena->last = NULL;
+    }
+}
@@ -0,0 +1,127 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22.
+ * @authors
+ *   xmoise01, Nikita Moiseev
+ *
+ * @file arena.h
+ * @brief Bump-pointer arena allocator
+ * @date 17.10.2026
+ */
+
+#ifndef IFJ_PROJ_ARENA_H
+#define IFJ_PROJ_ARENA_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#define ARENA_ALIGNMENT 16
+#define ARENA_CHUNK_SIZE (64 * 1024)
+#define ARENA_MAX_CHUNK_SIZE (8 * 1024 * 1024)
+
+#define ARENA_ALIGN(size) (((size) + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1))
+
+/**
+ * @struct arena_chunk_t
+ * Memory block the arena allocates from
+ *
+ * @var arena_chunk_t::next
+ * Previously allocated chunk
+ *
+ * @var arena_chunk_t::capacity
+ * Number of bytes available in the chunk
+ *
+ * @var arena_chunk_t::used
+ * Number of bytes already allocated from the chunk
+ */
+typedef struct arena_chunk {
+    struct arena_chunk *next;
+    size_t capacity;
+    size_t used;
+} arena_chunk_t;
+
+/**
+ * @struct arena_t
+ * Bump-pointer arena. Memory allocated from the arena is released all at once by arena_reset or arena_destroy
+ *
+ * @var arena_t::head
+ * Chunk the arena currently allocates from
+ *
+ * @var arena_t::last
+ * Last allocation, which can still be resized or released in place
+ */
+typedef struct arena {
+    arena_chunk_t *head;
+    char *last;
+} arena_t;
+
+/**
+ * Initializes empty arena
+ * @return pointer to the arena
+ */
+arena_t *arena_init();
+
+/**
+ * Allocates memory from the arena
+ * @param arena pointer to the arena
+ * @param size number of bytes
+ * @return pointer to the memory aligned to ARENA_ALIGNMENT, NULL if allocation failed
+ */
+void *arena_alloc(arena_t *arena, size_t size);
+
+/**
+ * Checks if memory was allocated from the arena
+ * @param arena pointer to the arena
+ * @param ptr pointer to the memory
+ * @return true if pointer belongs to one of arena chunks, false otherwise
+ */
+bool arena_contains(arena_t *arena, const void *ptr);
+
+/**
+ * Releases all memory allocated from the arena. The largest chunk is kept for next allocations
+ * @param arena pointer to the arena
+ */
+void arena_reset(arena_t *arena);
+
+/**
+ * Frees arena with all its memory
+ * @param arena pointer to the arena
+ */
+void arena_destroy(arena_t *arena);
+
+/**
+ * Sets arena used by compilation_* allocation functions of the calling thread
+ * @param arena pointer to the arena, NULL to use malloc
+ * @return previously used arena
+ */
+arena_t *set_compilation_arena(arena_t *arena);
+
+/**
+ * Gets arena used by compilation_* allocation functions of the calling thread
+ * @return pointer to the arena, NULL if malloc is used
+ */
+arena_t *get_compilation_arena();
+
+/**
+ * Allocates memory from the compilation arena, or using malloc if there is no compilation arena
+ * @param size number of bytes
+ * @return pointer to the memory, NULL if allocation failed
+ */
+void *compilation_malloc(size_t size);
+
+/**
+ * Resizes memory allocated by compilation_malloc. The last arena allocation is resized in place
+ * @param ptr pointer to the memory
+ * @param old_size current number of bytes
+ * @param new_size requested number of bytes
+ * @return pointer to the memory, NULL if allocation failed
+ */
+void *compilation_realloc(void *ptr, size_t old_size, size_t new_size);
+
+/**
+ * Frees memory allocated by compilation_malloc. Arena memory is released by arena_reset, only the last arena
+ * allocation is given back immediately
+ * @param ptr pointer to the memory
+ */
+void compilation_free(void *ptr);
+
+#endif //IFJ_PROJ_ARENA_H
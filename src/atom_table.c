@@ -0,0 +1,209 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22.
+ * @authors
+ *   xmoise01, Nikita Moiseev
+ *
+ * @file atom_table.c
+ * @brief Interned identifier names
+ * @date 17.10.2026
+ */
+
+#include "atom_table.h"
+#include "errors.h"
+#include <stdio.h>
+#include <string.h>
+
+// every thread compiles with its own table, like with its own arena
+static __thread atom_table_t *current_atom_table = NULL;
+
+static const char *predefined_atoms[ATOM_PREDEFINED_COUNT] = {
+        "", "readi", "reads", "readf", "write", "strlen", "ord", "chr", "substring", "intval", "floatval", "strval",
+        "strict_types",
+};
+
+/**
+ * Rebuilds hash slots with doubled size
+ * @param table pointer to the table
+ */
+static void atom_table_grow_slots(atom_table_t *table) {
+    size_t slot_count = table->slot_count * 2;
+    atom_t *slots = (atom_t *) calloc(slot_count, sizeof(atom_t));
+    if (slots == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for atom table");
+    }
+
+    for (atom_t atom = ATOM_NONE + 1; atom < table->count; atom++) {
+        size_t slot = table->entries[atom].hash & (slot_count - 1);
+        while (slots[slot] != ATOM_NONE) slot = (slot + 1) & (slot_count - 1);
+
+        slots[slot] = atom;
+    }
+
+    free(table->slots);
+    table->slots = slots;
+    table->slot_count = slot_count;
+}
+
+/**
+ * Appends new entry to the table
+ * @param table pointer to the table
+ * @param text name bytes
+ * @param length number of bytes
+ * @param hash hash of the name
+ * @return atom of the entry
+ */
+static atom_t atom_table_add(atom_table_t *table, const char *text, size_t length, uint32_t hash) {
+    if (table->count == table->capacity) {
+        size_t capacity = table->capacity * 2;
+        atom_entry_t *entries = (atom_entry_t *) realloc(table->entries, capacity * sizeof(atom_entry_t));
+        if (entries == NULL) {
+            INTERNAL_ERROR("Failed to allocate memory for atom table");
+        }
+
+        table->entries = entries;
+        table->capacity = capacity;
+    }
+
+    char *name = (char *) malloc(length + 1);
+    if (name == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for atom name");
+    }
+
+    memcpy(name, text, length);
+    name[length] = '\0';
+
+    atom_entry_t *entry = &table->entries[table->count];
+    entry->name = name;
+    entry->length = length;
+    entry->hash = hash;
+    entry->folded = ATOM_NONE;
+
+    return (atom_t) table->count++;
+}
+
+/**
+ * Finds slot of a name
+ * @param table pointer to the table
+ * @param text name bytes
+ * @param length number of bytes
+ * @param hash hash of the name
+ * @return slot holding atom of the name, or empty slot where it belongs
+ */
+static size_t atom_table_find_slot(const atom_table_t *table, const char *text, size_t length, uint32_t hash) {
+    size_t slot = hash & (table->slot_count - 1);
+
+    while (table->slots[slot] != ATOM_NONE) {
+        const atom_entry_t *entry = &table->entries[table->slots[slot]];
+        if (entry->hash == hash && entry->length == length && !memcmp(entry->name, text, length)) break;
+
+        slot = (slot + 1) & (table->slot_count - 1);
+    }
+
+    return slot;
+}
+
+/**
+ * Creates table with predefined atoms
+ * @return pointer to the table
+ */
+static atom_table_t *atom_table_init() {
+    atom_table_t *table = (atom_table_t *) malloc(sizeof(atom_table_t));
+    if (table == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for atom table");
+    }
+
+    table->capacity = ATOM_TABLE_MIN_SLOTS / 2;
+    table->count = 0;
+    table->entries = (atom_entry_t *) malloc(table->capacity * sizeof(atom_entry_t));
+    table->slot_count = ATOM_TABLE_MIN_SLOTS;
+    table->slots = (atom_t *) calloc(table->slot_count, sizeof(atom_t));
+    if (table->entries == NULL || table->slots == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for atom table");
+    }
+
+    // ATOM_NONE gets an entry, but no slot, so it is never returned for a name
+    atom_table_add(table, "", 0, 0);
+    for (int i = ATOM_NONE + 1; i < ATOM_PREDEFINED_COUNT; i++)
+        atom_table_intern(table, predefined_atoms[i], strlen(predefined_atoms[i]));
+
+    return table;
+}
+
+atom_table_t *atom_table_get() {
+    if (current_atom_table == NULL) current_atom_table = atom_table_init();
+
+    return current_atom_table;
+}
+
+atom_t atom_table_intern(atom_table_t *table, const char *text, size_t length) {
+    uint32_t hash = atom_hash(text, length);
+    size_t slot = atom_table_find_slot(table, text, length, hash);
+    if (table->slots[slot] != ATOM_NONE) return table->slots[slot];
+
+    // keep at most half of the slots used
+    if ((table->count + 1) * 2 > table->slot_count) {
+        atom_table_grow_slots(table);
+        slot = atom_table_find_slot(table, text, length, hash);
+    }
+
+    table->slots[slot] = atom_table_add(table, text, length, hash);
+    return table->slots[slot];
+}
+
+atom_t atom_intern(const char *text, size_t length) {
+    return atom_table_intern(atom_table_get(), text, length);
+}
+
+atom_t atom_find(const char *text, size_t length) {
+    atom_table_t *table = atom_table_get();
+
+    return table->slots[atom_table_find_slot(table, text, length, atom_hash(text, length))];
+}
+
+const char *atom_name(atom_t atom) {
+    return atom_table_get()->entries[atom].name;
+}
+
+atom_t atom_table_intern_lower(atom_table_t *table, const char *text, size_t length) {
+    size_t first_upper = 0;
+    while (first_upper < length && !(text[first_upper] >= 'A' && text[first_upper] <= 'Z')) first_upper++;
+    if (first_upper == length) return atom_table_intern(table, text, length);
+
+    char *lowercase = (char *) malloc(length + 1);
+    if (lowercase == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for atom name");
+    }
+
+    memcpy(lowercase, text, first_upper);
+    for (size_t i = first_upper; i < length; i++) {
+        char c = text[i];
+        lowercase[i] = (char) (c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+    }
+
+    atom_t atom = atom_table_intern(table, lowercase, length);
+    free(lowercase);
+
+    return atom;
+}
+
+atom_t atom_fold_case(atom_t atom) {
+    atom_table_t *table = atom_table_get();
+    if (table->entries[atom].folded != ATOM_NONE) return table->entries[atom].folded;
+
+    // interning can move the entries, so the folded atom is stored after it
+    atom_t folded = atom_table_intern_lower(table, table->entries[atom].name, table->entries[atom].length);
+    table->entries[atom].folded = folded;
+
+    return folded;
+}
+
+void atom_table_dispose() {
+    if (current_atom_table == NULL) return;
+
+    for (size_t i = 0; i < current_atom_table->count; i++) free(current_atom_table->entries[i].name);
+
+    free(current_atom_table->entries);
+    free(current_atom_table->slots);
+    free(current_atom_table);
+    current_atom_table = NULL;
+}
@@ -0,0 +1,171 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22.
+ * @authors
+ *   xmoise01, Nikita Moiseev
+ *
+ * @file atom_table.h
+ * @brief Interned identifier names
+ * @date 17.10.2026
+ */
+
+#ifndef IFJ_PROJ_ATOM_TABLE_H
+#define IFJ_PROJ_ATOM_TABLE_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#define ATOM_TABLE_MIN_SLOTS 256
+
+/**
+ * Dense identifier of an interned name. Two names are equal exactly when their atoms are equal
+ */
+typedef uint32_t atom_t;
+
+/**
+ * @enum atom_predefined
+ * Atoms interned into every table in this order, so they can be compared with constants
+ */
+typedef enum {
+    ATOM_NONE = 0,
+    ATOM_READI,
+    ATOM_READS,
+    ATOM_READF,
+    ATOM_WRITE,
+    ATOM_STRLEN,
+    ATOM_ORD,
+    ATOM_CHR,
+    ATOM_SUBSTRING,
+    ATOM_INTVAL,
+    ATOM_FLOATVAL,
+    ATOM_STRVAL,
+    ATOM_STRICT_TYPES,
+    ATOM_PREDEFINED_COUNT,
+} atom_predefined;
+
+/**
+ * @struct atom_entry_t
+ * Interned name
+ *
+ * @var atom_entry_t::name
+ * Null-terminated copy of the name
+ *
+ * @var atom_entry_t::length
+ * Length of the name
+ *
+ * @var atom_entry_t::hash
+ * Hash of the name
+ *
+ * @var atom_entry_t::folded
+ * Atom of the lowercase name, ATOM_NONE until it is requested
+ */
+typedef struct atom_entry {
+    char *name;
+    size_t length;
+    uint32_t hash;
+    atom_t folded;
+} atom_entry_t;
+
+/**
+ * @struct atom_table_t
+ * Open-addressing hash table of interned names
+ *
+ * @var atom_table_t::entries
+ * Interned names indexed by their atom, entry of ATOM_NONE is unused
+ *
+ * @var atom_table_t::count
+ * Number of entries including ATOM_NONE
+ *
+ * @var atom_table_t::capacity
+ * Number of entries the table can hold
+ *
+ * @var atom_table_t::slots
+ * Hash slots holding atoms, ATOM_NONE marks an empty slot
+ *
+ * @var atom_table_t::slot_count
+ * Number of slots, always a power of two
+ */
+typedef struct atom_table {
+    atom_entry_t *entries;
+    size_t count;
+    size_t capacity;
+    atom_t *slots;
+    size_t slot_count;
+} atom_table_t;
+
+/**
+ * Hashes a name
+ * @param text name bytes
+ * @param length number of bytes
+ * @return hash of the name
+ */
+static inline uint32_t atom_hash(const char *text, size_t length) {
+    uint32_t hash = 2166136261U;
+
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char) text[i];
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+/**
+ * Gets table of the calling thread, creating it with predefined atoms on first use
+ * @return pointer to the table
+ */
+atom_table_t *atom_table_get();
+
+/**
+ * Interns a name into a table
+ * @param table pointer to the table
+ * @param text name bytes, they are copied
+ * @param length number of bytes
+ * @return atom of the name
+ */
+atom_t atom_table_intern(atom_table_t *table, const char *text, size_t length);
+
+/**
+ * Interns lowercase form of a name into a table
+ * @param table pointer to the table
+ * @param text name bytes, they are copied
+ * @param length number of bytes
+ * @return atom of the lowercase name
+ */
+atom_t atom_table_intern_lower(atom_table_t *table, const char *text, size_t length);
+
+/**
+ * Interns a name into the table of the calling thread
+ * @param text name bytes, they are copied
+ * @param length number of bytes
+ * @return atom of the name
+ */
+atom_t atom_intern(const char *text, size_t length);
+
+/**
+ * Finds atom of a name in the table of the calling thread without interning it
+ * @param text name bytes
+ * @param length number of bytes
+ * @return atom of the name, ATOM_NONE if the name was not interned
+ */
+atom_t atom_find(const char *text, size_t length);
+
+/**
+ * Gets name of an atom
+ * @param atom atom from the table of the calling thread
+ * @return null-terminated name, valid until the table is disposed
+ */
+const char *atom_name(atom_t atom);
+
+/**
+ * Gets atom of the lowercase name of an atom
+ * @param atom atom from the table of the calling thread
+ * @return atom of the lowercase name
+ */
+atom_t atom_fold_case(atom_t atom);
+
+/**
+ * Frees table of the calling thread. Atoms of the table must not be used afterwards
+ */
+void atom_table_dispose();
+
+#endif //IFJ_PROJ_ATOM_TABLE_H
@@ -11,144 +11,244 @@
 
 #include "code_generator.h"
 #include "semantic_analyzer.h"
+#include "arena.h"
 
 void set_code_gen_output(FILE *output_fd) {
-    fd = output_fd;
+    if (output != NULL) {
+        output_buffer_flush(output);
+        output_buffer_free(output);
+    }
+
+    output = output_buffer_init(output_fd);
+}
+
+void flush_code_gen_output() {
+    output_buffer_flush(output);
+}
+
+/**
+ * Writes symbol operand preceded by space
+ * @param frame frame or constant type of symbol
+ * @param symbol symbol
+ */
+static void emit_symbol(frames_t frame, const char *symbol) {
+    output_buffer_append_char(output, ' ');
+    output_buffer_append_cstr(output, frames[frame]);
+    output_buffer_append_char(output, '@');
+    output_buffer_append_cstr(output, symbol);
+}
+
+/**
+ * Writes label operand preceded by space
+ * @param label label
+ */
+static void emit_label(const char *label) {
+    output_buffer_append_char(output, ' ');
+    output_buffer_append_cstr(output, label);
+}
+
+/**
+ * Writes instruction without operands
+ * @param instruction instruction name
+ */
+static void emit_nullary(const char *instruction) {
+    output_buffer_append_cstr(output, instruction);
+    output_buffer_append_char(output, '\n');
+}
+
+/**
+ * Writes instruction with one label operand
+ * @param instruction instruction name
+ * @param label label
+ */
+static void emit_jump(const char *instruction, const char *label) {
+    output_buffer_append_cstr(output, instruction);
+    emit_label(label);
+    output_buffer_append_char(output, '\n');
+}
+
+/**
+ * Writes instruction with one symbol operand
+ * @param instruction instruction name
+ * @param frame frame of symbol
+ * @param symbol symbol
+ */
+static void emit_unary(const char *instruction, frames_t frame, const char *symbol) {
+    output_buffer_append_cstr(output, instruction);
+    emit_symbol(frame, symbol);
+    output_buffer_append_char(output, '\n');
+}
+
+/**
+ * Writes instruction with two symbol operands
+ * @param instruction instruction name
+ * @param frame1 frame of first symbol
+ * @param symbol1 first symbol
+ * @param frame2 frame of second symbol
+ * @param symbol2 second symbol
+ */
+static void emit_binary(const char *instruction, frames_t frame1, const char *symbol1, frames_t frame2,
+                        const char *symbol2) {
+    output_buffer_append_cstr(output, instruction);
+    emit_symbol(frame1, symbol1);
+    emit_symbol(frame2, symbol2);
+    output_buffer_append_char(output, '\n');
+}
+
+/**
+ * Writes instruction with three symbol operands
+ * @param instruction instruction name
+ * @param frame1 frame of first symbol
+ * @param symbol1 first symbol
+ * @param frame2 frame of second symbol
+ * @param symbol2 second symbol
+ * @param frame3 frame of third symbol
+ * @param symbol3 third symbol
+ */
+static void emit_ternary(const char *instruction, frames_t frame1, const char *symbol1, frames_t frame2,
+                         const char *symbol2, frames_t frame3, const char *symbol3) {
+    output_buffer_append_cstr(output, instruction);
+    emit_symbol(frame1, symbol1);
+    emit_symbol(frame2, symbol2);
+    emit_symbol(frame3, symbol3);
+    output_buffer_append_char(output, '\n');
 }
 
 void generate_move(frames_t variable_frame, char *variable, frames_t symbol_frame, char *symbol) {
-    fprintf(fd, "MOVE %s@%s %s@%s\n", frames[variable_frame], variable, frames[symbol_frame], symbol);
+    emit_binary("MOVE", variable_frame, variable, symbol_frame, symbol);
 }
 
 void generate_label(char *label) {
-    fprintf(fd, "LABEL %s\n", label);
+    emit_jump("LABEL", label);
 }
 
 void generate_create_frame() {
-    fprintf(fd, "CREATEFRAME\n");
+    OUTPUT_BUFFER_APPEND_LITERAL(output, "CREATEFRAME\n");
 }
 
 void generate_push_frame() {
-    fprintf(fd, "PUSHFRAME\n");
+    OUTPUT_BUFFER_APPEND_LITERAL(output, "PUSHFRAME\n");
 }
 
 void generate_pop_frame() {
-    fprintf(fd, "POPFRAME\n");
+    OUTPUT_BUFFER_APPEND_LITERAL(output, "POPFRAME\n");
 }
 
 void generate_declaration(frames_t frame, char *variable) {
-    fprintf(fd, "DEFVAR %s@%s\n", frames[frame], variable);
+    emit_unary("DEFVAR", frame, variable);
 }
 
 void generate_call(char *label) {
-    fprintf(fd, "CALL %s\n", label);
+    emit_jump("CALL", label);
 }
 
 void generate_add_on_top(frames_t frame, char *variable) {
-    fprintf(fd, "PUSHS %s@%s\n", frames[frame], variable);
+    emit_unary("PUSHS", frame, variable);
 }
 
 void generate_pop_from_top(frames_t frame, char *variable) {
-    fprintf(fd, "POPS %s@%s\n", frames[frame], variable);
+    emit_unary("POPS", frame, variable);
 }
 
 void generate_clear_stack(frames_t frame) {
-    fprintf(fd, "LABEL clear_stack\n");
-    fprintf(fd, "MOVE %s@clear_var bool@true\n", frames[frame]);
-    fprintf(fd, "JUMPIFEQ clear_stack_end %s@clear_top_var bool@true\n", frames[frame]);
-    fprintf(fd, "POPS %s@_clear_stack\n", frames[frame]);
-    fprintf(fd, "JUMP clear_stack\n");
-    fprintf(fd, "RETURN\n");
+    OUTPUT_BUFFER_APPEND_LITERAL(output, "LABEL clear_stack\n");
+    emit_binary("MOVE", frame, "clear_var", CODE_GENERATOR_BOOL_CONSTANT, "true");
+    OUTPUT_BUFFER_APPEND_LITERAL(output, "JUMPIFEQ clear_stack_end");
+    emit_symbol(frame, "clear_top_var");
+    emit_symbol(CODE_GENERATOR_BOOL_CONSTANT, "true");
+    output_buffer_append_char(output, '\n');
+    emit_unary("POPS", frame, "_clear_stack");
+    OUTPUT_BUFFER_APPEND_LITERAL(output, "JUMP clear_stack\n");
+    OUTPUT_BUFFER_APPEND_LITERAL(output, "RETURN\n");
 }
 
 void generate_type(frames_t variable_frame, char *variable, frames_t symbol_frame, char *symbol) {
-    fprintf(fd, "TYPE %s@%s %s@%s\n", frames[variable_frame], variable, frames[symbol_frame], symbol);
+    emit_binary("TYPE", variable_frame, variable, symbol_frame, symbol);
 }
 
 void generate_operation(instructions_t instruction, frames_t result_frame, char *result, frames_t symbol1_frame,
                         char *symbol1, frames_t symbol2_frame, char *symbol2) {
     if (instruction == CODE_GEN_NOTLT_INSTRUCTION) {
-        fprintf(fd, "LT %s@%s %s@%s %s@%s\n", frames[result_frame], result, frames[symbol1_frame], symbol1,
-                frames[symbol2_frame], symbol2);
-        fprintf(fd, "NOT %s@%s %s@%s\n", frames[result_frame], result, frames[result_frame], result);
+        emit_ternary("LT", result_frame, result, symbol1_frame, symbol1, symbol2_frame, symbol2);
+        emit_binary("NOT", result_frame, result, result_frame, result);
     } else if (instruction == CODE_GEN_NOTGT_INSTRUCTION) {
-        fprintf(fd, "GT %s@%s %s@%s %s@%s\n", frames[result_frame], result, frames[symbol1_frame], symbol1,
-                frames[symbol2_frame], symbol2);
-        fprintf(fd, "NOT %s@%s %s@%s\n", frames[result_frame], result, frames[result_frame], result);
+        emit_ternary("GT", result_frame, result, symbol1_frame, symbol1, symbol2_frame, symbol2);
+        emit_binary("NOT", result_frame, result, result_frame, result);
     } else if (instruction == CODE_GEN_NOTEQ_INSTRUCTION) {
-        fprintf(fd, "EQ %s@%s %s@%s %s@%s\n", frames[result_frame], result, frames[symbol1_frame], symbol1,
-                frames[symbol2_frame], symbol2);
-        fprintf(fd, "NOT %s@%s %s@%s\n", frames[result_frame], result, frames[result_frame], result);
+        emit_ternary("EQ", result_frame, result, symbol1_frame, symbol1, symbol2_frame, symbol2);
+        emit_binary("NOT", result_frame, result, result_frame, result);
     } else if (instruction == CODE_GEN_NOT_INSTRUCTION || instruction == CODE_GEN_NOTS_INSTRUCTION ||
                instruction == CODE_GEN_STRLEN_INSTRUCTION || instruction == CODE_GEN_INT2FLOAT_INSTRUCTION ||
                instruction == CODE_GEN_FLOAT2INT_INSTRUCTION || instruction == CODE_GEN_INT2CHAR_INSTRUCTION) {
-        fprintf(fd, "%s %s@%s %s@%s\n", instructions[instruction], frames[result_frame], result, frames[symbol1_frame],
-                symbol1);
+        emit_binary(instructions[instruction], result_frame, result, symbol1_frame, symbol1);
     } else if (instruction == CODE_GEN_READI_INSTRUCTION || instruction == CODE_GEN_READF_INSTRUCTION ||
                instruction == CODE_GEN_READS_INSTRUCTION) {
-        fprintf(fd, "%s %s@%s %s\n", instructions[instruction], frames[result_frame], result,
-                instruction == CODE_GEN_READI_INSTRUCTION ? "int" : instruction == CODE_GEN_READF_INSTRUCTION ? "float"
-                                                                                                              : "string");
+        output_buffer_append_cstr(output, instructions[instruction]);
+        emit_symbol(result_frame, result);
+        emit_label(instruction == CODE_GEN_READI_INSTRUCTION ? "int" : instruction == CODE_GEN_READF_INSTRUCTION
+                                                                     ? "float" : "string");
+        output_buffer_append_char(output, '\n');
     } else if (instruction == CODE_GEN_WRITE_INSTRUCTION) {
-        fprintf(fd, "%s %s@%s\n", instructions[instruction], frames[result_frame], result);
+        emit_unary(instructions[instruction], result_frame, result);
     } else if (instruction == CODE_GEN_JUMPIFEQS_INSTRUCTION || instruction == CODE_GEN_JUMPIFNEQS_INSTRUCTION) {
-        fprintf(fd, "%s %s\n", instructions[instruction], result);
+        emit_jump(instructions[instruction], result);
     } else if (instruction == CODE_GEN_LTS_INSTRUCTION || instruction == CODE_GEN_GTS_INSTRUCTION ||
 
                instruction == CODE_GEN_EQS_INSTRUCTION || instruction == CODE_GEN_ORS_INSTRUCTION ||
                instruction == CODE_GEN_ANDS_INSTRUCTION || instruction == CODE_GEN_ADDS_INSTRUCTION ||
                instruction == CODE_GEN_SUBS_INSTRUCTION || instruction == CODE_GEN_MULS_INSTRUCTION ||
                instruction == CODE_GEN_DIVS_INSTRUCTION || instruction == CODE_GEN_IDIVS_INSTRUCTION) {
-        fprintf(fd, "%s\n", instructions[instruction]);
+        emit_nullary(instructions[instruction]);
     } else {
-        fprintf(fd, "%s %s@%s %s@%s %s@%s\n", instructions[instruction], frames[result_frame], result,
-                frames[symbol1_frame], symbol1,
-                frames[symbol2_frame], symbol2);
+        emit_ternary(instructions[instruction], result_frame, result, symbol1_frame, symbol1, symbol2_frame, symbol2);
     }
 }
 
 void generate_jump(char *label) {
-    fprintf(fd, "JUMP %s\n", label);
+    emit_jump("JUMP", label);
 }
 
 void
 generate_conditional_jump(bool is_equal, char *label, frames_t frame, char *symbol1, frames_t frame2, char *symbol2) {
-    fprintf(fd, "%s %s %s@%s %s@%s\n", is_equal ? "JUMPIFEQ" : "JUMPIFNEQ", label, frames[frame], symbol1,
-            frames[frame2], symbol2);
+    output_buffer_append_cstr(output, is_equal ? "JUMPIFEQ" : "JUMPIFNEQ");
+    emit_label(label);
+    emit_symbol(frame, symbol1);
+    emit_symbol(frame2, symbol2);
+    output_buffer_append_char(output, '\n');
 }
 
 void generate_header() {
-    fprintf(fd, ".IFJcode22\n");
+    OUTPUT_BUFFER_APPEND_LITERAL(output, ".IFJcode22\n");
 }
 
 void generate_exit(int exit_code) {
-    fprintf(fd, "EXIT int@%d\n", exit_code);
+    OUTPUT_BUFFER_APPEND_LITERAL(output, "EXIT int@");
+    output_buffer_append_int(output, exit_code);
+    output_buffer_append_char(output, '\n');
 }
 
 void generate_int_to_float(frames_t frame) {
-    fprintf(fd, "LABEL float2int\n");
-    fprintf(fd, "CREATEFRAME\n");
-    fprintf(fd, "PUSHFRAME\n");
-    fprintf(fd, "DEFVAR %s@retval1\n", frames[frame]);
-    fprintf(fd, "MOVE %s@retval1 nil@nil\n", frames[frame]);
-    fprintf(fd, "DEFVAR %s@float2int\n", frames[frame]);
-    fprintf(fd, "MOVE %s@float2int %s@1\n", frames[frame], frames[frame]);
-    fprintf(fd, "INT2FLOAT %s@retval1 %s@float2int\n", frames[frame], frames[frame]);
-    fprintf(fd, "POPFRAME\n");
-    fprintf(fd, "RETURN\n");
+    OUTPUT_BUFFER_APPEND_LITERAL(output, "LABEL float2int\n");
+    generate_create_frame();
+    generate_push_frame();
+    generate_declaration(frame, "retval1");
+    generate_move(frame, "retval1", CODE_GENERATOR_NULL_CONSTANT, "nil");
+    generate_declaration(frame, "float2int");
+    generate_move(frame, "float2int", frame, "1");
+    emit_binary("INT2FLOAT", frame, "retval1", frame, "float2int");
+    generate_end();
 }
 
 void generate_float_to_int(frames_t frame) {
-    fprintf(fd, "LABEL int2float\n");
-    fprintf(fd, "CREATEFRAME\n");
-    fprintf(fd, "PUSHFRAME\n");
-    fprintf(fd, "DEFVAR %s@retval1\n", frames[frame]);
-    fprintf(fd, "MOVE %s@retval1 nil@nil\n", frames[frame]);
-    fprintf(fd, "DEFVAR %s@int2float\n", frames[frame]);
-    fprintf(fd, "MOVE %s@int2float %s@1\n", frames[frame], frames[frame]);
-    fprintf(fd, "FLOAT2INT %s@retval1 %s@int2float\n", frames[frame], frames[frame]);
-    fprintf(fd, "POPFRAME\n");
-    fprintf(fd, "RETURN\n");
+    OUTPUT_BUFFER_APPEND_LITERAL(output, "LABEL int2float\n");
+    generate_create_frame();
+    generate_push_frame();
+    generate_declaration(frame, "retval1");
+    generate_move(frame, "retval1", CODE_GENERATOR_NULL_CONSTANT, "nil");
+    generate_declaration(frame, "int2float");
+    generate_move(frame, "int2float", frame, "1");
+    emit_binary("FLOAT2INT", frame, "retval1", frame, "int2float");
+    generate_end();
 }
 
 void generate_conversion_base(char *label, char *process_variable, char *type_variable) {
@@ -184,13 +284,13 @@ void generate_number_conversion_functions() {
                 i == 0 ? CODE_GEN_INT2FLOAT_INSTRUCTION : CODE_GEN_FLOAT2INT_INSTRUCTION;
 
         string_t *end_label = string_init(current_function->value);
-        string_append_string(end_label, "_end");
+        STRING_APPEND_LITERAL(end_label, "_end");
 
         string_t *conversion_label = string_init(current_function->value);
-        string_append_string(conversion_label, "_%s", conversion_type);
+        string_append_format(conversion_label, "_%s", conversion_type);
 
         string_t *null_conv_label = string_init(current_function->value);
-        string_append_string(null_conv_label, "_null_conv");
+        STRING_APPEND_LITERAL(null_conv_label, "_null_conv");
 
         generate_conversion_base(current_function->value, process_variable, type_variable);
 
@@ -204,7 +304,10 @@ void generate_number_conversion_functions() {
 
         generate_label(null_conv_label->value);
         string_t *zero_value = string_init("");
-        string_append_string(zero_value, i == 0 ? "%a" : "%d", 0);
+        if (i == 0)
+            string_append_format(zero_value, "%a", 0.0);
+        else
+            string_append_int(zero_value, 0);
         generate_move(
                 CODE_GENERATOR_LOCAL_FRAME,
                 process_variable,
@@ -381,15 +484,26 @@ void generate_ord() {
 }
 
 void generate_end() {
-    fprintf(fd, "POPFRAME\n");
-    fprintf(fd, "RETURN\n");
+    OUTPUT_BUFFER_APPEND_LITERAL(output, "POPFRAME\n");
+    OUTPUT_BUFFER_APPEND_LITERAL(output, "RETURN\n");
+}
+
+/**
+ * Turns node into identifier of a variable
+ * @param tree node to change
+ * @param name name of the variable
+ */
+static void replace_with_identifier(syntax_abstract_tree_t *tree, string_t *name) {
+    tree->type = SYN_NODE_IDENTIFIER;
+    tree->value = name;
+    tree->number.atom = atom_intern(name->value, name->length);
 }
 
 void generate_variable_inline_cast(syntax_abstract_tree_t *tree, data_type cast_to) {
     if (cast_to & TYPE_STRING) return;
 
     string_t *casted_string_name = string_init("");
-    string_append_string(casted_string_name, "__%s_%s", tree->value->value,
+    string_append_format(casted_string_name, "__%s_%s", tree->value->value,
                          cast_to == TYPE_INT ? "i" : cast_to == TYPE_FLOAT ? "f" : "s");
 
     insert_token(casted_string_name->value);
@@ -404,86 +518,33 @@ void generate_variable_inline_cast(syntax_abstract_tree_t *tree, data_type cast_
     generate_call(cast_to == TYPE_INT ? "intval" : cast_to == TYPE_FLOAT ? "floatval" : "strval");
     generate_pop_from_top(CODE_GENERATOR_GLOBAL_FRAME, casted_string_name->value);
 
-    tree->value = casted_string_name;
+    replace_with_identifier(tree, casted_string_name);
 }
 
 void process_node_value(syntax_abstract_tree_t *tree) {
     if (tree == NULL) return;
 
     if (tree->type == SYN_NODE_FLOAT) {
-        char *tmp = malloc(sizeof(char) * 100);
-        double d = strtod(tree->value->value, &tmp);
-        char *var_tmp = malloc(sizeof(char) * 100);
-        sprintf(var_tmp, "%a", d);
-        string_replace(tree->value, var_tmp);
+        string_clear(tree->value);
+        string_append_format(tree->value, "%a", tree->number.floating);
     } else if (tree->type == SYN_NODE_STRING) {
-        string_t *new_str = string_init("");
+        // value is already decoded by the lexical analyser, only IFJcode22 escapes are added
+        string_t *new_str = string_base_init();
         string_t *current_str = tree->value;
+        string_reserve(new_str, current_str->length);
 
-        bool contains_quotation = current_str->value[0] == '\"' || current_str->value[0] == '\'';
-        int start_end_index = contains_quotation ? 1 : 0;
-
-        bool is_backslash = false;
-
-        for (int i = start_end_index; i < tree->value->length - start_end_index; i++) {
+        for (size_t i = 0; i < current_str->length; i++) {
             char c = current_str->value[i];
 
-            if (is_backslash) {
-                switch (current_str->value[i]) {
-                    case 'a':
-                        c = '\a';
-                        break;
-                    case 'b':
-                        c = '\b';
-                        break;
-                    case 'f':
-                        c = '\f';
-                        break;
-                    case 'n':
-                        c = '\n';
-                        break;
-                    case 'r':
-                        c = '\r';
-                        break;
-                    case 't':
-                        c = '\t';
-                        break;
-                    case 'v':
-                        c = '\v';
-                        break;
-                    case '\\':
-                        c = '\\';
-                        break;
-                    case '\'':
-                        c = '\'';
-                        break;
-                    case '\"':
-                        c = '\"';
-                        break;
-                    case '?':
-                        c = '\?';
-                        break;
-                    case '0':
-                        c = '\0';
-                        break;
-                    default:
-                        i++;
-                        c = current_str->value[i];
-                        break;
-                }
-
-                is_backslash = false;
-            } else if (c == '\\') {
-                is_backslash = true;
-                continue;
-            }
-
-            if (c >= 0 && c <= 32 || c == 35 || c == 92)
-                string_append_string(new_str, "\\%03d", c);
-            else
+            if (c >= 0 && c <= 32 || c == 35 || c == 92) {
+                char escape[4] = {'\\', (char) ('0' + c / 100), (char) ('0' + c / 10 % 10), (char) ('0' + c % 10)};
+                string_append_chars(new_str, escape, sizeof(escape));
+            } else {
                 string_append_char(new_str, c);
+            }
         }
 
+        string_shrink_to_fit(new_str);
         string_free(current_str);
         tree->value = new_str;
     } else if (tree->type & SYN_NODE_KEYWORD_NULL) {
@@ -538,7 +599,7 @@ void parse_expression(syntax_abstract_tree_t *tree, string_t *result) {
 
     if (is_left_simple && !is_left_const) {
         string_t *left_var_name = string_init(tmp_var_name);
-        string_append_string(left_var_name, "%d", ++code_generator_parameters->tmp_var_counter);
+        string_append_int(left_var_name, ++code_generator_parameters->tmp_var_counter);
         if (!(is_simple && result))
             generate_declaration(CODE_GENERATOR_GLOBAL_FRAME, left_var_name->value);
         parse_expression(tree->left, is_simple && result ? result : left_var_name);
@@ -548,7 +609,7 @@ void parse_expression(syntax_abstract_tree_t *tree, string_t *result) {
 
     if (is_right_simple && !is_right_const) {
         string_t *right_var_name = string_init(tmp_var_name);
-        string_append_string(right_var_name, "%d", ++code_generator_parameters->tmp_var_counter);
+        string_append_int(right_var_name, ++code_generator_parameters->tmp_var_counter);
         if (!(is_simple && result))
             generate_declaration(CODE_GENERATOR_GLOBAL_FRAME, right_var_name->value);
 
@@ -556,8 +617,7 @@ void parse_expression(syntax_abstract_tree_t *tree, string_t *result) {
 
         if (is_function_call) {
             parse_function_call(tree->right, right_var_name);
-            tree->right->type = SYN_NODE_IDENTIFIER;
-            tree->right->value = right_var_name;
+            replace_with_identifier(tree->right, right_var_name);
         } else {
             parse_expression(tree->right, is_simple && result ? result : right_var_name);
         }
@@ -577,7 +637,7 @@ void parse_expression(syntax_abstract_tree_t *tree, string_t *result) {
 
     string_t *operation_var_name = result ? result : string_init(tmp_var_name);
     if (!result)
-        string_append_string(operation_var_name, "%d", ++code_generator_parameters->tmp_var_counter);
+        string_append_int(operation_var_name, ++code_generator_parameters->tmp_var_counter);
 
     insert_token(operation_var_name->value);
     tree_node_t *operation_var = find_token(operation_var_name->value);
@@ -598,8 +658,7 @@ void parse_expression(syntax_abstract_tree_t *tree, string_t *result) {
     if (need_inline_right_cast)
         generate_variable_inline_cast(tree->right, cast_type_to);
 
-    tree->value = operation_var_name;
-    tree->type = SYN_NODE_IDENTIFIER;
+    replace_with_identifier(tree, operation_var_name);
 
     frames_t left_frame = get_node_frame(tree->left);
     frames_t right_frame = get_node_frame(tree->right);
@@ -651,15 +710,14 @@ void parse_relational_expression(syntax_abstract_tree_t *tree, string_t *result)
     if (is_left_const && is_right_const) {
         string_t *operation_var_name = result ? result : string_init(tmp_var_name);
         if (!result) {
-            string_append_string(operation_var_name, "%d", ++code_generator_parameters->tmp_var_counter);
+            string_append_int(operation_var_name, ++code_generator_parameters->tmp_var_counter);
         }
 
         insert_token(operation_var_name->value);
         tree_node_t *operation_var = find_token(operation_var_name->value);
         operation_var->defined = true;
 
-        tree->value = operation_var_name;
-        tree->type = SYN_NODE_IDENTIFIER;
+        replace_with_identifier(tree, operation_var_name);
 
         frames_t left_frame = get_node_frame(tree->left);
         frames_t right_frame = get_node_frame(tree->right);
@@ -751,14 +809,14 @@ void parse_function_arg(syntax_abstract_tree_t *tree) {
 void parse_function_call(syntax_abstract_tree_t *tree, string_t *result) {
     if (tree->type != SYN_NODE_CALL) return;
 
-    string_convert_by(tree->left->value, tolower);
+    atom_t callee = tree->left->number.atom;
     instructions_t internal_func =
-            !strcmp(tree->left->value->value, "write") ? CODE_GEN_WRITE_INSTRUCTION :
-            !strcmp(tree->left->value->value, "readi") ? CODE_GEN_READI_INSTRUCTION :
-            !strcmp(tree->left->value->value, "readf") ? CODE_GEN_READF_INSTRUCTION :
-            !strcmp(tree->left->value->value, "reads") ? CODE_GEN_READS_INSTRUCTION :
-            !strcmp(tree->left->value->value, "strlen") ? CODE_GEN_STRLEN_INSTRUCTION :
-            !strcmp(tree->left->value->value, "chr") ? CODE_GEN_INT2CHAR_INSTRUCTION :
+            callee == ATOM_WRITE ? CODE_GEN_WRITE_INSTRUCTION :
+            callee == ATOM_READI ? CODE_GEN_READI_INSTRUCTION :
+            callee == ATOM_READF ? CODE_GEN_READF_INSTRUCTION :
+            callee == ATOM_READS ? CODE_GEN_READS_INSTRUCTION :
+            callee == ATOM_STRLEN ? CODE_GEN_STRLEN_INSTRUCTION :
+            callee == ATOM_CHR ? CODE_GEN_INT2CHAR_INSTRUCTION :
             (instructions_t) -1;
 
     code_generator_parameters->current_callee_instruction = internal_func;
@@ -827,16 +885,16 @@ void parse_loop(syntax_abstract_tree_t *tree) {
     if (tree->type != SYN_NODE_KEYWORD_WHILE) return;
 
     string_t *loop_label = string_init(loop_label_name);
-    string_append_string(loop_label, "%d", ++code_generator_parameters->loop_counter);
+    string_append_int(loop_label, ++code_generator_parameters->loop_counter);
 
     string_t *loop_cond_var = string_init(loop_label->value);
-    string_append_string(loop_cond_var, "_cond");
+    STRING_APPEND_LITERAL(loop_cond_var, "_cond");
 
     string_t *loop_start_label = string_init(loop_label->value);
-    string_append_string(loop_start_label, "_start");
+    STRING_APPEND_LITERAL(loop_start_label, "_start");
 
     string_t *loop_end_label = string_init(loop_label->value);
-    string_append_string(loop_end_label, "_end");
+    STRING_APPEND_LITERAL(loop_end_label, "_end");
 
     syntax_tree_node_type loop_type = tree->left->type;
 
@@ -844,17 +902,17 @@ void parse_loop(syntax_abstract_tree_t *tree) {
 
     parse_relational_expression(tree->left, loop_cond_var);
 
-    syntax_abstract_tree_t *body_tree = tree->right;
-    while (body_tree != NULL && body_tree->left != NULL) {
-        if (body_tree->right->type == SYN_NODE_ASSIGN) {
-            if (!find_token(body_tree->right->left->value->value)) {
-                insert_token(body_tree->right->left->value->value);
-            } else if (find_token(body_tree->right->left->value->value)->code_generator_defined == false) {
-                generate_declaration(CODE_GENERATOR_GLOBAL_FRAME, body_tree->right->left->value->value);
-                find_token(body_tree->right->left->value->value)->code_generator_defined = true;
+    // assignments are declared from the last statement, the first statement of the body is skipped
+    for (size_t i = tree->right != NULL ? tree->right->statement_count : 0; i > 1; i--) {
+        syntax_abstract_tree_t *statement = tree->right->statements[i - 1];
+        if (statement != NULL && statement->type == SYN_NODE_ASSIGN) {
+            if (!find_token(statement->left->value->value)) {
+                insert_token(statement->left->value->value);
+            } else if (find_token(statement->left->value->value)->code_generator_defined == false) {
+                generate_declaration(CODE_GENERATOR_GLOBAL_FRAME, statement->left->value->value);
+                find_token(statement->left->value->value)->code_generator_defined = true;
             }
         }
-        body_tree = body_tree->left;
     }
 
     generate_label(loop_start_label->value);
@@ -872,21 +930,26 @@ void parse_condition(syntax_abstract_tree_t *tree) {
     if (tree->type != SYN_NODE_KEYWORD_IF) return;
 
     string_t *cond_label = string_init(condition_label_name);
-    string_append_string(cond_label, "%d", ++code_generator_parameters->condition_counter);
+    string_append_int(cond_label, ++code_generator_parameters->condition_counter);
 
     string_t *condition_var = string_init(cond_label->value);
-    string_append_string(condition_var, "_cond");
+    STRING_APPEND_LITERAL(condition_var, "_cond");
 
     string_t *condition_body_label = string_init(cond_label->value);
-    string_append_string(condition_body_label, "_body");
+    STRING_APPEND_LITERAL(condition_body_label, "_body");
 
     string_t *condition_else_label = string_init(cond_label->value);
-    string_append_string(condition_else_label, "_else");
+    STRING_APPEND_LITERAL(condition_else_label, "_else");
 
     string_t *condition_end_label = string_init(cond_label->value);
-    string_append_string(condition_end_label, "_end");
+    STRING_APPEND_LITERAL(condition_end_label, "_end");
 
-    bool has_else = tree->right != NULL && tree->right->right != NULL;
+    // else block counts only when its last statement is left, else-if branch when it has an else branch
+    bool has_else = tree->right != NULL &&
+                    (tree->right->type == SYN_NODE_SEQUENCE
+                     ? tree->right->statement_count != 0 &&
+                       tree->right->statements[tree->right->statement_count - 1] != NULL
+                     : tree->right->right != NULL);
 
     generate_declaration(CODE_GENERATOR_GLOBAL_FRAME, condition_var->value);
     parse_relational_expression(tree->left, condition_var);
@@ -929,66 +992,69 @@ void parse_return(syntax_abstract_tree_t *tree) {
     generate_add_on_top(frame, tree->right->value->value);
 }
 
-void parse_func_dec(syntax_abstract_tree_t *tree) {
-    if (!tree) return;
-
-    if (tree->left) parse_func_dec(tree->left);
-
-    if (!tree->right || tree->right->type != SYN_NODE_FUNCTION_DECLARATION) return;
-
-    string_t *function_label = string_init(tree->right->left->value->value);
-
-    generate_label(function_label->value);
+/**
+ * Generates function declaration
+ * @param tree function declaration node
+ */
+static void parse_function_declaration(syntax_abstract_tree_t *tree) {
+    generate_label(tree->left->value->value);
     generate_create_frame();
     generate_push_frame();
 
-    syntax_abstract_tree_t *param_tree = tree->right->middle;
+    syntax_abstract_tree_t *param_tree = tree->middle;
     while (param_tree != NULL) {
         generate_declaration(CODE_GENERATOR_LOCAL_FRAME, param_tree->left->value->value);
         generate_pop_from_top(CODE_GENERATOR_LOCAL_FRAME, param_tree->left->value->value);
         param_tree = param_tree->right;
     }
 
-    get_semantic_state()->function_name = tree->right->left->value->value;
+    get_semantic_state()->function_name = tree->left->value->value;
     semantic_state_ptr();
     code_generator_parameters->is_in_function = true;
-    parse_tree(tree->right->right);
+    parse_tree(tree->right);
     code_generator_parameters->is_in_function = false;
 
     generate_end();
 }
 
-void parse_tree(syntax_abstract_tree_t *tree) {
+void parse_func_dec(syntax_abstract_tree_t *tree) {
     if (!tree) return;
 
-    if (tree->left) parse_tree(tree->left);
+    for (size_t i = 0; i < tree->statement_count; i++)
+        if (tree->statements[i] != NULL && tree->statements[i]->type == SYN_NODE_FUNCTION_DECLARATION)
+            parse_function_declaration(tree->statements[i]);
+}
+
+void parse_tree(syntax_abstract_tree_t *tree) {
+    if (!tree || tree->type != SYN_NODE_SEQUENCE) return;
 
-    if (tree->type != SYN_NODE_SEQUENCE) return;
+    for (size_t i = 0; i < tree->statement_count; i++) {
+        syntax_abstract_tree_t *statement = tree->statements[i];
+        if (!statement) continue;
 
-    if (tree->right) {
-        switch (tree->right->type) {
+        switch (statement->type) {
             case SYN_NODE_SEQUENCE: {
-                parse_tree(tree->right);
+                parse_tree(statement);
                 break;
             }
             case SYN_NODE_ASSIGN: {
-                parse_assign(tree->right);
+                parse_assign(statement);
                 break;
             }
             case SYN_NODE_CALL: {
-                parse_function_call(tree->right, NULL);
+                parse_function_call(statement, NULL);
                 break;
             }
             case SYN_NODE_KEYWORD_WHILE: {
-                parse_loop(tree->right);
+                parse_loop(statement);
                 break;
             }
             case SYN_NODE_KEYWORD_IF: {
-                parse_condition(tree->right);
+                parse_condition(statement);
                 break;
             }
             case SYN_NODE_KEYWORD_RETURN: {
-                parse_return(tree->right);
+                parse_return(statement);
                 break;
             }
             default:
@@ -998,7 +1064,8 @@ void parse_tree(syntax_abstract_tree_t *tree) {
 }
 
 void code_generator_init() {
-    code_generator_parameters = (code_generator_parameters_t *) malloc(sizeof(code_generator_parameters_t));
+    code_generator_parameters = (code_generator_parameters_t *) compilation_malloc(
+            sizeof(code_generator_parameters_t));
 
     code_generator_parameters->tmp_var_counter = 0;
     code_generator_parameters->condition_counter = 0;
@@ -17,11 +17,12 @@
 #include "str.h"
 #include "syntax_analyzer.h"
 #include "symtable.h"
+#include "output_buffer.h"
 
 /**
- * @brief file for writing the code
+ * @brief buffer for writing the code
  */
-static FILE *fd;
+static output_buffer_t *output;
 
 static char *tmp_var_name = "$$__TMP_";
 static char *loop_label_name = "$$__LOOP_";
@@ -115,6 +116,11 @@ static code_generator_parameters_t *code_generator_parameters;
 
 void set_code_gen_output(FILE *output_fd);
 
+/**
+ * Writes buffered code to the output file
+ */
+void flush_code_gen_output();
+
 /**
  * Generates move instruction
  * @param variable_frame frame of variable
@@ -11,377 +11,1139 @@
  */
 
 #include "lexical_fsm.h"
+#include "arena.h"
 #include "symtable.h"
 
-int state = START;
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+static __thread FILE *file_source_file = NULL;
+static __thread lexical_source_t *file_source = NULL;
+
+/**
+ * Gets source reading a file for the FILE based compatibility functions. The source is kept until the whole file is
+ * tokenized or another file is passed to the same thread
+ * @param fd file to read
+ * @return pointer to the source
+ */
+static lexical_source_t *get_file_source(FILE *fd) {
+    if (file_source != NULL && file_source_file == fd) return file_source;
+
+    lexical_source_close(file_source);
+    file_source = lexical_source_open(fd);
+    file_source_file = fd;
+    return file_source;
+}
+
+/**
+ * Releases source of a file when it was tokenized to the end
+ * @param token_type last token type
+ */
+static void release_file_source(LEXICAL_FSM_TOKENS token_type) {
+    if (token_type != END_OF_FILE) return;
+
+    lexical_source_close(file_source);
+    file_source = NULL;
+    file_source_file = NULL;
+}
 
 LEXICAL_FSM_TOKENS get_next_token(FILE *fd, string_t *token) {
-    char current_char = (char) getc(fd);
+    LEXICAL_FSM_TOKENS token_type = get_next_token_source(get_file_source(fd), token);
+    release_file_source(token_type);
+    return token_type;
+}
+
+/**
+ * Byte classes of the transition table. Bytes that no state tells apart share a class
+ */
+typedef enum LEXICAL_FSM_CHAR_CLASSES {
+    CHAR_OTHER,
+    CHAR_SPACE,
+    CHAR_NEWLINE,
+    CHAR_NUL,
+    CHAR_EOF,
+    CHAR_HIGH,
+    CHAR_ALPHA,
+    CHAR_E,
+    CHAR_P,
+    CHAR_H,
+    CHAR_DIGIT,
+    CHAR_UNDERSCORE,
+    CHAR_DOLLAR,
+    CHAR_QUESTION,
+    CHAR_EQUAL,
+    CHAR_EXCLAMATION,
+    CHAR_AMPERSAND,
+    CHAR_PIPE,
+    CHAR_PLUS,
+    CHAR_MINUS,
+    CHAR_ASTERISK,
+    CHAR_SLASH,
+    CHAR_LESS,
+    CHAR_GREATER,
+    CHAR_DOT,
+    CHAR_DOUBLE_QUOTE,
+    CHAR_SINGLE_QUOTE,
+    CHAR_BACKSLASH,
+    CHAR_HASH,
+    CHAR_PUNCTUATION,
+    CHAR_CLASSES_COUNT,
+} LEXICAL_FSM_CHAR_CLASSES;
+
+/**
+ * Actions of the transition table. They are numbered after the states, so a table cell is either the next state
+ * or an action. Apart from ACTION_RETURN_CHAR and ACTION_END_OF_FILE, actions do not consume the current byte
+ */
+typedef enum LEXICAL_FSM_ACTIONS {
+    // Return accept token of the current state
+    ACTION_RETURN = LEXICAL_FSM_STATES_COUNT,
+    // Consume the byte and return single character token
+    ACTION_RETURN_CHAR,
+    ACTION_END_OF_FILE,
+    // Return keyword or continue as identifier
+    ACTION_KEYWORD,
+    // Scan integer or float literal
+    ACTION_NUMBER,
+    ACTION_PHP_BRACKET,
+    ACTION_CLOSE_PHP_BRACKET,
+
+    // Lexical errors
+    ERROR_UNEXPECTED_CHAR,
+    ERROR_IDENTIFIER,
+    ERROR_PHP_BRACKET,
+    ERROR_OPERATOR,
+    ERROR_ARITHMETIC,
+    ERROR_STRING,
+    ERROR_END_OF_FILE,
+    ERROR_INTEGER,
+    ERROR_FLOAT,
+} LEXICAL_FSM_ACTIONS;
+
+#define OT CHAR_OTHER
+#define SP CHAR_SPACE
+#define NL CHAR_NEWLINE
+#define NU CHAR_NUL
+#define EO CHAR_EOF
+#define HI CHAR_HIGH
+#define AL CHAR_ALPHA
+#define EE CHAR_E
+#define PP CHAR_P
+#define HH CHAR_H
+#define DG CHAR_DIGIT
+#define US CHAR_UNDERSCORE
+#define DL CHAR_DOLLAR
+#define QM CHAR_QUESTION
+#define EQ CHAR_EQUAL
+#define EX CHAR_EXCLAMATION
+#define AM CHAR_AMPERSAND
+#define VB CHAR_PIPE
+#define PS CHAR_PLUS
+#define MN CHAR_MINUS
+#define AS CHAR_ASTERISK
+#define SL CHAR_SLASH
+#define LS CHAR_LESS
+#define GR CHAR_GREATER
+#define DT CHAR_DOT
+#define DQ CHAR_DOUBLE_QUOTE
+#define SQ CHAR_SINGLE_QUOTE
+#define BS CHAR_BACKSLASH
+#define HS CHAR_HASH
+#define PU CHAR_PUNCTUATION
+
+/**
+ * Class of every byte value. EOF is read as 0xFF, which is treated as end of file the same way
+ */
+static const unsigned char char_classes[256] = {
+    NU, OT, OT, OT, OT, OT, OT, OT, OT, SP, NL, OT, OT, OT, OT, OT,  /* 0x00 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,  /* 0x10 */
+    SP, EX, DQ, HS, DL, OT, AM, SQ, PU, PU, AS, PS, PU, MN, DT, SL,  /* 0x20 */
+    DG, DG, DG, DG, DG, DG, DG, DG, DG, DG, PU, PU, LS, EQ, GR, QM,  /* 0x30 */
+    OT, AL, AL, AL, AL, EE, AL, AL, HH, AL, AL, AL, AL, AL, AL, AL,  /* 0x40 */
+    PP, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, PU, BS, PU, OT, US,  /* 0x50 */
+    OT, AL, AL, AL, AL, EE, AL, AL, HH, AL, AL, AL, AL, AL, AL, AL,  /* 0x60 */
+    PP, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, PU, VB, PU, OT, OT,  /* 0x70 */
+    HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI,  /* 0x80 */
+    HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI,  /* 0x90 */
+    HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI,  /* 0xA0 */
+    HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI,  /* 0xB0 */
+    HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI,  /* 0xC0 */
+    HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI,  /* 0xD0 */
+    HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI,  /* 0xE0 */
+    HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, HI, EO,  /* 0xF0 */
+};
+
+#undef OT
+#undef SP
+#undef NL
+#undef NU
+#undef EO
+#undef HI
+#undef AL
+#undef EE
+#undef PP
+#undef HH
+#undef DG
+#undef US
+#undef DL
+#undef QM
+#undef EQ
+#undef EX
+#undef AM
+#undef VB
+#undef PS
+#undef MN
+#undef AS
+#undef SL
+#undef LS
+#undef GR
+#undef DT
+#undef DQ
+#undef SQ
+#undef BS
+#undef HS
+#undef PU
+
+#define ST START
+#define KQ KEYWORD_QUESTION_STATE
+#define KC CLOSE_PHP_BRACKET_STATE
+#define KS KEYWORD_STATE
+#define IS IDENTIFIER_START_STATE
+#define ID IDENTIFIER_STATE
+#define P0 PHP_BRACKET_STATE
+#define P1 PHP_BRACKET_P_STATE
+#define P2 PHP_BRACKET_PH_STATE
+#define P3 PHP_BRACKET_PHP_STATE
+#define PI PHP_BRACKET_INVALID_STATE
+#define AG ASSIGN_STATE
+#define EQ EQUAL_STATE
+#define TE TYPED_EQUAL_STATE
+#define NE NOT_EQUAL_STATE
+#define TN TYPED_NOT_EQUAL_STATE
+#define IO INVALID_OPERATOR_STATE
+#define PL PLUS_STATE
+#define MI MINUS_STATE
+#define MU MULTIPLY_STATE
+#define DI DIVIDE_STATE
+#define PA PLUS_ASSIGN_STATE
+#define MA MINUS_ASSIGN_STATE
+#define UA MULTIPLY_ASSIGN_STATE
+#define DA DIVIDE_ASSIGN_STATE
+#define IN INCREMENT_STATE
+#define DE DECREMENT_STATE
+#define IA INVALID_ARITHMETIC_STATE
+#define A1 AND_STATE
+#define A2 LOGICAL_AND_STATE
+#define O1 OR_STATE
+#define O2 LOGICAL_OR_STATE
+#define NO LOGICAL_NOT_STATE
+#define LT LESS_STATE
+#define GT GREATER_STATE
+#define LE LESS_EQUAL_STATE
+#define GE GREATER_EQUAL_STATE
+#define SD DOUBLE_QUOTED_STRING_STATE
+#define SS SINGLE_QUOTED_STRING_STATE
+#define ED DOUBLE_QUOTED_ESCAPE_STATE
+#define ES SINGLE_QUOTED_ESCAPE_STATE
+#define SE STRING_END_STATE
+#define CM COMMENT_STATE
+#define MC MULTILINE_COMMENT_STATE
+#define MS MULTILINE_COMMENT_STAR_STATE
+#define RT ACTION_RETURN
+#define RC ACTION_RETURN_CHAR
+#define RE ACTION_END_OF_FILE
+#define RK ACTION_KEYWORD
+#define RN ACTION_NUMBER
+#define RP ACTION_PHP_BRACKET
+#define RQ ACTION_CLOSE_PHP_BRACKET
+#define XC ERROR_UNEXPECTED_CHAR
+#define XI ERROR_IDENTIFIER
+#define XP ERROR_PHP_BRACKET
+#define XO ERROR_OPERATOR
+#define XA ERROR_ARITHMETIC
+#define XS ERROR_STRING
+#define XE ERROR_END_OF_FILE
+
+/**
+ * Next state or action for every state and byte class. Rows use the state aliases above, columns are byte classes
+ * in LEXICAL_FSM_CHAR_CLASSES order
+ */
+static const unsigned char transitions[LEXICAL_FSM_STATES_COUNT][CHAR_CLASSES_COUNT] = {
+    /*        OT  SP  NL  NU  EO  HI  AL  EE  PP  HH  DG  US  DL  QM  EQ */
+    /*        EX  AM  VB  PS  MN  AS  SL  LS  GR  DT  DQ  SQ  BS  HS  PU */
+    /* ST */ {XC, ST, ST, RE, RE, XC, KS, KS, KS, KS, RN, XC, IS, KQ, AG,
+              NO, A1, O1, PL, MI, MU, DI, LT, GT, RC, SD, SS, XC, CM, RC},
+    /* KQ */ {RK, RK, RK, RK, RK, RK, KS, KS, KS, KS, RK, RK, RK, RK, RK,
+              RK, RK, RK, RK, RK, RK, RK, RK, KC, RK, RK, RK, RK, RK, RK},
+    /* KC */ {RQ, RQ, RQ, RQ, RQ, RQ, KS, KS, KS, KS, RQ, RQ, RQ, RQ, RQ,
+              RQ, RQ, RQ, RQ, RQ, RQ, RQ, RQ, RQ, RQ, RQ, RQ, RQ, RQ, RQ},
+    /* KS */ {RK, RK, RK, RK, RK, RK, KS, KS, KS, KS, RK, RK, RK, RK, RK,
+              RK, RK, RK, RK, RK, RK, RK, RK, RK, RK, RK, RK, RK, RK, RK},
+    /* IS */ {XI, XI, XI, XI, XI, XI, ID, ID, ID, ID, XI, ID, XI, XI, XI,
+              XI, XI, XI, XI, XI, XI, XI, XI, XI, XI, XI, XI, XI, XI, XI},
+    /* ID */ {RT, RT, RT, RT, RT, RT, ID, ID, ID, ID, ID, ID, RT, RT, RT,
+              RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* P0 */ {RP, RP, RP, RP, RP, RP, RP, RP, P1, PI, RP, RP, RP, RP, RP,
+              RP, RP, RP, RP, RP, RP, RP, RP, RP, RP, RP, RP, RP, RP, RP},
+    /* P1 */ {XP, XP, XP, XP, XP, XP, XP, XP, PI, P2, XP, XP, XP, XP, XP,
+              XP, XP, XP, XP, XP, XP, XP, XP, XP, XP, XP, XP, XP, XP, XP},
+    /* P2 */ {XP, XP, XP, XP, XP, XP, XP, XP, P3, PI, XP, XP, XP, XP, XP,
+              XP, XP, XP, XP, XP, XP, XP, XP, XP, XP, XP, XP, XP, XP, XP},
+    /* P3 */ {RP, RP, RP, RP, RP, RP, RP, RP, PI, PI, RP, RP, RP, RP, RP,
+              RP, RP, RP, RP, RP, RP, RP, RP, RP, RP, RP, RP, RP, RP, RP},
+    /* PI */ {XP, XP, XP, XP, XP, XP, XP, XP, PI, PI, XP, XP, XP, XP, XP,
+              XP, XP, XP, XP, XP, XP, XP, XP, XP, XP, XP, XP, XP, XP, XP},
+    /* AG */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, EQ,
+              RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* EQ */ {XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, TE,
+              XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO},
+    /* TE */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, IO,
+              RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* NE */ {XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, TN,
+              XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO},
+    /* TN */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, IO,
+              RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* IO */ {XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, IO,
+              XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO},
+    /* PL */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, PA,
+              RT, RT, RT, IN, XA, XA, XA, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* MI */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, MA,
+              RT, RT, RT, XA, DE, XA, XA, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* MU */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, UA,
+              RT, RT, RT, XA, XA, XA, XA, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* DI */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, DA,
+              RT, RT, RT, RT, RT, MC, CM, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* PA */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, IA,
+              RT, RT, RT, XA, XA, XA, XA, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* MA */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, IA,
+              RT, RT, RT, XA, XA, XA, XA, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* UA */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, IA,
+              RT, RT, RT, XA, XA, XA, XA, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* DA */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, IA,
+              RT, RT, RT, XA, XA, XA, XA, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* IN */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, IA,
+              RT, RT, RT, XA, XA, XA, XA, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* DE */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, IA,
+              RT, RT, RT, XA, XA, XA, XA, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* IA */ {XA, XA, XA, XA, XA, XA, XA, XA, XA, XA, XA, XA, XA, XA, IA,
+              XA, XA, XA, XA, XA, XA, XA, XA, XA, XA, XA, XA, XA, XA, XA},
+    /* A1 */ {XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO,
+              XO, A2, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO},
+    /* A2 */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT,
+              RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* O1 */ {XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO,
+              XO, XO, O2, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO, XO},
+    /* O2 */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT,
+              RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* NO */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, NE,
+              RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* LT */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, P0, LE,
+              RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* GT */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, GE,
+              RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* LE */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, IO,
+              RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* GE */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, IO,
+              RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* SD */ {SD, SD, SD, SD, XS, XS, SD, SD, SD, SD, SD, SD, SD, SD, SD,
+              SD, SD, SD, SD, SD, SD, SD, SD, SD, SD, SE, SD, ED, SD, SD},
+    /* SS */ {SS, SS, SS, SS, XS, XS, SS, SS, SS, SS, SS, SS, SS, SS, SS,
+              SS, SS, SS, SS, SS, SS, SS, SS, SS, SS, SS, SE, ES, SS, SS},
+    /* ED */ {SD, SD, SD, SD, SD, SD, SD, SD, SD, SD, SD, SD, SD, SD, SD,
+              SD, SD, SD, SD, SD, SD, SD, SD, SD, SD, SD, SD, SD, SD, SD},
+    /* ES */ {SS, SS, SS, SS, SS, SS, SS, SS, SS, SS, SS, SS, SS, SS, SS,
+              SS, SS, SS, SS, SS, SS, SS, SS, SS, SS, SS, SS, SS, SS, SS},
+    /* SE */ {RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT,
+              RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT, RT},
+    /* CM */ {CM, CM, ST, ST, ST, CM, CM, CM, CM, CM, CM, CM, CM, CM, CM,
+              CM, CM, CM, CM, CM, CM, CM, CM, CM, CM, CM, CM, CM, CM, CM},
+    /* MC */ {MC, MC, MC, MC, XE, XE, MC, MC, MC, MC, MC, MC, MC, MC, MC,
+              MC, MC, MC, MC, MC, MS, MC, MC, MC, MC, MC, MC, MC, MC, MC},
+    /* MS */ {MC, MC, MC, MC, XE, XE, MC, MC, MC, MC, MC, MC, MC, MC, MC,
+              MC, MC, MC, MC, MC, MS, ST, MC, MC, MC, MC, MC, MC, MC, MC},
+};
+
+#undef ST
+#undef KQ
+#undef KC
+#undef KS
+#undef IS
+#undef ID
+#undef P0
+#undef P1
+#undef P2
+#undef P3
+#undef PI
+#undef AG
+#undef EQ
+#undef TE
+#undef NE
+#undef TN
+#undef IO
+#undef PL
+#undef MI
+#undef MU
+#undef DI
+#undef PA
+#undef MA
+#undef UA
+#undef DA
+#undef IN
+#undef DE
+#undef IA
+#undef A1
+#undef A2
+#undef O1
+#undef O2
+#undef NO
+#undef LT
+#undef GT
+#undef LE
+#undef GE
+#undef SD
+#undef SS
+#undef ED
+#undef ES
+#undef SE
+#undef CM
+#undef MC
+#undef MS
+#undef RT
+#undef RC
+#undef RE
+#undef RK
+#undef RN
+#undef RP
+#undef RQ
+#undef XC
+#undef XI
+#undef XP
+#undef XO
+#undef XA
+#undef XS
+#undef XE
+
+/**
+ * Token returned by ACTION_RETURN in every state. States that never return use END_OF_FILE
+ */
+static const LEXICAL_FSM_TOKENS accept_tokens[LEXICAL_FSM_STATES_COUNT] = {
+        // Basic states
+        END_OF_FILE,
+
+        // Control states
+        END_OF_FILE,
+        END_OF_FILE,
+        END_OF_FILE,
+        END_OF_FILE,
+        IDENTIFIER,
+
+        // PHP brackets states
+        END_OF_FILE,
+        END_OF_FILE,
+        END_OF_FILE,
+        END_OF_FILE,
+        END_OF_FILE,
+
+        // Equality states
+        ASSIGN,
+        END_OF_FILE,
+        TYPED_EQUAL,
+        END_OF_FILE,
+        TYPED_NOT_EQUAL,
+        END_OF_FILE,
+
+        // Arithmetic states
+        PLUS,
+        MINUS,
+        MULTIPLY,
+        DIVIDE,
+        PLUS_ASSIGN,
+        MINUS_ASSIGN,
+        MULTIPLY_ASSIGN,
+        DIVIDE_ASSIGN,
+        INCREMENT,
+        DECREMENT,
+        END_OF_FILE,
+
+        // Logical states
+        END_OF_FILE,
+        LOGICAL_AND,
+        END_OF_FILE,
+        LOGICAL_OR,
+        LOGICAL_NOT,
+
+        // Square parenthesis states
+        LESS,
+        GREATER,
+        LESS_EQUAL,
+        GREATER_EQUAL,
+
+        // Data types states
+        END_OF_FILE,
+        END_OF_FILE,
+        END_OF_FILE,
+        END_OF_FILE,
+        STRING,
+
+        // Comment states
+        END_OF_FILE,
+        END_OF_FILE,
+        END_OF_FILE,
+};
+
+/**
+ * Gets token of a single character token
+ * @param c token character
+ * @return token type
+ */
+static LEXICAL_FSM_TOKENS get_char_token(char c) {
+    switch (c) {
+        case '(':
+            return LEFT_PARENTHESIS;
+        case ')':
+            return RIGHT_PARENTHESIS;
+        case '{':
+            return LEFT_CURLY_BRACKETS;
+        case '}':
+            return RIGHT_CURLY_BRACKETS;
+        case '[':
+            return LEFT_SQUARE_BRACKETS;
+        case ']':
+            return RIGHT_SQUARE_BRACKETS;
+        case ',':
+            return COMMA;
+        case ':':
+            return COLON;
+        case ';':
+            return SEMICOLON;
+        default:
+            return CONCATENATION;
+    }
+}
+
+/**
+ * @struct lexical_keyword_t
+ * Keyword table entry
+ *
+ * @var lexical_keyword_t::name
+ * Lowercase keyword, NULL for empty entry
+ *
+ * @var lexical_keyword_t::length
+ * Keyword length
+ *
+ * @var lexical_keyword_t::type
+ * Keyword token type
+ */
+typedef struct lexical_keyword {
+    const char *name;
+    size_t length;
+    LEXICAL_FSM_TOKENS type;
+} lexical_keyword_t;
+
+#define KEYWORDS_SIZE 32
+
+/**
+ * Perfect hash of a keyword candidate. Keywords differ in length or first character, which is folded to lowercase
+ */
+#define KEYWORD_HASH(token, length) (((length) + 5 * ((unsigned char) (token)[0] | 0x20)) & (KEYWORDS_SIZE - 1))
+
+/**
+ * Keywords placed by KEYWORD_HASH, every keyword has its own slot
+ */
+static const lexical_keyword_t keywords[KEYWORDS_SIZE] = {
+        {"return", 6, KEYWORD_RETURN},
+        {"?float", 6, KEYWORD_FLOAT},
+        {"?string", 7, KEYWORD_STRING},
+        {"float", 5, KEYWORD_FLOAT},
+        {NULL, 0, END_OF_FILE},
+        {"string", 6, KEYWORD_STRING},
+        {"function", 8, KEYWORD_FUNCTION},
+        {NULL, 0, END_OF_FILE},
+        {NULL, 0, END_OF_FILE},
+        {NULL, 0, END_OF_FILE},
+        {"null", 4, KEYWORD_NULL},
+        {NULL, 0, END_OF_FILE},
+        {NULL, 0, END_OF_FILE},
+        {NULL, 0, END_OF_FILE},
+        {NULL, 0, END_OF_FILE},
+        {"if", 2, KEYWORD_IF},
+        {"int", 3, KEYWORD_INTEGER},
+        {NULL, 0, END_OF_FILE},
+        {"void", 4, KEYWORD_VOID},
+        {NULL, 0, END_OF_FILE},
+        {NULL, 0, END_OF_FILE},
+        {NULL, 0, END_OF_FILE},
+        {NULL, 0, END_OF_FILE},
+        {NULL, 0, END_OF_FILE},
+        {"while", 5, KEYWORD_WHILE},
+        {NULL, 0, END_OF_FILE},
+        {NULL, 0, END_OF_FILE},
+        {"declare", 7, KEYWORD_DECLARE},
+        {NULL, 0, END_OF_FILE},
+        {"else", 4, KEYWORD_ELSE},
+        {NULL, 0, END_OF_FILE},
+        {"?int", 4, KEYWORD_INTEGER},
+};
+
+/**
+ * Finds keyword matching a token regardless of case. Token can only contain letters and a leading '?', so folding
+ * with 0x20 is enough to compare it
+ * @param token token value
+ * @param length token length
+ * @return keyword table entry, NULL if the token is not a keyword
+ */
+static const lexical_keyword_t *find_keyword(const char *token, size_t length) {
+    if (length == 0) return NULL;
+
+    const lexical_keyword_t *keyword = &keywords[KEYWORD_HASH(token, length)];
+    if (keyword->length != length) return NULL;
+
+    for (size_t i = 0; i < length; i++) {
+        if (((unsigned char) token[i] | 0x20) != (unsigned char) keyword->name[i]) return NULL;
+    }
+
+    return keyword;
+}
+
+#define NUMBER_MAX_DIGITS 19
+#define FLOAT_EXACT_MANTISSA (1ULL << 53)
+#define FLOAT_EXACT_EXPONENT 22
+
+/**
+ * Powers of ten that are exact in double
+ */
+static const double powers_of_ten[FLOAT_EXACT_EXPONENT + 1] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/**
+ * Adds decimal digit to float mantissa, digits that do not fit make the value inexact
+ * @param mantissa pointer to the mantissa
+ * @param mantissa_digits pointer to number of significant digits in the mantissa
+ * @param digit digit value
+ * @param is_exact pointer to exactness flag
+ * @return true if the digit was added, false if it was dropped
+ */
+static bool add_mantissa_digit(uint64_t *mantissa, int *mantissa_digits, int digit, bool *is_exact) {
+    if (*mantissa_digits >= NUMBER_MAX_DIGITS) {
+        *is_exact = false;
+        return false;
+    }
+
+    *mantissa = *mantissa * 10 + (uint64_t) digit;
+    if (*mantissa != 0) (*mantissa_digits)++;
+    return true;
+}
+
+/**
+ * Scans integer or float literal in a single pass, validating and converting it at once. Integer part can contain
+ * letters, which make the literal invalid. Floats with short mantissa and small exponent are converted exactly,
+ * others are left for strtod. Integers that do not fit into int64_t are scanned as floats
+ * @param source pointer to the source positioned at the first digit
+ * @param number pointer to store the value
+ * @param is_exact pointer to flag, set to false if the float value has to be converted from text
+ * @param is_valid pointer to flag, set to false if the literal has invalid format
+ * @return INTEGER or FLOAT
+ */
+static LEXICAL_FSM_TOKENS scan_number(lexical_source_t *source, lexical_number_t *number, bool *is_exact,
+                                      bool *is_valid) {
+    const unsigned char *data = (const unsigned char *) source->data;
+    size_t length = source->length;
+    size_t position = source->position;
+    uint64_t integer = 0;
+    uint64_t mantissa = 0;
+    int mantissa_digits = 0;
+    int exponent = 0;
+    bool is_overflow = false;
+    *is_valid = true;
+
+    for (; position < length; position++) {
+        unsigned char char_class = char_classes[data[position]];
+
+        if (char_class == CHAR_DIGIT) {
+            uint64_t digit = (uint64_t) (data[position] - '0');
+            if (integer > ((uint64_t) INT64_MAX - digit) / 10) is_overflow = true;
+            else integer = integer * 10 + digit;
+            if (!add_mantissa_digit(&mantissa, &mantissa_digits, data[position] - '0', is_exact)) exponent++;
+        } else if (char_class == CHAR_ALPHA || char_class == CHAR_P || char_class == CHAR_H) {
+            *is_valid = false;
+        } else {
+            break;
+        }
+    }
+
+    bool is_integer = position >= length || (data[position] != '.' && char_classes[data[position]] != CHAR_E);
+    if (is_integer && (!is_overflow || !*is_valid)) {
+        source->position = position;
+        number->integer = (int64_t) integer;
+        return INTEGER;
+    }
+
+    // integer literals that do not fit into int64_t are read as floats, like in PHP
+    if (position < length && data[position] == '.') {
+        size_t fraction_start = ++position;
+
+        for (; position < length && char_classes[data[position]] == CHAR_DIGIT; position++) {
+            if (add_mantissa_digit(&mantissa, &mantissa_digits, data[position] - '0', is_exact)) exponent--;
+        }
+
+        if (position == fraction_start) *is_valid = false;
+    }
+
+    if (position < length && char_classes[data[position]] == CHAR_E) {
+        bool is_negative = false;
+        int exponent_value = 0;
+
+        if (++position < length && (data[position] == '+' || data[position] == '-'))
+            is_negative = data[position++] == '-';
+
+        size_t exponent_start = position;
+        for (; position < length && char_classes[data[position]] == CHAR_DIGIT; position++) {
+            if (exponent_value < 100000) exponent_value = exponent_value * 10 + (data[position] - '0');
+        }
+
+        if (position == exponent_start) *is_valid = false;
+        exponent += is_negative ? -exponent_value : exponent_value;
+    }
+
+    // exponent can not follow complete float
+    for (; position < length && char_classes[data[position]] == CHAR_E; position++) *is_valid = false;
+
+    source->position = position;
+
+    if (*is_exact && mantissa < FLOAT_EXACT_MANTISSA && exponent >= -FLOAT_EXACT_EXPONENT &&
+        exponent <= FLOAT_EXACT_EXPONENT) {
+        number->floating = exponent < 0 ? (double) mantissa / powers_of_ten[-exponent]
+                                        : (double) mantissa * powers_of_ten[exponent];
+    } else {
+        *is_exact = false;
+    }
+
+    return FLOAT;
+}
+
+/**
+ * Converts float text that is not terminated in the source
+ * @param text float text
+ * @param length text length
+ * @return float value
+ */
+static double parse_float_text(const char *text, size_t length) {
+    char buffer[64];
+    char *copy = length < sizeof(buffer) ? buffer : (char *) malloc(length + 1);
+    if (copy == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for float literal");
+    }
+
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+
+    double value = strtod(copy, NULL);
+    if (copy != buffer) free(copy);
+    return value;
+}
+
+/**
+ * Checks if token value is converted to lowercase. Keywords, PHP brackets and function names are not case-sensitive,
+ * variable names are
+ * @param type token type
+ * @param text token text as written in the source
+ * @return true if the value is lowercase, false if it is kept as written
+ */
+static bool is_lowercase_token(LEXICAL_FSM_TOKENS type, const char *text) {
+    return (type >= KEYWORD_IF && type <= KEYWORD_STRICT_TYPES) || type == OPEN_PHP_BRACKET ||
+           (type == IDENTIFIER && text[0] != '$');
+}
+
+atom_t lexical_identifier_atom(atom_table_t *atoms, const char *text, size_t length) {
+    if (text[0] == '$') return atom_table_intern(atoms, text, length);
+
+    return atom_table_intern_lower(atoms, text, length);
+}
+
+LEXICAL_FSM_TOKENS get_next_token_source(lexical_source_t *source, string_t *token) {
+    lexical_number_t number;
+    return get_next_token_number(source, token, &number);
+}
+
+LEXICAL_FSM_TOKENS get_next_token_number(lexical_source_t *source, string_t *token, lexical_number_t *number) {
+    lexical_span_t span;
+    get_next_span(source, &span);
 
     string_clear(token);
+    string_append_chars(token, source->data + span.offset, span.length);
+    if (is_lowercase_token(span.type, source->data + span.offset)) string_to_lower(token);
+
+    *number = span.number;
+    return span.type;
+}
+
+#if defined(__AVX2__)
+#define LEXICAL_VECTOR_SIZE 32
+#define LEXICAL_VECTOR_T __m256i
+#define LEXICAL_VECTOR_LOAD(ptr) _mm256_loadu_si256((const __m256i *) (ptr))
+#define LEXICAL_VECTOR_SET(c) _mm256_set1_epi8((char) (c))
+#define LEXICAL_VECTOR_EQ(a, b) _mm256_cmpeq_epi8(a, b)
+#define LEXICAL_VECTOR_OR(a, b) _mm256_or_si256(a, b)
+#define LEXICAL_VECTOR_MASK(v) ((uint32_t) _mm256_movemask_epi8(v))
+#define LEXICAL_VECTOR_ALL 0xFFFFFFFFU
+#elif defined(__SSE2__) || defined(_M_X64)
+#define LEXICAL_VECTOR_SIZE 16
+#define LEXICAL_VECTOR_T __m128i
+#define LEXICAL_VECTOR_LOAD(ptr) _mm_loadu_si128((const __m128i *) (ptr))
+#define LEXICAL_VECTOR_SET(c) _mm_set1_epi8((char) (c))
+#define LEXICAL_VECTOR_EQ(a, b) _mm_cmpeq_epi8(a, b)
+#define LEXICAL_VECTOR_OR(a, b) _mm_or_si128(a, b)
+#define LEXICAL_VECTOR_MASK(v) ((uint32_t) _mm_movemask_epi8(v))
+#define LEXICAL_VECTOR_ALL 0xFFFFU
+#endif
+
+/**
+ * States which loop on most bytes, so their runs are skipped by skip_state_run
+ */
+#define RUN_STATES ((1ULL << START) | (1ULL << DOUBLE_QUOTED_STRING_STATE) | (1ULL << SINGLE_QUOTED_STRING_STATE) | \
+                    (1ULL << COMMENT_STATE) | (1ULL << MULTILINE_COMMENT_STATE))
+
+#define IS_RUN_STATE(state) ((RUN_STATES >> (state)) & 1)
+
+#ifdef LEXICAL_VECTOR_SIZE
+/**
+ * Gets index of the lowest set bit
+ * @param mask non-zero mask
+ * @return bit index
+ */
+static inline size_t lowest_set_bit(uint32_t mask) {
+#if defined(__GNUC__)
+    return (size_t) __builtin_ctz(mask);
+#else
+    size_t index = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+/**
+ * Marks bytes of a block which may leave the state. Marking a byte which loops is allowed, it only ends the
+ * vector scan early
+ * @param state state the run is in
+ * @param chars block of source bytes
+ * @return mask with bit set for every byte that may leave the state
+ */
+static inline uint32_t run_stop_mask(unsigned char state, LEXICAL_VECTOR_T chars) {
+    switch (state) {
+        case START:
+            // whitespace is the only thing START loops on, so stop on anything else
+            return LEXICAL_VECTOR_ALL & ~LEXICAL_VECTOR_MASK(LEXICAL_VECTOR_OR(
+                    LEXICAL_VECTOR_OR(LEXICAL_VECTOR_EQ(chars, LEXICAL_VECTOR_SET(' ')),
+                                      LEXICAL_VECTOR_EQ(chars, LEXICAL_VECTOR_SET('\t'))),
+                    LEXICAL_VECTOR_EQ(chars, LEXICAL_VECTOR_SET('\n'))));
+        case COMMENT_STATE:
+            return LEXICAL_VECTOR_MASK(LEXICAL_VECTOR_OR(
+                    LEXICAL_VECTOR_OR(LEXICAL_VECTOR_EQ(chars, LEXICAL_VECTOR_SET('\n')),
+                                      LEXICAL_VECTOR_EQ(chars, LEXICAL_VECTOR_SET('\0'))),
+                    LEXICAL_VECTOR_EQ(chars, LEXICAL_VECTOR_SET(0xFF))));
+        case MULTILINE_COMMENT_STATE:
+            // bytes above 0x7F are marked by their sign bit
+            return LEXICAL_VECTOR_MASK(LEXICAL_VECTOR_OR(chars, LEXICAL_VECTOR_EQ(chars, LEXICAL_VECTOR_SET('*'))));
+        case DOUBLE_QUOTED_STRING_STATE:
+            return LEXICAL_VECTOR_MASK(LEXICAL_VECTOR_OR(
+                    LEXICAL_VECTOR_OR(chars, LEXICAL_VECTOR_EQ(chars, LEXICAL_VECTOR_SET('"'))),
+                    LEXICAL_VECTOR_EQ(chars, LEXICAL_VECTOR_SET('\\'))));
+        case SINGLE_QUOTED_STRING_STATE:
+            return LEXICAL_VECTOR_MASK(LEXICAL_VECTOR_OR(
+                    LEXICAL_VECTOR_OR(chars, LEXICAL_VECTOR_EQ(chars, LEXICAL_VECTOR_SET('\''))),
+                    LEXICAL_VECTOR_EQ(chars, LEXICAL_VECTOR_SET('\\'))));
+        default:
+            return LEXICAL_VECTOR_ALL;
+    }
+}
+#endif
+
+/**
+ * Moves source past bytes the state loops on, so whitespace, comments and string bodies do not go through the
+ * transition table byte by byte. Blocks are scanned with vector instructions where available, the rest is checked
+ * against the table
+ * @param source pointer to the source
+ * @param state state for which IS_RUN_STATE holds
+ */
+static void skip_state_run(lexical_source_t *source, unsigned char state) {
+    const unsigned char *data = (const unsigned char *) source->data;
+    size_t position = source->position;
+    size_t length = source->length;
+
+    // most whitespace runs are a single space, do not start a vector scan for them
+    if (position >= length || transitions[state][char_classes[data[position]]] != state) return;
+
+#ifdef LEXICAL_VECTOR_SIZE
+    for (; position + LEXICAL_VECTOR_SIZE <= length; position += LEXICAL_VECTOR_SIZE) {
+        uint32_t mask = run_stop_mask(state, LEXICAL_VECTOR_LOAD(data + position));
+        if (mask != 0) {
+            source->position = position + lowest_set_bit(mask);
+            return;
+        }
+    }
+#endif
+
+    while (position < length && transitions[state][char_classes[data[position]]] == state) position++;
+    source->position = position;
+}
+
+/**
+ * Reads next token span without reporting errors
+ * @param source pointer to the source
+ * @param span pointer to store the token, on error its offset and length cover the invalid text
+ * @return ACTION_RETURN if the token was read, error action otherwise
+ */
+static unsigned char scan_span(lexical_source_t *source, lexical_span_t *span) {
+    unsigned char state = START;
+    size_t start = source->position;
+    int current_char;
+    unsigned char next;
+
+    span->number.integer = 0;
     while (true) {
-        switch (state) {
-            case START:
-                switch (current_char) {
-                    case ' ':
-                    case '\n':
-                    case '\t':
-                        break;
-                    case '\0':
-                    case EOF:
-                        return END_OF_FILE;
-                    case '?':
-                        state = KEYWORD_STATE;
-                        string_append_char(token, current_char);
-                        break;
-                    case '$':
-                        state = IDENTIFIER_STATE;
-                        string_append_char(token, current_char);
-                        break;
-                    case '=':
-                        state = EQUAL_STATE;
-                        string_append_char(token, current_char);
-                        break;
-                    case ':':
-                        string_append_char(token, current_char);
-                        return COLON;
-                    case ';':
-                        string_append_char(token, current_char);
-                        return SEMICOLON;
-                    case '\'':
-                    case '"':
-                        state = STRING_STATE;
-                        string_append_char(token, current_char);
-                        break;
-                    case '#' :
-                        state = COMMENT_STATE;
-                        break;
-                    case '+':
-                    case '-':
-                    case '*':
-                    case '/':
-                        state = ARITHMETIC_STATE;
-                        string_append_char(token, current_char);
-                        break;
-                    case '&':
-                    case '|':
-                    case '!':
-                        state = LOGICAL_STATE;
-                        string_append_char(token, current_char);
-                        break;
-                    case ',':
-                        string_append_char(token, current_char);
-                        return COMMA;
-                    case '(':
-                        string_append_char(token, current_char);
-                        return LEFT_PARENTHESIS;
-                    case ')':
-                        string_append_char(token, current_char);
-                        return RIGHT_PARENTHESIS;
-                    case '{':
-                        string_append_char(token, current_char);
-                        return LEFT_CURLY_BRACKETS;
-                    case '}':
-                        string_append_char(token, current_char);
-                        return RIGHT_CURLY_BRACKETS;
-                    case '[':
-                        string_append_char(token, current_char);
-                        return LEFT_SQUARE_BRACKETS;
-                    case ']':
-                        string_append_char(token, current_char);
-                        return RIGHT_SQUARE_BRACKETS;
-                    case '.':
-                        string_append_char(token, current_char);
-                        return CONCATENATION;
-                    case '<':
-                    case '>':
-                        state = SQUARE_PARENTHESIS_STATE;
-                        string_append_char(token, current_char);
-                        break;
-
-                    default:
-                        if (isalpha(current_char)) {
-                            state = KEYWORD_STATE;
-                            string_append_char(token, current_char);
-                            break;
-                        } else if (isdigit(current_char)) {
-                            state = INTEGER_STATE;
-                            string_append_char(token, current_char);
-                            break;
-                        } else {
-                            LEXICAL_ERROR("Unexpected character: %c", current_char);
-                        }
-                }
-                break;
-            case KEYWORD_STATE:
-                if (isalpha(current_char) || (!strcmp(token->value, "?") && current_char == '>')) {
-                    string_append_char(token, current_char);
-                } else {
-                    int keyword = -1;
-                    string_convert_by(token, tolower);  // all keywords are not case-sensitive
-
-                    if (!strcmp(token->value, "int") || !strcmp(token->value, "?int")) keyword = KEYWORD_INTEGER;
-                    else if (!strcmp(token->value, "float") || !strcmp(token->value, "?float")) keyword = KEYWORD_FLOAT;
-                    else if (!strcmp(token->value, "string") || !strcmp(token->value, "?string"))
-                        keyword = KEYWORD_STRING;
-                    else if (!strcmp(token->value, "if")) keyword = KEYWORD_IF;
-                    else if (!strcmp(token->value, "else")) keyword = KEYWORD_ELSE;
-                    else if (!strcmp(token->value, "while")) keyword = KEYWORD_WHILE;
-                    else if (!strcmp(token->value, "function")) keyword = KEYWORD_FUNCTION;
-                    else if (!strcmp(token->value, "return")) keyword = KEYWORD_RETURN;
-                    else if (!strcmp(token->value, "null")) keyword = KEYWORD_NULL;
-                    else if (!strcmp(token->value, "void")) keyword = KEYWORD_VOID;
-                    else if (!strcmp(token->value, "declare")) keyword = KEYWORD_DECLARE;
-                    else if (!strcmp(token->value, "?>")) {
-                        keyword = CLOSE_PHP_BRACKET;
-
-                        if (current_char != EOF) {
-                            LEXICAL_ERROR("Unexpected character: %c", current_char);
-                        }
-                    }
-
-                    if (keyword != -1) {
-                        state = START;
-                    } else {
-                        state = IDENTIFIER_STATE;
-                    }
-                    ungetc(current_char, fd);
-                    if (keyword != -1) return (LEXICAL_FSM_TOKENS) keyword;
-                }
-                break;
-            case IDENTIFIER_STATE:
-                if (!strcmp(token->value, "$")) {
-                    if (isalpha(current_char) || current_char == '_') {
-                        string_append_char(token, current_char);
-                    } else {
-                        LEXICAL_ERROR("Identifier must start with letter or underscore");
-                    }
-                } else if (isalpha(current_char) || isdigit(current_char) || current_char == '_') {
-                    string_append_char(token, current_char);
-                } else {
-                    state = START;
-                    ungetc(current_char, fd);
-                    return IDENTIFIER;
-                }
-                break;
-            case PHP_BRACKET_STATE:
-                if (tolower(current_char) == 'p' || tolower(current_char) == 'h') {
-                    string_append_char(token, current_char);
-                } else {
-                    string_convert_by(token, tolower);
-                    bool is_php_bracket = !strcmp(token->value, "<?") || !strcmp(token->value, "<?php");
-
-                    if (!is_php_bracket) {
-                        LEXICAL_ERROR("Invalid PHP open bracket");
-                    }
-
-                    state = START;
-                    ungetc(current_char, fd);
-                    return OPEN_PHP_BRACKET;
-                }
-                break;
-            case EQUAL_STATE:
-                if (current_char == '=')
-                    string_append_char(token, current_char);
-                else {
-                    state = START;
-                    ungetc(current_char, fd);
-
-                    if (!strcmp(token->value, "=")) return ASSIGN;
-                    else if (!strcmp(token->value, "===")) return TYPED_EQUAL;
-                    else if (!strcmp(token->value, "!==")) return TYPED_NOT_EQUAL;
-                    else {
-                        LEXICAL_ERROR("Invalid operator: %s", token->value);
-                    }
-                }
-                break;
-            case ARITHMETIC_STATE:
-                if (current_char == '=' ||
-                    (!strcmp(token->value, "+") && current_char == '+') ||
-                    (!strcmp(token->value, "-") && current_char == '-')) {
-                    string_append_char(token, current_char);
-                } else if (!strcmp(token->value, "/")) {
-                    switch (current_char) {
-                        case '/':
-                        case '*':
-                            string_append_char(token, current_char);
-                            state = current_char == '/' ? COMMENT_STATE : MULTILINE_COMMENT_STATE;
-                            break;
-                        default:
-                            state = START;
-                            ungetc(current_char, fd);
-                            return DIVIDE;
-                    }
-                } else {
-                    state = START;
-
-                    if (current_char != '+' && current_char != '-' && current_char != '*' && current_char != '/') {
-                        ungetc(current_char, fd);
-                    } else {
-                        string_append_char(token, current_char);
-                    }
-                    if (!strcmp(token->value, "+")) return PLUS;
-                    else if (!strcmp(token->value, "-")) return MINUS;
-                    else if (!strcmp(token->value, "*")) return MULTIPLY;
-                    else if (!strcmp(token->value, "/")) return DIVIDE;
-                    else if (!strcmp(token->value, "+=")) return PLUS_ASSIGN;
-                    else if (!strcmp(token->value, "-=")) return MINUS_ASSIGN;
-                    else if (!strcmp(token->value, "*=")) return MULTIPLY_ASSIGN;
-                    else if (!strcmp(token->value, "/=")) return DIVIDE_ASSIGN;
-                    else if (!strcmp(token->value, "--")) return DECREMENT;
-                    else if (!strcmp(token->value, "++")) return INCREMENT;
-                    else
-                    LEXICAL_ERROR("Invalid arithmetic operator");
-                }
-                break;
-            case LOGICAL_STATE:
-                if ((!strcmp(token->value, "&") && current_char == '&') ||
-                    (!strcmp(token->value, "|") && current_char == '|')) {
-                    string_append_char(token, current_char);
-                } else {
-                    state = START;
-                    ungetc(current_char, fd);
-
-                    if (!strcmp(token->value, "!")) {
-                        if (current_char == '=') state = EQUAL_STATE;
-                        else return LOGICAL_NOT;
-                    } else if (!strcmp(token->value, "&&")) return LOGICAL_AND;
-                    else if (!strcmp(token->value, "||")) return LOGICAL_OR;
-                }
-                break;
-            case SQUARE_PARENTHESIS_STATE:
-                if (current_char == '=' ||
-                    (!strcmp(token->value, "<") && current_char == '?')) {
-                    string_append_char(token, current_char);
-                } else {
-                    state = START;
-
-                    if (!strcmp(token->value, "<")) return LESS;
-                    else if (!strcmp(token->value, ">")) return GREATER;
-                    else if (!strcmp(token->value, "<=")) return LESS_EQUAL;
-                    else if (!strcmp(token->value, ">=")) return GREATER_EQUAL;
-                    else if (!strcmp(token->value, "<?")) {
-                        state = PHP_BRACKET_STATE;
-                        ungetc(current_char, fd);
-                    };
-                }
-                break;
-            case INTEGER_STATE:
-                if (isdigit(current_char) || (isalpha(current_char) && current_char != 'e' && current_char != 'E')) {
-                    string_append_char(token, current_char);
-                } else if (current_char == '.' || current_char == 'e' || current_char == 'E') {
-                    state = FLOAT_STATE;
-                    string_append_char(token, current_char);
-                } else {
-                    state = START;
-                    ungetc(current_char, fd);
-
-                    if (string_check_by(token, isdigit)) return INTEGER;
-                    else {
-                        LEXICAL_ERROR("Invalid integer number format");
-                    }
-                }
-                break;
-            case FLOAT_STATE:
-                if (isdigit(current_char) || current_char == 'e' || current_char == 'E' || current_char == '+' ||
-                    current_char == '-') {
-                    string_append_char(token, current_char);
-                } else {
-                    state = START;
-                    ungetc(current_char, fd);
-
-                    regex_t regex;
-                    int regex_comp = regcomp(&regex, "^[0-9]+\\.?[0-9]+([eE][+-]?[0-9]+)?$", REG_EXTENDED);
-                    if (regex_comp != 0) {
-                        LEXICAL_ERROR("Invalid float regexp");
-                    }
-                    int return_value = regexec(&regex, token->value, 0, NULL, 0);
-                    if (!return_value) {
-                        return FLOAT;
-                    } else {
-                        LEXICAL_ERROR("Invalid float number format");
-                    }
-                }
-                break;
-            case STRING_STATE:
-                if (token->value[0] == '"' && current_char == '"' || token->value[0] == '\'' && current_char == '\'') {
-                    state = START;
-                    string_append_char(token, current_char);
-                    return STRING;
-                } else if (current_char == '\\') {
-                    state = STRING_ESCAPE_STATE;
-                    string_append_char(token, current_char);
-                } else {
-                    state = STRING_STATE;
-                    string_append_char(token, current_char);
-
-                    if (current_char < 0) {
-                        LEXICAL_ERROR("Invalid string format");
-                    }
-                }
-                break;
-            case STRING_ESCAPE_STATE:
-                string_append_char(token, current_char);
-                state = STRING_STATE;
-                break;
-            case COMMENT_STATE:
-                if (current_char == '\n' || current_char == '\0' || current_char == EOF) {
-                    string_clear(token);
-                    state = START;
-                }
-                break;
-            case MULTILINE_COMMENT_STATE:
-                if (current_char == '*') {
-                    current_char = (char) getc(fd);
-                    if (current_char == '/') {
-                        string_clear(token);
-                        state = START;
-                    } else
-                        ungetc(current_char, fd);
-                } else if (current_char < 0) {
-                    LEXICAL_ERROR("Unexpected end of file");
+        if (state == START) start = source->position;
+
+        current_char = lexical_source_getc(source);
+        next = transitions[state][char_classes[(unsigned char) current_char]];
+        if (next < LEXICAL_FSM_STATES_COUNT) {
+            state = next;
+            if (IS_RUN_STATE(state)) skip_state_run(source, state);
+            continue;
+        }
+
+        if (next == ACTION_END_OF_FILE) {
+            span->type = END_OF_FILE;
+            span->offset = start < source->length ? start : source->length;
+            span->length = 0;
+            return ACTION_RETURN;
+        }
+
+        if (next != ACTION_RETURN_CHAR) lexical_source_ungetc(source);
+
+        span->offset = start;
+        span->length = (source->position < source->length ? source->position : source->length) - start;
+
+        switch (next) {
+            case ACTION_RETURN:
+                span->type = accept_tokens[state];
+                if (span->type == IDENTIFIER && source->atoms != NULL)
+                    span->number.atom = lexical_identifier_atom(source->atoms, source->data + start, span->length);
+                return ACTION_RETURN;
+            case ACTION_RETURN_CHAR:
+                span->type = get_char_token((char) current_char);
+                return ACTION_RETURN;
+            case ACTION_KEYWORD: {
+                // all keywords are not case-sensitive
+                const lexical_keyword_t *keyword = find_keyword(source->data + start, span->length);
+                if (keyword == NULL) {
+                    state = IDENTIFIER_STATE;
+                    break;
                 }
-                break;
+
+                span->type = keyword->type;
+                return ACTION_RETURN;
+            }
+            case ACTION_NUMBER: {
+                bool is_exact = true;
+                bool is_valid = true;
+                span->type = scan_number(source, &span->number, &is_exact, &is_valid);
+                span->length = source->position - start;
+
+                if (!is_valid) return span->type == INTEGER ? ERROR_INTEGER : ERROR_FLOAT;
+                if (span->type == FLOAT && !is_exact)
+                    span->number.floating = parse_float_text(source->data + start, span->length);
+                return ACTION_RETURN;
+            }
+            case ACTION_PHP_BRACKET:
+                span->type = OPEN_PHP_BRACKET;
+                return ACTION_RETURN;
+            case ACTION_CLOSE_PHP_BRACKET:
+                if (char_classes[(unsigned char) current_char] != CHAR_EOF) return ERROR_UNEXPECTED_CHAR;
+
+                span->type = CLOSE_PHP_BRACKET;
+                return ACTION_RETURN;
             default:
-                break;
+                return next;
         }
+    }
+}
+
+/**
+ * Reports lexical error found by scan_span
+ * @param source pointer to the source, positioned after the invalid text
+ * @param span pointer to the invalid span
+ * @param error error action
+ */
+static void report_span_error(lexical_source_t *source, const lexical_span_t *span, unsigned char error) {
+    int current_char = lexical_source_eof(source) ? EOF : (unsigned char) source->data[source->position];
 
-        current_char = getc(fd);
+    switch (error) {
+        case ERROR_IDENTIFIER:
+            LEXICAL_ERROR("Identifier must start with letter or underscore");
+        case ERROR_PHP_BRACKET:
+            LEXICAL_ERROR("Invalid PHP open bracket");
+        case ERROR_OPERATOR:
+            LEXICAL_ERROR("Invalid operator: %.*s", (int) span->length, source->data + span->offset);
+        case ERROR_ARITHMETIC:
+            LEXICAL_ERROR("Invalid arithmetic operator");
+        case ERROR_STRING:
+            LEXICAL_ERROR("Invalid string format");
+        case ERROR_END_OF_FILE:
+            LEXICAL_ERROR("Unexpected end of file");
+        case ERROR_INTEGER:
+            LEXICAL_ERROR("Invalid integer number format");
+        case ERROR_FLOAT:
+            LEXICAL_ERROR("Invalid float number format");
+        default:
+            LEXICAL_ERROR("Unexpected character: %c", current_char);
     }
+}
+
+LEXICAL_FSM_TOKENS get_next_span(lexical_source_t *source, lexical_span_t *span) {
+    unsigned char result = scan_span(source, span);
+    if (result != ACTION_RETURN) report_span_error(source, span, result);
+
+    return span->type;
+}
+
+bool try_next_span(lexical_source_t *source, lexical_span_t *span) {
+    if (scan_span(source, span) == ACTION_RETURN) return true;
+
+    source->position = span->offset;
+    return false;
+}
+
+string_view_t lexical_span_view(lexical_source_t *source, const lexical_span_t *span) {
+    string_view_t view = {source->data + span->offset, span->length};
+    return view;
+}
+
+string_t *lexical_span_value(lexical_source_t *source, const lexical_span_t *span) {
+    string_t *value = string_init_view(lexical_span_view(source, span));
+    if (is_lowercase_token(span->type, value->value)) string_to_lower(value);
 
-    return END_OF_FILE;
+    return value;
 }
 
+/**
+ * Decodes character following a backslash in a string literal
+ * @param escape pointer to the character following the backslash
+ * @param decoded pointer to store the decoded character
+ * @return number of source characters consumed after the backslash
+ */
+static size_t decode_string_escape(const char *escape, char *decoded) {
+    switch (*escape) {
+        case 'a':
+            *decoded = '\a';
+            return 1;
+        case 'b':
+            *decoded = '\b';
+            return 1;
+        case 'f':
+            *decoded = '\f';
+            return 1;
+        case 'n':
+            *decoded = '\n';
+            return 1;
+        case 'r':
+            *decoded = '\r';
+            return 1;
+        case 't':
+            *decoded = '\t';
+            return 1;
+        case 'v':
+            *decoded = '\v';
+            return 1;
+        case '\\':
+        case '\'':
+        case '\"':
+        case '?':
+            *decoded = *escape;
+            return 1;
+        case '0':
+            *decoded = '\0';
+            return 1;
+        default:
+            // unknown escape keeps the character after it
+            *decoded = escape[1];
+            return 2;
+    }
+}
+
+string_t *lexical_span_string(lexical_source_t *source, const lexical_span_t *span) {
+    const char *text = source->data + span->offset + 1;
+    size_t length = span->length - 2;
+    string_t *value = string_base_init();
+    size_t index = 0;
+
+    string_reserve(value, length);
+    while (index < length) {
+        const char *backslash = (const char *) memchr(text + index, '\\', length - index);
+        size_t run_end = backslash != NULL ? (size_t) (backslash - text) : length;
+        char decoded;
+
+        string_append_chars(value, text + index, run_end - index);
+        if (run_end + 1 >= length) break;
+
+        index = run_end + 1;
+        index += decode_string_escape(text + index, &decoded);
+        string_append_char(value, decoded);
+    }
+
+    string_shrink_to_fit(value);
+    return value;
+}
 
-FILE *test_lex_input(char *input) {
-    FILE *fd = fmemopen(input, strlen(input), "r");
-    return fd;
+lexical_source_t *test_lex_input(char *input) {
+    return lexical_source_from_memory(input, strlen(input));
 }
 
 lexical_token_t *get_token(FILE *fd) {
-    string_t *token_string = string_init("");
-    LEXICAL_FSM_TOKENS token_type = get_next_token(fd, token_string);
+    lexical_token_t *token = get_token_source(get_file_source(fd));
+    release_file_source(token->type);
+    return token;
+}
+
+lexical_token_t *get_token_source(lexical_source_t *source) {
+    // tokens are short-lived, keep them out of the compilation arena
+    arena_t *arena = set_compilation_arena(NULL);
+
+    string_t *token_string = string_base_init();
+    lexical_number_t number = {0};
+    LEXICAL_FSM_TOKENS token_type = get_next_token_number(source, token_string, &number);
 
     lexical_token_t *token = (lexical_token_t *) malloc(sizeof(lexical_token_t));
     if (token == NULL) {
         INTERNAL_ERROR("Unable to allocate memory for lexical token");
     }
 
-    char *token_value = (char *) malloc(sizeof(char) * (token_string->length + 1));
-    if (token_value == NULL) {
-        INTERNAL_ERROR("Unable to allocate memory for lexical token value");
-    }
-
-    strcpy(token_value, token_string->value);
-
     token->type = token_type;
-    token->value = token_value;
+    token->value = token_string->value;
+    token->value_string = token_string;
+    token->number = number;
 
-    string_free(token_string);
+    set_compilation_arena(arena);
     return token;
 }
 
+string_t *take_token_value(lexical_token_t *token) {
+    // token string stays with the token, the copy is released together with the compilation arena
+    if (token->value_string != NULL) return string_init_view(string_view_from_string(token->value_string));
+
+    return string_init(token->value);
+}
+
 void free_lexical_token(lexical_token_t *token) {
+    if (token == NULL) return;
+
+    string_free(token->value_string);
     free(token);
 }
 
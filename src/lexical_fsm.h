@@ -15,11 +15,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <ctype.h>
 #include <string.h>
-#include <regex.h>
 #include "str.h"
 #include "errors.h"
+#include "lexical_source.h"
 
 #define LEXICAL_TOKEN_STACK_INITIAL_SIZE 1
 
@@ -101,42 +102,96 @@ typedef enum LEXICAL_FSM_TOKENS {
     END_OF_FILE,
 } LEXICAL_FSM_TOKENS;
 
+/**
+ * Lexical Analyzer FSM states. Every state is a row of the transition table, so operators and brackets get a state
+ * per recognised prefix
+ */
 typedef enum LEXICAL_FSM_STATES {
     // Basic states
     START,
 
     // Control states
+    KEYWORD_QUESTION_STATE,
+    CLOSE_PHP_BRACKET_STATE,
     KEYWORD_STATE,
+    IDENTIFIER_START_STATE,
     IDENTIFIER_STATE,
 
-    // PHP brackets state
+    // PHP brackets states
     PHP_BRACKET_STATE,
+    PHP_BRACKET_P_STATE,
+    PHP_BRACKET_PH_STATE,
+    PHP_BRACKET_PHP_STATE,
+    PHP_BRACKET_INVALID_STATE,
 
-    // Start of file declare state
-    DECLARE_STATE,
+    // Equality states
+    ASSIGN_STATE,
+    EQUAL_STATE,
+    TYPED_EQUAL_STATE,
+    NOT_EQUAL_STATE,
+    TYPED_NOT_EQUAL_STATE,
+    INVALID_OPERATOR_STATE,
 
     // Arithmetic states
-    ARITHMETIC_STATE,
-    EQUAL_STATE,
-    LOGICAL_STATE,
+    PLUS_STATE,
+    MINUS_STATE,
+    MULTIPLY_STATE,
+    DIVIDE_STATE,
+    PLUS_ASSIGN_STATE,
+    MINUS_ASSIGN_STATE,
+    MULTIPLY_ASSIGN_STATE,
+    DIVIDE_ASSIGN_STATE,
+    INCREMENT_STATE,
+    DECREMENT_STATE,
+    INVALID_ARITHMETIC_STATE,
+
+    // Logical states
+    AND_STATE,
+    LOGICAL_AND_STATE,
+    OR_STATE,
+    LOGICAL_OR_STATE,
+    LOGICAL_NOT_STATE,
 
     // Square parenthesis states
-    SQUARE_PARENTHESIS_STATE,
-
-    // Data types states
-    INTEGER_STATE,
-    FLOAT_STATE,
-    STRING_STATE,
-    STRING_ESCAPE_STATE,
-
-    // Strict-types state
-    STRICT_TYPES_STATE,
+    LESS_STATE,
+    GREATER_STATE,
+    LESS_EQUAL_STATE,
+    GREATER_EQUAL_STATE,
+
+    // Data types states, numbers are scanned by a separate scanner
+    DOUBLE_QUOTED_STRING_STATE,
+    SINGLE_QUOTED_STRING_STATE,
+    DOUBLE_QUOTED_ESCAPE_STATE,
+    SINGLE_QUOTED_ESCAPE_STATE,
+    STRING_END_STATE,
 
     // Comment states
     COMMENT_STATE,
     MULTILINE_COMMENT_STATE,
+    MULTILINE_COMMENT_STAR_STATE,
 } LEXICAL_FSM_STATES;
 
+#define LEXICAL_FSM_STATES_COUNT (MULTILINE_COMMENT_STAR_STATE + 1)
+
+/**
+ * @union lexical_number_t
+ * Value of a numeric literal or identifier, converted once by the lexical analyser
+ *
+ * @var lexical_number_t::integer
+ * Value of INTEGER token
+ *
+ * @var lexical_number_t::floating
+ * Value of FLOAT token
+ *
+ * @var lexical_number_t::atom
+ * Interned name of IDENTIFIER token
+ */
+typedef union lexical_number {
+    int64_t integer;
+    double floating;
+    atom_t atom;
+} lexical_number_t;
+
 /**
  * @struct lexical_token_t
  * Lexical token structure
@@ -146,13 +201,44 @@ typedef enum LEXICAL_FSM_STATES {
  *
  * @var lexical_token_t::value
  * Lexical token value
+ *
+ * @var lexical_token_t::value_string
+ * String owning the value, NULL if the value is not owned by the token
+ *
+ * @var lexical_token_t::number
+ * Value of INTEGER and FLOAT tokens
  */
 typedef struct lexical_token {
     LEXICAL_FSM_TOKENS type;
     char *value;
+    string_t *value_string;
+    lexical_number_t number;
 } lexical_token_t;
 
 
+/**
+ * @struct lexical_span_t
+ * Lexical token referencing its text in the source instead of holding a copy
+ *
+ * @var lexical_span_t::type
+ * Lexical token type
+ *
+ * @var lexical_span_t::offset
+ * Offset of the token text in the source
+ *
+ * @var lexical_span_t::length
+ * Length of the token text
+ *
+ * @var lexical_span_t::number
+ * Value of INTEGER and FLOAT tokens, atom of IDENTIFIER tokens
+ */
+typedef struct lexical_span {
+    LEXICAL_FSM_TOKENS type;
+    size_t offset;
+    size_t length;
+    lexical_number_t number;
+} lexical_span_t;
+
 /**
  * @struct lexical_token_stack_t
  * Lexical token stack structure
@@ -173,7 +259,7 @@ typedef struct lexical_token_stack {
 } lexical_token_stack_t;
 
 /**
- * Get next lexical token type from file stream
+ * Get next lexical token type from file stream. The file is read to the end on the first call
  * @param fd file stream
  * @param token pointer to string to store token
  * @return token type
@@ -181,19 +267,104 @@ typedef struct lexical_token_stack {
 LEXICAL_FSM_TOKENS get_next_token(FILE *fd, string_t *token);
 
 /**
- * Generate file stream from text for lexical analysis
+ * Get next lexical token type from source
+ * @param source pointer to the source
+ * @param token pointer to string to store token
+ * @return token type
+ */
+LEXICAL_FSM_TOKENS get_next_token_source(lexical_source_t *source, string_t *token);
+
+/**
+ * Get next lexical token type from source together with value of numeric literals
+ * @param source pointer to the source
+ * @param token pointer to string to store token
+ * @param number pointer to store value of INTEGER and FLOAT tokens
+ * @return token type
+ */
+LEXICAL_FSM_TOKENS get_next_token_number(lexical_source_t *source, string_t *token, lexical_number_t *number);
+
+/**
+ * Get next lexical token from source as a span. Token text is not copied
+ * @param source pointer to the source
+ * @param span pointer to store the token
+ * @return token type
+ */
+LEXICAL_FSM_TOKENS get_next_span(lexical_source_t *source, lexical_span_t *span);
+
+/**
+ * Get next lexical token from source as a span, without reporting lexical errors
+ * @param source pointer to the source, left at the start of the invalid token on error
+ * @param span pointer to store the token
+ * @return true if the token was read, false on lexical error
+ */
+bool try_next_span(lexical_source_t *source, lexical_span_t *span);
+
+/**
+ * Gets text of a token span as written in the source
+ * @param source pointer to the source of the span
+ * @param span pointer to the span
+ * @return view of the token text, valid while the source is open
+ */
+string_view_t lexical_span_view(lexical_source_t *source, const lexical_span_t *span);
+
+/**
+ * Interns name of an identifier. Function names are not case-sensitive, so they are interned in lowercase
+ * @param atoms pointer to the atom table
+ * @param text identifier text as written in the source
+ * @param length number of bytes
+ * @return atom of the identifier
+ */
+atom_t lexical_identifier_atom(atom_table_t *atoms, const char *text, size_t length);
+
+/**
+ * Copies value of a token span. Keywords, PHP brackets and function names are converted to lowercase
+ * @param source pointer to the source of the span
+ * @param span pointer to the span
+ * @return string with token value
+ */
+string_t *lexical_span_value(lexical_source_t *source, const lexical_span_t *span);
+
+/**
+ * Decodes value of a STRING token span. Quotes are removed and escape sequences are replaced by the characters they
+ * stand for, so later phases work with the string payload only
+ * @param source pointer to the source of the span
+ * @param span pointer to the STRING span
+ * @return string with decoded value, its length is the number of decoded bytes
+ */
+string_t *lexical_span_string(lexical_source_t *source, const lexical_span_t *span);
+
+/**
+ * Generate source from text for lexical analysis. The text is not copied
  * @param input text
- * @return pointer to file stream
+ * @return pointer to the source
  */
-FILE *test_lex_input(char *input);
+lexical_source_t *test_lex_input(char *input);
 
 /**
- * Get next lexical token
+ * Get next lexical token from file stream. The file is read to the end on the first call
  * @param fd file stream
  * @return pointer to lexical token
  */
 lexical_token_t *get_token(FILE *fd);
 
+/**
+ * Get next lexical token from source
+ * @param source pointer to the source
+ * @return pointer to lexical token
+ */
+lexical_token_t *get_token_source(lexical_source_t *source);
+
+/**
+ * Copies the token value into the compilation arena, so syntax tree leaves do not own memory of the token
+ * @param token pointer to lexical token
+ * @return string with token value
+ */
+string_t *take_token_value(lexical_token_t *token);
+
+/**
+ * Frees lexical token together with its value
+ * @param token pointer to lexical token
+ */
 void free_lexical_token(lexical_token_t *token);
 
 /**
@@ -0,0 +1,130 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22.
+ * @authors
+ *   xmoise01, Nikita Moiseev
+ *
+ * @file lexical_source.c
+ * @brief Source code reader for the lexical analyser
+ * @date 17.10.2026
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "lexical_source.h"
+#include "errors.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * Allocates empty source
+ * @return pointer to the source
+ */
+static lexical_source_t *lexical_source_init() {
+    lexical_source_t *source = (lexical_source_t *) malloc(sizeof(lexical_source_t));
+    if (source == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for lexical source");
+    }
+
+    source->data = "";
+    source->length = 0;
+    source->position = 0;
+    source->buffer = NULL;
+    source->mapping = NULL;
+    source->mapping_length = 0;
+    source->atoms = atom_table_get();
+    return source;
+}
+
+/**
+ * Maps rest of a regular file into memory
+ * @param source pointer to the source
+ * @param file file to map
+ * @return true if the file was mapped, false if it has to be read
+ */
+static bool lexical_source_map(lexical_source_t *source, FILE *file) {
+    int fd = fileno(file);
+    struct stat file_stat;
+
+    if (fd < 0 || fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) return false;
+
+    long offset = ftell(file);
+    if (offset < 0 || offset > file_stat.st_size) return false;
+    if (offset == file_stat.st_size) return true;
+
+    size_t length = (size_t) file_stat.st_size;
+    void *mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) return false;
+
+    posix_madvise(mapping, length, POSIX_MADV_SEQUENTIAL);
+
+    source->mapping = mapping;
+    source->mapping_length = length;
+    source->data = (const char *) mapping + offset;
+    source->length = length - (size_t) offset;
+
+    fseek(file, 0, SEEK_END);
+    return true;
+}
+
+/**
+ * Reads rest of a file into buffer owned by the source
+ * @param source pointer to the source
+ * @param file file to read
+ */
+static void lexical_source_read(lexical_source_t *source, FILE *file) {
+    size_t capacity = LEXICAL_SOURCE_READ_SIZE;
+    size_t length = 0;
+    char *buffer = (char *) malloc(capacity);
+    if (buffer == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for lexical source buffer");
+    }
+
+    while (true) {
+        if (capacity - length < LEXICAL_SOURCE_READ_SIZE) {
+            capacity *= 2;
+            char *new_buffer = (char *) realloc(buffer, capacity);
+            if (new_buffer == NULL) {
+                INTERNAL_ERROR("Failed to allocate memory for lexical source buffer");
+            }
+            buffer = new_buffer;
+        }
+
+        size_t read = fread(buffer + length, 1, capacity - length, file);
+        length += read;
+
+        if (read == 0) break;
+    }
+
+    source->buffer = buffer;
+    source->data = buffer;
+    source->length = length;
+}
+
+lexical_source_t *lexical_source_open(FILE *file) {
+    lexical_source_t *source = lexical_source_init();
+
+    if (!lexical_source_map(source, file))
+        lexical_source_read(source, file);
+
+    return source;
+}
+
+lexical_source_t *lexical_source_from_memory(const char *data, size_t length) {
+    lexical_source_t *source = lexical_source_init();
+
+    source->data = data;
+    source->length = length;
+    return source;
+}
+
+void lexical_source_close(lexical_source_t *source) {
+    if (source == NULL) return;
+
+    if (source->mapping != NULL)
+        munmap(source->mapping, source->mapping_length);
+
+    free(source->buffer);
+    free(source);
+}
@@ -0,0 +1,104 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22.
+ * @authors
+ *   xmoise01, Nikita Moiseev
+ *
+ * @file lexical_source.h
+ * @brief Source code reader for the lexical analyser
+ * @date 17.10.2026
+ */
+
+#ifndef IFJ_PROJ_LEXICAL_SOURCE_H
+#define IFJ_PROJ_LEXICAL_SOURCE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "atom_table.h"
+
+#define LEXICAL_SOURCE_READ_SIZE (64 * 1024)
+
+/**
+ * @struct lexical_source_t
+ * Whole source code held in contiguous memory. Regular files are memory-mapped, other streams are read into a buffer
+ *
+ * @var lexical_source_t::data
+ * Source code bytes
+ *
+ * @var lexical_source_t::length
+ * Number of source code bytes
+ *
+ * @var lexical_source_t::position
+ * Index of the next byte to read. Reading past the end still advances the position, so every read can be taken back
+ *
+ * @var lexical_source_t::buffer
+ * Buffer owned by the source, NULL if the source does not own its data
+ *
+ * @var lexical_source_t::mapping
+ * Start of memory-mapped file, NULL if the file is not mapped
+ *
+ * @var lexical_source_t::mapping_length
+ * Length of memory-mapped region
+ *
+ * @var lexical_source_t::atoms
+ * Table identifiers are interned into, NULL to leave atoms of identifiers unset
+ */
+typedef struct lexical_source {
+    const char *data;
+    size_t length;
+    size_t position;
+    char *buffer;
+    void *mapping;
+    size_t mapping_length;
+    atom_table_t *atoms;
+} lexical_source_t;
+
+/**
+ * Opens source reading rest of the file. Regular files are memory-mapped, other files are read until end of file
+ * @param file file to read
+ * @return pointer to the source
+ */
+lexical_source_t *lexical_source_open(FILE *file);
+
+/**
+ * Opens source over memory. The memory is not copied and has to outlive the source
+ * @param data source code bytes
+ * @param length number of bytes
+ * @return pointer to the source
+ */
+lexical_source_t *lexical_source_from_memory(const char *data, size_t length);
+
+/**
+ * Closes source and releases its memory
+ * @param source pointer to the source
+ */
+void lexical_source_close(lexical_source_t *source);
+
+/**
+ * Reads next byte of the source
+ * @param source pointer to the source
+ * @return byte value, EOF at the end of source
+ */
+static inline int lexical_source_getc(lexical_source_t *source) {
+    size_t position = source->position++;
+    return position < source->length ? (unsigned char) source->data[position] : EOF;
+}
+
+/**
+ * Takes back the last read byte
+ * @param source pointer to the source
+ */
+static inline void lexical_source_ungetc(lexical_source_t *source) {
+    source->position--;
+}
+
+/**
+ * Checks if the whole source was read
+ * @param source pointer to the source
+ * @return true if there are no more bytes to read, false otherwise
+ */
+static inline bool lexical_source_eof(lexical_source_t *source) {
+    return source->position >= source->length;
+}
+
+#endif //IFJ_PROJ_LEXICAL_SOURCE_H
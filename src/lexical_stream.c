@@ -0,0 +1,465 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22.
+ * @authors
+ *   xmoise01, Nikita Moiseev
+ *
+ * @file lexical_stream.c
+ * @brief Pre-tokenized stream of lexical tokens
+ * @date 17.10.2026
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "lexical_stream.h"
+#include <pthread.h>
+
+/**
+ * Resizes all token arrays of the stream
+ * @param stream pointer to the stream
+ * @param capacity new capacity
+ */
+static void lexical_stream_resize(lexical_stream_t *stream, size_t capacity) {
+    unsigned char *types = (unsigned char *) realloc(stream->types, capacity * sizeof(unsigned char));
+    if (types == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for lexical stream");
+    }
+    stream->types = types;
+
+    uint32_t *offsets = (uint32_t *) realloc(stream->offsets, capacity * sizeof(uint32_t));
+    if (offsets == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for lexical stream");
+    }
+    stream->offsets = offsets;
+
+    uint32_t *lengths = (uint32_t *) realloc(stream->lengths, capacity * sizeof(uint32_t));
+    if (lengths == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for lexical stream");
+    }
+    stream->lengths = lengths;
+
+    lexical_number_t *numbers = (lexical_number_t *) realloc(stream->numbers, capacity * sizeof(lexical_number_t));
+    if (numbers == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for lexical stream");
+    }
+    stream->numbers = numbers;
+
+    stream->capacity = capacity;
+}
+
+/**
+ * Allocates empty stream
+ * @param source pointer to the source
+ * @param capacity initial capacity
+ * @return pointer to the stream
+ */
+static lexical_stream_t *lexical_stream_alloc(lexical_source_t *source, size_t capacity) {
+    lexical_stream_t *stream = (lexical_stream_t *) malloc(sizeof(lexical_stream_t));
+    if (stream == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for lexical stream");
+    }
+
+    stream->source = source;
+    stream->types = NULL;
+    stream->offsets = NULL;
+    stream->lengths = NULL;
+    stream->numbers = NULL;
+    stream->count = 0;
+    stream->position = 0;
+    stream->begin = source->position;
+
+    lexical_stream_resize(stream, capacity);
+    return stream;
+}
+
+/**
+ * Appends token to the stream
+ * @param stream pointer to the stream
+ * @param span pointer to the token
+ */
+static void lexical_stream_push(lexical_stream_t *stream, const lexical_span_t *span) {
+    if (stream->count == stream->capacity)
+        lexical_stream_resize(stream, stream->capacity * 2);
+
+    stream->types[stream->count] = (unsigned char) span->type;
+    stream->offsets[stream->count] = (uint32_t) span->offset;
+    stream->lengths[stream->count] = (uint32_t) span->length;
+    stream->numbers[stream->count] = span->number;
+    stream->count++;
+}
+
+/**
+ * Copies tokens of another stream from index to its end. The stream has to have enough capacity
+ * @param stream pointer to the stream
+ * @param destination index of the first copied token in the stream
+ * @param from pointer to the stream to copy tokens from
+ * @param index index of the first copied token
+ */
+static void lexical_stream_copy(lexical_stream_t *stream, size_t destination, const lexical_stream_t *from,
+                                size_t index) {
+    size_t count = from->count - index;
+
+    memcpy(stream->types + destination, from->types + index, count * sizeof(unsigned char));
+    memcpy(stream->offsets + destination, from->offsets + index, count * sizeof(uint32_t));
+    memcpy(stream->lengths + destination, from->lengths + index, count * sizeof(uint32_t));
+    memcpy(stream->numbers + destination, from->numbers + index, count * sizeof(lexical_number_t));
+}
+
+lexical_stream_t *lexical_stream_init(lexical_source_t *source) {
+    if (source->length > UINT32_MAX) {
+        INTERNAL_ERROR("Source is too large for lexical stream");
+    }
+
+    // tokens with separators take about four bytes, so this is mostly the final size
+    lexical_stream_t *stream = lexical_stream_alloc(source, source->length / 4 + LEXICAL_STREAM_MIN_CAPACITY);
+
+    lexical_span_t span;
+    do {
+        get_next_span(source, &span);
+        lexical_stream_push(stream, &span);
+    } while (span.type != END_OF_FILE);
+
+    return stream;
+}
+
+/**
+ * @struct lexical_stream_chunk_t
+ * Part of the source lexed by its own thread
+ *
+ * @var lexical_stream_chunk_t::source
+ * Copy of the source positioned at the chunk start
+ *
+ * @var lexical_stream_chunk_t::end
+ * Offset after the chunk, tokens starting there belong to the next chunk
+ *
+ * @var lexical_stream_chunk_t::tokens
+ * Tokens starting in the chunk, lexed as if the chunk started outside of any token
+ *
+ * @var lexical_stream_chunk_t::resume
+ * Offset where lexing continues after the last token of the chunk
+ *
+ * @var lexical_stream_chunk_t::finished
+ * True if the last token of the chunk is END_OF_FILE
+ *
+ * @var lexical_stream_chunk_t::prefix
+ * Tokens lexed serially before the chunk tokens could be used, NULL if there are none
+ *
+ * @var lexical_stream_chunk_t::first
+ * Index of the first used chunk token
+ *
+ * @var lexical_stream_chunk_t::stream
+ * Stream the chunk is copied to
+ *
+ * @var lexical_stream_chunk_t::destination
+ * Index of the first token of the chunk in the stream
+ */
+typedef struct lexical_stream_chunk {
+    lexical_source_t source;
+    size_t end;
+    lexical_stream_t *tokens;
+    size_t resume;
+    bool finished;
+    lexical_stream_t *prefix;
+    size_t first;
+    lexical_stream_t *stream;
+    size_t destination;
+} lexical_stream_chunk_t;
+
+/**
+ * Lexes tokens starting in a chunk. Lexing stops at the first lexical error, which is reported again by the serial
+ * pass if the chunk turns out to be lexed from the right state
+ * @param argument pointer to the chunk
+ * @return NULL
+ */
+static void *lexical_stream_lex_chunk(void *argument) {
+    lexical_stream_chunk_t *chunk = (lexical_stream_chunk_t *) argument;
+    lexical_span_t span;
+
+    chunk->finished = false;
+    while (true) {
+        size_t position = chunk->source.position;
+
+        if (!try_next_span(&chunk->source, &span)) {
+            chunk->resume = chunk->source.position;
+            break;
+        }
+
+        if (span.offset >= chunk->end) {
+            chunk->resume = position;
+            break;
+        }
+
+        lexical_stream_push(chunk->tokens, &span);
+        if (span.type == END_OF_FILE) {
+            chunk->finished = true;
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Copies serially lexed and used chunk tokens to the stream
+ * @param argument pointer to the chunk
+ * @return NULL
+ */
+static void *lexical_stream_copy_chunk(void *argument) {
+    lexical_stream_chunk_t *chunk = (lexical_stream_chunk_t *) argument;
+    size_t destination = chunk->destination;
+
+    if (chunk->prefix != NULL) {
+        lexical_stream_copy(chunk->stream, destination, chunk->prefix, 0);
+        destination += chunk->prefix->count;
+    }
+
+    lexical_stream_copy(chunk->stream, destination, chunk->tokens, chunk->first);
+    return NULL;
+}
+
+/**
+ * Runs routine for every chunk, the first chunk is processed by the calling thread. Chunks are processed
+ * by the calling thread also if a thread can not be started
+ * @param chunks array of chunks
+ * @param count number of chunks
+ * @param routine routine taking pointer to a chunk
+ */
+static void lexical_stream_run(lexical_stream_chunk_t *chunks, size_t count, void *(*routine)(void *)) {
+    pthread_t *workers = (pthread_t *) malloc(count * sizeof(pthread_t));
+    bool *started = (bool *) malloc(count * sizeof(bool));
+    if (workers == NULL || started == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for lexical stream threads");
+    }
+
+    started[0] = false;
+    for (size_t i = 1; i < count; i++)
+        started[i] = pthread_create(&workers[i], NULL, routine, &chunks[i]) == 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (started[i]) pthread_join(workers[i], NULL);
+        else routine(&chunks[i]);
+    }
+
+    free(workers);
+    free(started);
+}
+
+/**
+ * Finds token of a chunk starting at offset
+ * @param tokens pointer to tokens of the chunk
+ * @param cursor pointer to index to search from, moved past tokens starting before the offset
+ * @param offset token offset
+ * @return true if a token starts at the offset, false otherwise
+ */
+static bool lexical_stream_find_offset(const lexical_stream_t *tokens, size_t *cursor, size_t offset) {
+    while (*cursor < tokens->count && tokens->offsets[*cursor] < offset) (*cursor)++;
+
+    return *cursor < tokens->count && tokens->offsets[*cursor] == offset;
+}
+
+/**
+ * Lexes serially from the start of the first chunk until every chunk is joined to the tokens before it. Chunks
+ * are lexed from a guessed state, but once a serially lexed token starts where a chunk token starts, the rest of
+ * the chunk is the same as serial lexing. Lexical errors are reported here, in source order
+ * @param source pointer to the source positioned at the start of the first chunk
+ * @param chunks array of lexed chunks
+ * @param count number of chunks
+ * @return total number of tokens
+ */
+static size_t lexical_stream_join_chunks(lexical_source_t *source, lexical_stream_chunk_t *chunks, size_t count) {
+    size_t current = 0;
+    size_t cursor = 0;
+    lexical_span_t span;
+
+    for (size_t i = 0; i < count; i++) {
+        chunks[i].prefix = NULL;
+        chunks[i].first = chunks[i].tokens->count;
+    }
+
+    while (true) {
+        get_next_span(source, &span);
+
+        while (current + 1 < count && span.offset >= chunks[current].end) {
+            current++;
+            cursor = 0;
+        }
+
+        lexical_stream_chunk_t *chunk = &chunks[current];
+        if (chunk->first == chunk->tokens->count && lexical_stream_find_offset(chunk->tokens, &cursor, span.offset)) {
+            chunk->first = cursor;
+            source->position = chunk->resume;
+
+            if (chunk->finished) {
+                source->position = chunk->source.position;
+                break;
+            }
+
+            continue;
+        }
+
+        if (chunk->prefix == NULL) chunk->prefix = lexical_stream_alloc(source, LEXICAL_STREAM_MIN_CAPACITY);
+        lexical_stream_push(chunk->prefix, &span);
+        if (span.type == END_OF_FILE) break;
+    }
+
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        chunks[i].destination = total;
+        total += (chunks[i].prefix != NULL ? chunks[i].prefix->count : 0) + chunks[i].tokens->count - chunks[i].first;
+    }
+
+    return total;
+}
+
+lexical_stream_t *lexical_stream_init_parallel(lexical_source_t *source, size_t threads) {
+    if (source->length > UINT32_MAX) {
+        INTERNAL_ERROR("Source is too large for lexical stream");
+    }
+
+    size_t start = source->position;
+    size_t begin = start;
+    size_t remaining = source->length > begin ? source->length - begin : 0;
+    if (threads > remaining / LEXICAL_STREAM_MIN_CHUNK) threads = remaining / LEXICAL_STREAM_MIN_CHUNK;
+    if (threads < 2) return lexical_stream_init(source);
+
+    lexical_stream_chunk_t *chunks = (lexical_stream_chunk_t *) malloc(threads * sizeof(lexical_stream_chunk_t));
+    if (chunks == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for lexical stream chunks");
+    }
+
+    // split at newlines, no token but strings and multi-line comments continues past them
+    size_t count = 0;
+    while (begin < source->length) {
+        size_t end = count + 1 == threads ? source->length : begin + remaining / threads;
+        if (end < source->length) {
+            const char *newline = (const char *) memchr(source->data + end, '\n', source->length - end);
+            end = newline == NULL ? source->length : (size_t) (newline - source->data) + 1;
+        }
+
+        chunks[count].source = *source;
+        chunks[count].source.position = begin;
+        // atom table belongs to the calling thread, identifiers are interned after the chunks are joined
+        chunks[count].source.atoms = NULL;
+        chunks[count].end = end < source->length ? end : SIZE_MAX;
+        chunks[count].tokens = lexical_stream_alloc(source, (end - begin) / 4 + LEXICAL_STREAM_MIN_CAPACITY);
+        count++;
+        begin = end;
+    }
+
+    lexical_stream_run(chunks, count, lexical_stream_lex_chunk);
+
+    size_t total = lexical_stream_join_chunks(source, chunks, count);
+    lexical_stream_t *stream = lexical_stream_alloc(source, total);
+    stream->count = total;
+    stream->begin = start;
+
+    for (size_t i = 0; i < count; i++) chunks[i].stream = stream;
+    lexical_stream_run(chunks, count, lexical_stream_copy_chunk);
+
+    if (source->atoms != NULL) {
+        for (size_t i = 0; i < total; i++) {
+            if (stream->types[i] != IDENTIFIER) continue;
+
+            stream->numbers[i].atom = lexical_identifier_atom(source->atoms, source->data + stream->offsets[i],
+                                                              stream->lengths[i]);
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        lexical_stream_free(chunks[i].prefix);
+        lexical_stream_free(chunks[i].tokens);
+    }
+    free(chunks);
+
+    return stream;
+}
+
+/**
+ * Gets offset of the end of a token
+ * @param stream pointer to the stream
+ * @param index token index
+ * @return offset of the first byte after the token
+ */
+static size_t lexical_stream_token_end(const lexical_stream_t *stream, size_t index) {
+    return (size_t) stream->offsets[index] + stream->lengths[index];
+}
+
+lexical_stream_change_t lexical_stream_relex(lexical_stream_t *stream, lexical_source_t *source, size_t offset,
+                                             size_t removed_length, size_t inserted_length) {
+    size_t old_length = stream->offsets[stream->count - 1];
+    if (offset < stream->begin || offset + removed_length > old_length ||
+        source->length != old_length - removed_length + inserted_length) {
+        INTERNAL_ERROR("Edit does not match the lexical stream");
+    }
+    if (source->length > UINT32_MAX) {
+        INTERNAL_ERROR("Source is too large for lexical stream");
+    }
+
+    // token ends never decrease, find the first token whose lexing read a byte of the edit
+    size_t low = 0;
+    size_t high = stream->count - 1;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (lexical_stream_token_end(stream, middle) + LEXICAL_STREAM_LOOKAHEAD > offset)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+
+    lexical_stream_change_t change = {low, 0, 0};
+    size_t edit_end = offset + inserted_length;
+    size_t old_index = change.first;
+    lexical_stream_t *tokens = lexical_stream_alloc(source, LEXICAL_STREAM_MIN_CAPACITY);
+    lexical_span_t span;
+
+    source->position = change.first == 0 ? stream->begin : lexical_stream_token_end(stream, change.first - 1);
+    do {
+        get_next_span(source, &span);
+        lexical_stream_push(tokens, &span);
+        if (span.offset + span.length < edit_end) continue;
+
+        // lexing continues from the same bytes as after the previous token ending there
+        size_t end = span.offset + span.length + removed_length - inserted_length;
+        while (old_index < stream->count - 1 && lexical_stream_token_end(stream, old_index) < end) old_index++;
+        // END_OF_FILE has no length, a token ending at the old source end must not stand in for it
+        if (old_index < stream->count - 1 && lexical_stream_token_end(stream, old_index) == end) break;
+    } while (span.type != END_OF_FILE);
+
+    if (span.type == END_OF_FILE) old_index = stream->count - 1;
+
+    change.removed = old_index + 1 - change.first;
+    change.inserted = tokens->count;
+
+    size_t tail = stream->count - old_index - 1;
+    size_t count = change.first + change.inserted + tail;
+    if (count > stream->capacity) lexical_stream_resize(stream, count);
+
+    size_t from = old_index + 1;
+    size_t to = change.first + change.inserted;
+    memmove(stream->types + to, stream->types + from, tail * sizeof(unsigned char));
+    memmove(stream->offsets + to, stream->offsets + from, tail * sizeof(uint32_t));
+    memmove(stream->lengths + to, stream->lengths + from, tail * sizeof(uint32_t));
+    memmove(stream->numbers + to, stream->numbers + from, tail * sizeof(lexical_number_t));
+    for (size_t i = to; i < count; i++)
+        stream->offsets[i] = (uint32_t) (stream->offsets[i] + inserted_length - removed_length);
+
+    stream->count = change.first;
+    lexical_stream_copy(stream, change.first, tokens, 0);
+    stream->count = count;
+    stream->source = source;
+    stream->position = 0;
+
+    lexical_stream_free(tokens);
+    return change;
+}
+
+void lexical_stream_free(lexical_stream_t *stream) {
+    if (stream == NULL) return;
+
+    free(stream->types);
+    free(stream->offsets);
+    free(stream->lengths);
+    free(stream->numbers);
+    free(stream);
+}
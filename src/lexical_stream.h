@@ -0,0 +1,162 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22.
+ * @authors
+ *   xmoise01, Nikita Moiseev
+ *
+ * @file lexical_stream.h
+ * @brief Pre-tokenized stream of lexical tokens
+ * @date 17.10.2026
+ */
+
+#ifndef IFJ_PROJ_LEXICAL_STREAM_H
+#define IFJ_PROJ_LEXICAL_STREAM_H
+
+#include "lexical_fsm.h"
+
+#define LEXICAL_STREAM_MIN_CAPACITY 64
+#define LEXICAL_STREAM_MIN_CHUNK (256 * 1024)
+// bytes past the token end the lexer reads before it returns the token
+#define LEXICAL_STREAM_LOOKAHEAD 1
+
+/**
+ * @struct lexical_stream_t
+ * All tokens of a source stored as parallel arrays
+ *
+ * @var lexical_stream_t::source
+ * Source the tokens reference
+ *
+ * @var lexical_stream_t::types
+ * Token types
+ *
+ * @var lexical_stream_t::offsets
+ * Offsets of token texts in the source
+ *
+ * @var lexical_stream_t::lengths
+ * Lengths of token texts
+ *
+ * @var lexical_stream_t::numbers
+ * Values of INTEGER and FLOAT tokens
+ *
+ * @var lexical_stream_t::count
+ * Number of tokens including the final END_OF_FILE
+ *
+ * @var lexical_stream_t::capacity
+ * Number of tokens the arrays can hold
+ *
+ * @var lexical_stream_t::position
+ * Index of the next token to read
+ *
+ * @var lexical_stream_t::begin
+ * Offset in the source the first token was lexed from
+ */
+typedef struct lexical_stream {
+    lexical_source_t *source;
+    unsigned char *types;
+    uint32_t *offsets;
+    uint32_t *lengths;
+    lexical_number_t *numbers;
+    size_t count;
+    size_t capacity;
+    size_t position;
+    size_t begin;
+} lexical_stream_t;
+
+/**
+ * Tokenizes the whole source. Lexical errors are reported before any token is returned
+ * @param source pointer to the source, it has to outlive the stream
+ * @return pointer to the stream
+ */
+lexical_stream_t *lexical_stream_init(lexical_source_t *source);
+
+/**
+ * Tokenizes the whole source, splitting it at newlines into chunks lexed by separate threads. Tokens and errors are
+ * the same as with lexical_stream_init
+ * @param source pointer to the source, it has to outlive the stream
+ * @param threads maximal number of threads, chunks are at least LEXICAL_STREAM_MIN_CHUNK bytes long
+ * @return pointer to the stream
+ */
+lexical_stream_t *lexical_stream_init_parallel(lexical_source_t *source, size_t threads);
+
+/**
+ * @struct lexical_stream_change_t
+ * Tokens replaced by incremental lexing
+ *
+ * @var lexical_stream_change_t::first
+ * Index of the first replaced token
+ *
+ * @var lexical_stream_change_t::removed
+ * Number of tokens of the previous stream that were replaced
+ *
+ * @var lexical_stream_change_t::inserted
+ * Number of new tokens in their place
+ */
+typedef struct lexical_stream_change {
+    size_t first;
+    size_t removed;
+    size_t inserted;
+} lexical_stream_change_t;
+
+/**
+ * Updates the stream after an edit of its source. Tokens are lexed again only from the last token the edit can not
+ * affect, until a token ends where a token of the previous stream ended after the edit. Following tokens are reused
+ * with shifted offsets. The stream is read again from its first token
+ * @param stream pointer to the stream of the source before the edit
+ * @param source pointer to the source after the edit, it has to outlive the stream
+ * @param offset offset of the edit
+ * @param removed_length number of bytes the edit removed
+ * @param inserted_length number of bytes the edit inserted at offset
+ * @return range of tokens that changed
+ */
+lexical_stream_change_t lexical_stream_relex(lexical_stream_t *stream, lexical_source_t *source, size_t offset,
+                                             size_t removed_length, size_t inserted_length);
+
+/**
+ * Frees the stream, the source is left open
+ * @param stream pointer to the stream
+ */
+void lexical_stream_free(lexical_stream_t *stream);
+
+/**
+ * Gets token at index. Indexes past the end give the final END_OF_FILE token
+ * @param stream pointer to the stream
+ * @param index token index
+ * @param span pointer to store the token
+ * @return token type
+ */
+static inline LEXICAL_FSM_TOKENS lexical_stream_get(const lexical_stream_t *stream, size_t index, lexical_span_t *span) {
+    if (index >= stream->count) index = stream->count - 1;
+
+    span->type = (LEXICAL_FSM_TOKENS) stream->types[index];
+    span->offset = stream->offsets[index];
+    span->length = stream->lengths[index];
+    span->number = stream->numbers[index];
+    return span->type;
+}
+
+/**
+ * Gets type of a token after the next one without reading it
+ * @param stream pointer to the stream
+ * @param ahead number of tokens to look ahead, 0 is the next token
+ * @return token type
+ */
+static inline LEXICAL_FSM_TOKENS lexical_stream_peek(const lexical_stream_t *stream, size_t ahead) {
+    size_t index = stream->position + ahead;
+    if (index >= stream->count) index = stream->count - 1;
+
+    return (LEXICAL_FSM_TOKENS) stream->types[index];
+}
+
+/**
+ * Reads next token, the final END_OF_FILE is returned repeatedly
+ * @param stream pointer to the stream
+ * @param span pointer to store the token
+ * @return token type
+ */
+static inline LEXICAL_FSM_TOKENS lexical_stream_next(lexical_stream_t *stream, lexical_span_t *span) {
+    LEXICAL_FSM_TOKENS type = lexical_stream_get(stream, stream->position, span);
+    if (stream->position < stream->count) stream->position++;
+
+    return type;
+}
+
+#endif //IFJ_PROJ_LEXICAL_STREAM_H
@@ -12,11 +12,17 @@
 #include "semantic_analyzer.h"
 #include "optimiser.h"
 #include "code_generator.h"
+#include "arena.h"
 
 int main(int argc, char **argv) {
     FILE *input = stdin;
 
-    syntax_abstract_tree_t *tree = load_syntax_tree(input);
+    arena_t *arena = arena_init();
+    set_compilation_arena(arena);
+
+    lexical_source_t *source = lexical_source_open(input);
+    syntax_abstract_tree_t *tree = load_syntax_tree_source(source);
+    lexical_source_close(source);
 
     semantic_tree_check(tree);
 
@@ -41,8 +47,13 @@ int main(int argc, char **argv) {
     if (current_semantic_state->used_functions & SEMANTIC_ORD)
         generate_ord();
 
+    flush_code_gen_output();
+
     dispose_symtable();
-//    free_syntax_tree(tree);
+    dispose_syntax_trees();
+
+    set_compilation_arena(NULL);
+    arena_destroy(arena);
 
     return 0;
 }
@@ -25,16 +25,13 @@ bool is_true(syntax_abstract_tree_t *tree) {
     if (!tree) return true;
 
     if (tree->type == SYN_NODE_INTEGER) {
-        if (!strcmp(tree->value->value, "0")) return false;
-
-        return true;
+        return tree->number.integer != 0;
     } else if (tree->type == SYN_NODE_FLOAT) {
-        double tree_number = strtod(tree->value->value, &numbers_buffer);
-        double int_value = (int) tree_number;
+        double int_value = (int) tree->number.floating;
 
         return int_value != 0;
     } else if (tree->type == SYN_NODE_STRING) {
-        return tree->value->length != 2;
+        return tree->value->length != 0;
     } else if (tree->type == SYN_NODE_KEYWORD_NULL) {
         return false;
     }
@@ -46,7 +43,7 @@ bool is_unused(syntax_abstract_tree_t *tree) {
     if (!tree) return true;
 
     if (tree->type == SYN_NODE_IDENTIFIER) {
-        bool same_identifier_name = !strcmp(tree->value->value, optimiser_params->current_unused_variable_name->value);
+        bool same_identifier_name = tree->number.atom == optimiser_params->current_unused_variable_atom;
 
         if (same_identifier_name) {
             return false;
@@ -56,12 +53,12 @@ bool is_unused(syntax_abstract_tree_t *tree) {
     return true;
 }
 
-void optimise_unreachable_while(syntax_abstract_tree_t *tree) {
-    if (!tree || !tree->right) return;
+void optimise_unreachable_while(syntax_abstract_tree_t **statement) {
+    if (!*statement) return;
 
-    if (tree->right->type != SYN_NODE_KEYWORD_WHILE) return;
+    if ((*statement)->type != SYN_NODE_KEYWORD_WHILE) return;
 
-    syntax_abstract_tree_t *cond_copy = tree_copy(tree->right->left);
+    syntax_abstract_tree_t *cond_copy = tree_copy((*statement)->left);
     if ((cond_copy->type & (SYN_NODE_INTEGER | SYN_NODE_FLOAT | SYN_NODE_STRING)) == 0) {
         process_tree_using(cond_copy, optimize_expression, POSTORDER);
     } else {
@@ -69,56 +66,39 @@ void optimise_unreachable_while(syntax_abstract_tree_t *tree) {
     }
     bool is_cond_false = !check_tree_using(cond_copy, is_true);
 
-    free_syntax_tree(cond_copy);
-    cond_copy = NULL;
-
     if (is_cond_false) {
-        free_syntax_tree(tree->right);
-        tree->right = NULL;
+        *statement = NULL;
     } else {
-        optimize_node(tree->right->right, OPTIMISE_UNREACHABLE_CODE);
+        optimize_node((*statement)->right, OPTIMISE_UNREACHABLE_CODE);
     }
 }
 
-void optimise_unreachable_if(syntax_abstract_tree_t *tree) {
-    if (!tree || !tree->right) return;
-
-    if (tree->right->type != SYN_NODE_KEYWORD_IF) return;
-
-    if (!check_tree_using(tree->right->left, can_detect_bool)) return;
+void optimise_unreachable_if(syntax_abstract_tree_t **statement) {
+    syntax_abstract_tree_t *tree = *statement;
+    if (!tree) return;
 
-    bool is_expr_true = check_tree_using(tree->right->left, is_true);
+    if (tree->type != SYN_NODE_KEYWORD_IF) return;
 
-    free_syntax_tree(tree->right->left);
-    tree->right->left = NULL;
+    if (!check_tree_using(tree->left, can_detect_bool)) return;
 
-    bool has_else = tree->right->right != NULL;
+    bool is_expr_true = check_tree_using(tree->left, is_true);
 
     if (is_expr_true) {
-        if (has_else) {
-            free_syntax_tree(tree->right->right);
-            tree->right->right = NULL;
-        }
+        *statement = tree->middle;
 
-        tree->right = tree->right->middle;
-
-        optimize_node(tree->right, OPTIMISE_UNREACHABLE_CODE);
+        optimize_node(*statement, OPTIMISE_UNREACHABLE_CODE);
     } else {
-        if (has_else) {
-            tree->right = tree->right->right;
+        if (tree->right != NULL) {
+            *statement = tree->right;
 
-            if (tree->right->type == SYN_NODE_KEYWORD_IF) {
-                optimise_unreachable_if(tree);
+            if ((*statement)->type == SYN_NODE_KEYWORD_IF) {
+                optimise_unreachable_if(statement);
             }
         } else {
-            free_syntax_tree(tree->right);
-            tree->right = NULL;
+            *statement = NULL;
         }
 
-        free_syntax_tree(tree->middle);
-        tree->middle = NULL;
-
-        optimize_node(tree->right, OPTIMISE_UNREACHABLE_CODE);
+        optimize_node(*statement, OPTIMISE_UNREACHABLE_CODE);
     }
 }
 
@@ -129,153 +109,509 @@ void replace_variable_usage_internal(syntax_abstract_tree_t *tree) {
         (SYN_NODE_ADD | SYN_NODE_SUB | SYN_NODE_MUL | SYN_NODE_DIV | SYN_NODE_TYPED_EQUAL | SYN_NODE_TYPED_NOT_EQUAL |
          SYN_NODE_LESS | SYN_NODE_LESS_EQUAL | SYN_NODE_GREATER | SYN_NODE_GREATER_EQUAL)) {
         if (tree->left->type == SYN_NODE_IDENTIFIER &&
-            !strcmp(tree->left->value->value, optimiser_params->current_replaced_variable_name->value)) {
+            tree->left->number.atom == optimiser_params->current_replaced_variable_atom) {
             tree->left = tree_copy(optimiser_params->current_replaced_variable_tree);
         }
         if (tree->right->type == SYN_NODE_IDENTIFIER &&
-            !strcmp(tree->right->value->value, optimiser_params->current_replaced_variable_name->value)) {
+            tree->right->number.atom == optimiser_params->current_replaced_variable_atom) {
             tree->right = tree_copy(optimiser_params->current_replaced_variable_tree);
         }
     }
 
     if (tree->type & SYN_NODE_ARGS) {
         if (tree->left->type == SYN_NODE_IDENTIFIER &&
-            !strcmp(tree->left->value->value, optimiser_params->current_replaced_variable_name->value)) {
+            tree->left->number.atom == optimiser_params->current_replaced_variable_atom) {
             tree->left = tree_copy(optimiser_params->current_replaced_variable_tree);
         }
     }
 }
 
-void replace_variable_usage(syntax_abstract_tree_t *tree, syntax_abstract_tree_t *current_tree) {
-    if (!tree) return;
-
-    syntax_abstract_tree_t *trees[1000] = {NULL};
+/**
+ * Checks if statement assigns the replaced variable its current value
+ * @param statement statement to check
+ * @return true if it is the assignment, false otherwise
+ */
+static bool is_replaced_assignment(syntax_abstract_tree_t *statement) {
+    return statement && statement->type == SYN_NODE_ASSIGN &&
+           statement->left->number.atom == optimiser_params->current_replaced_variable_atom &&
+           compare_syntax_tree(statement->right, optimiser_params->current_replaced_variable_tree);
+}
 
-    int i = 0;
-    int current_level = -1;
+/**
+ * Checks if statement is the assignment of the unused variable
+ * @param statement statement to check
+ * @return true if it is the assignment, false otherwise
+ */
+static bool is_unused_assignment(syntax_abstract_tree_t *statement) {
+    return statement && statement->type == SYN_NODE_ASSIGN &&
+           statement->left->number.atom == optimiser_params->current_unused_variable_atom &&
+           compare_syntax_tree(statement, optimiser_params->current_unused_variable_tree);
+}
 
-    while (tree && tree->type == SYN_NODE_SEQUENCE) {
-        trees[i++] = tree;
+/**
+ * Grows the last mention array, so it can hold the identifier
+ * @param atom identifier to hold
+ */
+static void reserve_atom_entries(atom_t atom) {
+    if (atom < optimiser_params->atom_capacity) return;
 
-        bool is_same_tree = compare_syntax_tree(tree->right->right, optimiser_params->current_replaced_variable_tree);
+    size_t capacity = optimiser_params->atom_capacity ? optimiser_params->atom_capacity : 64;
+    while (capacity <= atom) capacity *= 2;
 
-        if (current_level == -1 && tree->right && tree->right->type == SYN_NODE_ASSIGN &&
-            !strcmp(tree->right->left->value->value, optimiser_params->current_replaced_variable_name->value) &&
-            is_same_tree)
-            current_level = i;
-        tree = tree->left;
+    size_t *entries = (size_t *) realloc(optimiser_params->atom_entries, capacity * sizeof(size_t));
+    if (entries == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for optimiser index")
     }
 
-    if (current_level == -1) current_level = i;
+    for (size_t i = optimiser_params->atom_capacity; i < capacity; i++) entries[i] = OPTIMISER_NO_ENTRY;
 
-    for (int j = current_level - 1; j >= 0; j--) {
-        syntax_abstract_tree_t *current = trees[j];
+    optimiser_params->atom_entries = entries;
+    optimiser_params->atom_capacity = capacity;
+}
 
-        bool is_same_tree = compare_syntax_tree(current->right->right,
-                                                optimiser_params->current_replaced_variable_tree);
+/**
+ * Adds identifier to the mentions of the indexed statement
+ * @param tree abstract syntax tree
+ */
+static void index_identifier(syntax_abstract_tree_t *tree) {
+    if (!tree || tree->type != SYN_NODE_IDENTIFIER) return;
 
-        if (current->right && current->right->type == SYN_NODE_ASSIGN &&
-            !strcmp(current->right->left->value->value, optimiser_params->current_replaced_variable_name->value) &&
-            is_same_tree)
-            continue;
+    optimiser_block_index_t *index = optimiser_params->block_index;
+    atom_t atom = tree->number.atom;
 
-        if (current->right->type == SYN_NODE_ASSIGN) {
-            if (!strcmp(current->right->left->value->value, optimiser_params->current_replaced_variable_name->value)) {
-                process_tree_using(current->right->right, replace_variable_usage_internal, POSTORDER);
-                break;
-            }
+    reserve_atom_entries(atom);
+
+    size_t previous = optimiser_params->atom_entries[atom];
+    if (previous != OPTIMISER_NO_ENTRY && index->entry_statements[previous] == index->current) return;
+
+    if (index->entry_count == index->entry_capacity) {
+        size_t capacity = index->entry_capacity ? index->entry_capacity * 2 : 64;
+
+        index->entry_atoms = (atom_t *) realloc(index->entry_atoms, capacity * sizeof(atom_t));
+        index->entry_statements = (size_t *) realloc(index->entry_statements, capacity * sizeof(size_t));
+        index->entry_next = (size_t *) realloc(index->entry_next, capacity * sizeof(size_t));
+        index->entry_previous = (size_t *) realloc(index->entry_previous, capacity * sizeof(size_t));
+        if (!index->entry_atoms || !index->entry_statements || !index->entry_next || !index->entry_previous) {
+            INTERNAL_ERROR("Failed to allocate memory for optimiser index")
         }
 
-        if (current->right->type == SYN_NODE_KEYWORD_IF) {
+        index->entry_capacity = capacity;
+    }
+
+    size_t entry = index->entry_count++;
+    index->entry_atoms[entry] = atom;
+    index->entry_statements[entry] = index->current;
+    index->entry_next[entry] = OPTIMISER_NO_ENTRY;
+    index->entry_previous[entry] = previous;
+    if (previous != OPTIMISER_NO_ENTRY) index->entry_next[previous] = entry;
+
+    optimiser_params->atom_entries[atom] = entry;
+}
+
+/**
+ * Orders number literal assignments by variable and literal
+ * @param left_atom variable of the first assignment
+ * @param left_value literal of the first assignment
+ * @param right_atom variable of the second assignment
+ * @param right_value literal of the second assignment
+ * @return negative, zero or positive number like strcmp
+ */
+static int compare_assignment_values(atom_t left_atom, syntax_abstract_tree_t *left_value, atom_t right_atom,
+                                     syntax_abstract_tree_t *right_value) {
+    if (left_atom != right_atom) return left_atom < right_atom ? -1 : 1;
+
+    if (left_value->type != right_value->type) return left_value->type < right_value->type ? -1 : 1;
+
+    if (!left_value->value || !right_value->value) return !right_value->value - !left_value->value;
+
+    return string_view_compare(string_view_from_string(left_value->value),
+                               string_view_from_string(right_value->value));
+}
+
+/**
+ * qsort callback ordering statement indexes of number literal assignments
+ * @param left first statement index
+ * @param right second statement index
+ * @return negative, zero or positive number like strcmp
+ */
+static int compare_value_statements(const void *left, const void *right) {
+    size_t left_index = *(const size_t *) left;
+    size_t right_index = *(const size_t *) right;
+    syntax_abstract_tree_t **statements = optimiser_params->block_index->block->statements;
+
+    int result = compare_assignment_values(statements[left_index]->left->number.atom, statements[left_index]->right,
+                                           statements[right_index]->left->number.atom,
+                                           statements[right_index]->right);
+    if (result != 0) return result;
+
+    return left_index < right_index ? -1 : left_index > right_index;
+}
+
+/**
+ * Indexes statements of the block and makes the index current
+ * @param block block to index
+ * @return created index
+ */
+static optimiser_block_index_t *push_block_index(syntax_abstract_tree_t *block) {
+    optimiser_block_index_t *index = (optimiser_block_index_t *) malloc(sizeof(optimiser_block_index_t));
+    size_t count = block->statement_count;
+
+    if (index == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for optimiser index")
+    }
+
+    index->block = block;
+    index->current = 0;
+    index->entry_atoms = NULL;
+    index->entry_statements = NULL;
+    index->entry_next = NULL;
+    index->entry_previous = NULL;
+    index->entry_count = 0;
+    index->entry_capacity = 0;
+    index->statement_entries = (size_t *) malloc((count + 1) * sizeof(size_t));
+    index->next_ifs = (size_t *) malloc((count + 1) * sizeof(size_t));
+    index->next_whiles = (size_t *) malloc((count + 1) * sizeof(size_t));
+    index->values = (size_t *) malloc((count + 1) * sizeof(size_t));
+    index->value_lasts = (size_t *) malloc((count + 1) * sizeof(size_t));
+    index->value_count = 0;
+    index->parent = optimiser_params->block_index;
+
+    if (!index->statement_entries || !index->next_ifs || !index->next_whiles || !index->values ||
+        !index->value_lasts) {
+        INTERNAL_ERROR("Failed to allocate memory for optimiser index")
+    }
+
+    optimiser_params->block_index = index;
+
+    for (size_t i = 0; i < count; i++) {
+        syntax_abstract_tree_t *statement = block->statements[i];
+
+        index->current = i;
+        index->statement_entries[i] = index->entry_count;
+        index->next_whiles[i] = statement && statement->type == SYN_NODE_KEYWORD_WHILE ? i : i + 1;
+
+        if (!statement) continue;
+
+        process_tree_using(statement, index_identifier, PREORDER);
+
+        if (statement->type == SYN_NODE_ASSIGN && (statement->right->type & (SYN_NODE_INTEGER | SYN_NODE_FLOAT)))
+            index->values[index->value_count++] = i;
+    }
+
+    index->current = 0;
+    index->statement_entries[count] = index->entry_count;
+    index->next_whiles[count] = count;
+    index->next_ifs[count] = count;
+
+    for (size_t i = count; i > 0; i--) {
+        syntax_abstract_tree_t *statement = block->statements[i - 1];
+        index->next_ifs[i - 1] = statement && statement->type == SYN_NODE_KEYWORD_IF ? i - 1 : index->next_ifs[i];
+    }
+
+    qsort(index->values, index->value_count, sizeof(size_t), compare_value_statements);
+
+    // items of a group are ordered by position, so the last item holds the group's last assignment
+    for (size_t i = index->value_count; i > 0; i--) {
+        syntax_abstract_tree_t *statement = block->statements[index->values[i - 1]];
+        syntax_abstract_tree_t *next = i < index->value_count ? block->statements[index->values[i]] : NULL;
+        bool is_group_end = !next || compare_assignment_values(statement->left->number.atom, statement->right,
+                                                               next->left->number.atom, next->right) != 0;
+
+        index->value_lasts[i - 1] = is_group_end ? index->values[i - 1] : index->value_lasts[i];
+    }
+
+    return index;
+}
+
+/**
+ * Forgets last mentions of the identifiers of the index
+ * @param index block index
+ */
+static void reset_atom_entries(optimiser_block_index_t *index) {
+    for (size_t i = 0; i < index->entry_count; i++)
+        optimiser_params->atom_entries[index->entry_atoms[i]] = OPTIMISER_NO_ENTRY;
+}
+
+/**
+ * Frees the current index and makes its parent current
+ */
+static void pop_block_index() {
+    optimiser_block_index_t *index = optimiser_params->block_index;
+
+    optimiser_params->block_index = index->parent;
+
+    free(index->entry_atoms);
+    free(index->entry_statements);
+    free(index->entry_next);
+    free(index->entry_previous);
+    free(index->statement_entries);
+    free(index->next_ifs);
+    free(index->next_whiles);
+    free(index->values);
+    free(index->value_lasts);
+    free(index);
+}
+
+/**
+ * Finds the last statement assigning the same number literal to the same variable
+ * @param index block index
+ * @param atom assigned variable
+ * @param value assigned literal
+ * @return statement index, OPTIMISER_NO_ENTRY if the literal is not assigned in the block
+ */
+static size_t find_last_value_assignment(optimiser_block_index_t *index, atom_t atom, syntax_abstract_tree_t *value) {
+    syntax_abstract_tree_t **statements = index->block->statements;
+    size_t low = 0;
+    size_t high = index->value_count;
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        syntax_abstract_tree_t *statement = statements[index->values[middle]];
+        int result = compare_assignment_values(statement->left->number.atom, statement->right, atom, value);
+
+        if (result == 0) return index->value_lasts[middle];
+
+        if (result < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return OPTIMISER_NO_ENTRY;
+}
+
+/**
+ * Finds the first while loop no replacement has checked yet
+ * @param index block index
+ * @param position statement index to start from
+ * @return statement index of the loop, number of statements if there is none
+ */
+static size_t find_unchecked_while(optimiser_block_index_t *index, size_t position) {
+    size_t root = position;
+    while (index->next_whiles[root] != root) root = index->next_whiles[root];
+
+    while (index->next_whiles[position] != root) {
+        size_t next = index->next_whiles[position];
+        index->next_whiles[position] = root;
+        position = next;
+    }
+
+    return root;
+}
+
+/**
+ * Finds the mention of the identifier in the statement
+ * @param index block index
+ * @param position statement index
+ * @param atom identifier
+ * @return mention, OPTIMISER_NO_ENTRY if the statement does not mention the identifier
+ */
+static size_t find_statement_entry(optimiser_block_index_t *index, size_t position, atom_t atom) {
+    for (size_t i = index->statement_entries[position]; i < index->statement_entries[position + 1]; i++)
+        if (index->entry_atoms[i] == atom) return i;
+
+    return OPTIMISER_NO_ENTRY;
+}
+
+/**
+ * Replaces the variable in the condition of the while loop and removes the loop if it is never entered
+ * @param tree block of the loop
+ * @param position statement index of the loop
+ */
+static void replace_while_condition(syntax_abstract_tree_t *tree, size_t position) {
+    syntax_abstract_tree_t *current = tree->statements[position];
+    syntax_abstract_tree_t *cond_copy = tree_copy(current->left);
+
+    process_tree_using(cond_copy, replace_variable_usage_internal, POSTORDER);
+    process_tree_using(cond_copy, optimize_expression, POSTORDER);
+    bool is_cond_false = !check_tree_using(cond_copy, is_true);
+    if (is_cond_false) {
+        tree->statements[position] = NULL;
+    } else {
+        optimize_node(current->right, OPTIMISE_UNREACHABLE_CODE);
+    }
+}
+
+/**
+ * Replaces the variable in the condition and the branches of the if statement and optimises the branches
+ * @param current if statement
+ * @param current_tree statement assigning the variable
+ */
+static void replace_if_usage(syntax_abstract_tree_t *current, syntax_abstract_tree_t *current_tree) {
+    process_tree_using(current->left, replace_variable_usage_internal, POSTORDER);
+    if (current->middle) {
+        replace_variable_usage(current->middle, current_tree);
+        syntax_abstract_tree_t *tmp_tree = optimiser_params->root_tree;
+        optimiser_params->root_tree = current->middle;
+        optimize_node(current->middle, OPTIMISE_EXPRESSION);
+        optimiser_params->root_tree = tmp_tree;
+        optimize_node(current->middle, OPTIMISE_UNREACHABLE_CODE);
+    }
+    if (current->right) {
+        if (current->right->type == SYN_NODE_KEYWORD_IF)
             process_tree_using(current->right->left, replace_variable_usage_internal, POSTORDER);
-            if (current->right->middle) {
-                replace_variable_usage(current->right->middle, current_tree);
-                syntax_abstract_tree_t *tmp_tree = optimiser_params->root_tree;
-                optimiser_params->root_tree = current->right->middle;
-                optimize_node(current->right->middle, OPTIMISE_EXPRESSION);
-                optimiser_params->root_tree = tmp_tree;
-                optimize_node(current->right->middle, OPTIMISE_UNREACHABLE_CODE);
-            }
-            if (current->right->right) {
-                if (current->right->right->type == SYN_NODE_KEYWORD_IF)
-                    process_tree_using(current->right->right->left, replace_variable_usage_internal, POSTORDER);
-
-                replace_variable_usage(current->right->right, current_tree);
-                syntax_abstract_tree_t *tmp_tree = optimiser_params->root_tree;
-                optimiser_params->root_tree = current->right->right;
-                optimize_node(current->right->right, OPTIMISE_EXPRESSION);
-                optimiser_params->root_tree = tmp_tree;
-                optimize_node(current->right->middle, OPTIMISE_UNREACHABLE_CODE);
-            }
-            break;
+
+        replace_variable_usage(current->right, current_tree);
+        syntax_abstract_tree_t *tmp_tree = optimiser_params->root_tree;
+        optimiser_params->root_tree = current->right;
+        optimize_node(current->right, OPTIMISE_EXPRESSION);
+        optimiser_params->root_tree = tmp_tree;
+        optimize_node(current->middle, OPTIMISE_UNREACHABLE_CODE);
+    }
+}
+
+/**
+ * Replaces the variable using the block index. Only the statements mentioning the variable and the while loops
+ * not checked yet are visited, in the same order as the statements of the block
+ * @param tree indexed block
+ * @param current_tree statement assigning the variable
+ */
+static void replace_indexed_variable_usage(syntax_abstract_tree_t *tree, syntax_abstract_tree_t *current_tree) {
+    optimiser_block_index_t *index = optimiser_params->block_index;
+    atom_t atom = optimiser_params->current_replaced_variable_atom;
+
+    // replacing starts from the last assignment of the value, or from the assignment itself
+    size_t first = index->current;
+    size_t last = find_last_value_assignment(index, atom, optimiser_params->current_replaced_variable_tree);
+    if (last != OPTIMISER_NO_ENTRY && last > first) first = last;
+
+    // an if statement ends the replacing
+    size_t stop = index->next_ifs[first + 1];
+
+    size_t entry = find_statement_entry(index, first, atom);
+    entry = entry == OPTIMISER_NO_ENTRY ? OPTIMISER_NO_ENTRY : index->entry_next[entry];
+    size_t loop = find_unchecked_while(index, first + 1);
+
+    while (true) {
+        size_t mention = entry == OPTIMISER_NO_ENTRY ? tree->statement_count : index->entry_statements[entry];
+        size_t position = mention < loop ? mention : loop;
+
+        if (position >= stop) break;
+
+        syntax_abstract_tree_t *current = tree->statements[position];
+
+        if (position == mention) entry = index->entry_next[entry];
+
+        if (position == loop) {
+            index->next_whiles[loop] = loop + 1;
+            loop = find_unchecked_while(index, loop + 1);
         }
 
-        if (current->right->type == SYN_NODE_KEYWORD_WHILE) {
-            syntax_abstract_tree_t *cond_copy = tree_copy(current->right->left);
-            process_tree_using(cond_copy, replace_variable_usage_internal, POSTORDER);
-            process_tree_using(cond_copy, optimize_expression, POSTORDER);
-            bool is_cond_false = !check_tree_using(cond_copy, is_true);
-            free_syntax_tree(cond_copy);
-            cond_copy = NULL;
-
-            if (is_cond_false) {
-                free_syntax_tree(current->right);
-                trees[j]->right = NULL;
-            } else {
-                optimize_node(current->right->right, OPTIMISE_UNREACHABLE_CODE);
-            }
+        if (!current || is_replaced_assignment(current))
+            continue;
+
+        if (current->type == SYN_NODE_ASSIGN && current->left->number.atom == atom) {
+            process_tree_using(current->right, replace_variable_usage_internal, POSTORDER);
+            return;
+        }
 
+        if (current->type == SYN_NODE_KEYWORD_WHILE) {
+            replace_while_condition(tree, position);
             continue;
         }
 
-        process_tree_using(current->right, replace_variable_usage_internal, POSTORDER);
+        process_tree_using(current, replace_variable_usage_internal, POSTORDER);
     }
+
+    if (stop < tree->statement_count && tree->statements[stop])
+        replace_if_usage(tree->statements[stop], current_tree);
 }
 
-void remove_unused_variables(syntax_abstract_tree_t *tree) {
-    if (!tree) return;
+/**
+ * Removes the assignment of the unused variable using the block index
+ * @param tree indexed block
+ */
+static void remove_indexed_unused_variable(syntax_abstract_tree_t *tree) {
+    optimiser_block_index_t *index = optimiser_params->block_index;
+    atom_t atom = optimiser_params->current_unused_variable_atom;
 
-    syntax_abstract_tree_t *trees[1000] = {NULL};
+    // last mention of the variable in a statement which has not been removed yet
+    size_t entry = optimiser_params->atom_entries[atom];
+    while (entry != OPTIMISER_NO_ENTRY && !tree->statements[index->entry_statements[entry]])
+        entry = index->entry_previous[entry];
+    optimiser_params->atom_entries[atom] = entry;
 
-    int i = 0;
-    int current_level = -1;
+    if (entry == OPTIMISER_NO_ENTRY) return;
 
-    while (tree && tree->type == SYN_NODE_SEQUENCE) {
-        trees[i++] = tree;
+    size_t position = index->entry_statements[entry];
+    if (is_unused_assignment(tree->statements[position])) tree->statements[position] = NULL;
+}
+
+void replace_variable_usage(syntax_abstract_tree_t *tree, syntax_abstract_tree_t *current_tree) {
+    if (!tree) return;
 
-        bool is_same_tree = compare_syntax_tree(tree->right, optimiser_params->current_unused_variable_tree);
+    optimiser_block_index_t *index = optimiser_params->block_index;
+    if (index && index->block == tree && tree->statements[index->current] == current_tree) {
+        replace_indexed_variable_usage(tree, current_tree);
+        return;
+    }
 
-        if (current_level == -1 && tree->right && tree->right->type == SYN_NODE_ASSIGN &&
-            !strcmp(tree->right->left->value->value, optimiser_params->current_unused_variable_name->value) &&
-            is_same_tree)
-            current_level = i - 1;
-        tree = tree->left;
+    // replacing starts from the last assignment of the value, or from the start of the block
+    size_t first = 0;
+    for (size_t i = tree->statement_count; i > 0; i--) {
+        if (is_replaced_assignment(tree->statements[i - 1])) {
+            first = i - 1;
+            break;
+        }
     }
 
-    bool is_used_in_code = false;
+    for (size_t j = first; j < tree->statement_count; j++) {
+        syntax_abstract_tree_t *current = tree->statements[j];
+
+        if (!current || is_replaced_assignment(current))
+            continue;
 
-    for (int j = current_level; j >= 0; j--) {
-        syntax_abstract_tree_t *current = trees[j];
+        if (current->type == SYN_NODE_ASSIGN) {
+            if (current->left->number.atom == optimiser_params->current_replaced_variable_atom) {
+                process_tree_using(current->right, replace_variable_usage_internal, POSTORDER);
+                break;
+            }
+        }
 
-        bool is_same_tree = compare_syntax_tree(current->right, optimiser_params->current_unused_variable_tree);
+        if (current->type == SYN_NODE_KEYWORD_IF) {
+            replace_if_usage(current, current_tree);
+            break;
+        }
 
-        if (current->right && current->right->type == SYN_NODE_ASSIGN &&
-            !strcmp(current->right->left->value->value, optimiser_params->current_unused_variable_name->value) &&
-            is_same_tree)
+        if (current->type == SYN_NODE_KEYWORD_WHILE) {
+            replace_while_condition(tree, j);
             continue;
+        }
+
+        process_tree_using(current, replace_variable_usage_internal, POSTORDER);
+    }
+}
 
-        if (!is_used_in_code) {
-            bool is_used_in_current = !check_tree_using(current->right, is_unused);
-            is_used_in_code = is_used_in_current;
+void remove_unused_variables(syntax_abstract_tree_t *tree) {
+    if (!tree) return;
 
-            if (is_used_in_current) break;
+    optimiser_block_index_t *index = optimiser_params->block_index;
+    if (index && index->block == tree &&
+        tree->statements[index->current] == optimiser_params->current_unused_variable_tree) {
+        remove_indexed_unused_variable(tree);
+        return;
+    }
+
+    size_t assignment = tree->statement_count;
+    for (size_t i = tree->statement_count; i > 0; i--) {
+        if (is_unused_assignment(tree->statements[i - 1])) {
+            assignment = i - 1;
+            break;
         }
     }
 
-    if (!is_used_in_code) {
-        free_syntax_tree(trees[current_level]->right);
-        trees[current_level]->right = NULL;
+    if (assignment == tree->statement_count) return;
+
+    for (size_t j = assignment; j < tree->statement_count; j++) {
+        syntax_abstract_tree_t *current = tree->statements[j];
+
+        if (is_unused_assignment(current))
+            continue;
+
+        if (!check_tree_using(current, is_unused)) return;
     }
+
+    tree->statements[assignment] = NULL;
 }
 
 void optimize_expression(syntax_abstract_tree_t *tree) {
@@ -291,8 +627,8 @@ void optimize_expression(syntax_abstract_tree_t *tree) {
 
             double result = left_number + right_number;
 
-            PROCESS_DECIMAL(result)
-            REPLACE_TREE_VALUE(result_str, is_float ? SYN_NODE_FLOAT : SYN_NODE_INTEGER)
+            GET_RESULT_TYPE
+            REPLACE_TREE_VALUE(result_type, result)
             break;
         }
         case SYN_NODE_SUB: {
@@ -300,8 +636,8 @@ void optimize_expression(syntax_abstract_tree_t *tree) {
 
             double result = left_number - right_number;
 
-            PROCESS_DECIMAL(result)
-            REPLACE_TREE_VALUE(result_str, is_float ? SYN_NODE_FLOAT : SYN_NODE_INTEGER)
+            GET_RESULT_TYPE
+            REPLACE_TREE_VALUE(result_type, result)
             break;
         }
         case SYN_NODE_MUL: {
@@ -309,8 +645,8 @@ void optimize_expression(syntax_abstract_tree_t *tree) {
 
             double result = left_number * right_number;
 
-            PROCESS_DECIMAL(result)
-            REPLACE_TREE_VALUE(result_str, is_float ? SYN_NODE_FLOAT : SYN_NODE_INTEGER)
+            GET_RESULT_TYPE
+            REPLACE_TREE_VALUE(result_type, result)
             break;
         }
         case SYN_NODE_DIV: {
@@ -318,8 +654,8 @@ void optimize_expression(syntax_abstract_tree_t *tree) {
 
             double result = left_number / right_number;
 
-            PROCESS_DECIMAL(result)
-            REPLACE_TREE_VALUE(result_str, is_float ? SYN_NODE_FLOAT : SYN_NODE_INTEGER)
+            GET_RESULT_TYPE
+            REPLACE_TREE_VALUE(result_type, result)
             break;
         }
         case SYN_NODE_TYPED_EQUAL: {
@@ -327,7 +663,7 @@ void optimize_expression(syntax_abstract_tree_t *tree) {
 
             bool result = left_number == right_number;
 
-            REPLACE_TREE_VALUE(result ? "1" : "0", SYN_NODE_INTEGER)
+            REPLACE_TREE_VALUE(SYN_NODE_INTEGER, result)
             break;
         }
         case SYN_NODE_TYPED_NOT_EQUAL: {
@@ -335,7 +671,7 @@ void optimize_expression(syntax_abstract_tree_t *tree) {
 
             bool result = left_number != right_number;
 
-            REPLACE_TREE_VALUE(result ? "1" : "0", SYN_NODE_INTEGER)
+            REPLACE_TREE_VALUE(SYN_NODE_INTEGER, result)
             break;
         }
         case SYN_NODE_LESS: {
@@ -343,7 +679,7 @@ void optimize_expression(syntax_abstract_tree_t *tree) {
 
             bool result = left_number < right_number;
 
-            REPLACE_TREE_VALUE(result ? "1" : "0", SYN_NODE_INTEGER)
+            REPLACE_TREE_VALUE(SYN_NODE_INTEGER, result)
             break;
         }
         case SYN_NODE_LESS_EQUAL: {
@@ -351,7 +687,7 @@ void optimize_expression(syntax_abstract_tree_t *tree) {
 
             bool result = left_number <= right_number;
 
-            REPLACE_TREE_VALUE(result ? "1" : "0", SYN_NODE_INTEGER)
+            REPLACE_TREE_VALUE(SYN_NODE_INTEGER, result)
             break;
         }
         case SYN_NODE_GREATER: {
@@ -359,7 +695,7 @@ void optimize_expression(syntax_abstract_tree_t *tree) {
 
             bool result = left_number > right_number;
 
-            REPLACE_TREE_VALUE(result ? "1" : "0", SYN_NODE_INTEGER)
+            REPLACE_TREE_VALUE(SYN_NODE_INTEGER, result)
             break;
         }
         case SYN_NODE_GREATER_EQUAL: {
@@ -367,7 +703,7 @@ void optimize_expression(syntax_abstract_tree_t *tree) {
 
             bool result = left_number >= right_number;
 
-            REPLACE_TREE_VALUE(result ? "1" : "0", SYN_NODE_INTEGER)
+            REPLACE_TREE_VALUE(SYN_NODE_INTEGER, result)
             break;
         }
         case SYN_NODE_AND: {
@@ -375,7 +711,7 @@ void optimize_expression(syntax_abstract_tree_t *tree) {
 
             bool result = left_number && right_number;
 
-            REPLACE_TREE_VALUE(result ? "1" : "0", SYN_NODE_INTEGER)
+            REPLACE_TREE_VALUE(SYN_NODE_INTEGER, result)
             break;
         }
         case SYN_NODE_OR: {
@@ -383,7 +719,7 @@ void optimize_expression(syntax_abstract_tree_t *tree) {
 
             bool result = left_number || right_number;
 
-            REPLACE_TREE_VALUE(result ? "1" : "0", SYN_NODE_INTEGER)
+            REPLACE_TREE_VALUE(SYN_NODE_INTEGER, result)
             break;
         }
         case SYN_NODE_NOT: {
@@ -391,7 +727,7 @@ void optimize_expression(syntax_abstract_tree_t *tree) {
 
             bool result = !left_number;
 
-            REPLACE_TREE_VALUE(result ? "1" : "0", SYN_NODE_INTEGER)
+            REPLACE_TREE_VALUE(SYN_NODE_INTEGER, result)
             break;
         }
         default:
@@ -399,48 +735,45 @@ void optimize_expression(syntax_abstract_tree_t *tree) {
     }
 }
 
-void optimize_node(syntax_abstract_tree_t *tree, optimise_type_t optimise_type) {
-    if (!tree) return;
+void optimize_statement(syntax_abstract_tree_t **statement, optimise_type_t optimise_type) {
+    if (!*statement) return;
 
-    optimize_node(tree->left, optimise_type);
-
-    if (!tree->right) return;
-
-    switch (tree->right->type) {
+    switch ((*statement)->type) {
         case SYN_NODE_ASSIGN: {
             if (optimise_type == OPTIMISE_EXPRESSION) {
-                process_tree_using(tree->right, optimize_expression, POSTORDER);
-                if (tree->right->right->type & (SYN_NODE_INTEGER | SYN_NODE_FLOAT)) {
-                    optimiser_params->current_replaced_variable_name = tree->right->left->value;
-                    optimiser_params->current_replaced_variable_tree = tree->right->right;
-                    replace_variable_usage(optimiser_params->root_tree, tree->right);
+                process_tree_using(*statement, optimize_expression, POSTORDER);
+                if ((*statement)->right->type & (SYN_NODE_INTEGER | SYN_NODE_FLOAT)) {
+                    optimiser_params->current_replaced_variable_atom = (*statement)->left->number.atom;
+                    optimiser_params->current_replaced_variable_tree = (*statement)->right;
+                    replace_variable_usage(optimiser_params->root_tree, *statement);
                 }
             }
             if (optimise_type == OPTIMISE_UNUSED_VARIABLES) {
-                optimiser_params->current_unused_variable_name = tree->right->left->value;
-                optimiser_params->current_unused_variable_tree = tree->right;
+                optimiser_params->current_unused_variable_atom = (*statement)->left->number.atom;
+                optimiser_params->current_unused_variable_tree = *statement;
                 remove_unused_variables(optimiser_params->root_tree);
             }
             break;
         }
         case SYN_NODE_KEYWORD_IF: {
             if (optimise_type == OPTIMISE_EXPRESSION) {
-                process_tree_using(tree->right, optimize_expression, POSTORDER);
+                process_tree_using(*statement, optimize_expression, POSTORDER);
             }
             if (optimise_type == OPTIMISE_UNREACHABLE_CODE) {
-                optimise_unreachable_if(tree);
+                optimise_unreachable_if(statement);
             }
         }
         case SYN_NODE_KEYWORD_WHILE: {
             if (optimise_type == OPTIMISE_UNREACHABLE_CODE) {
-                optimise_unreachable_while(tree);
+                optimise_unreachable_while(statement);
             }
         }
         case SYN_NODE_CALL: {
             if (optimise_type == OPTIMISE_EXPRESSION) {
-                process_tree_using(tree->right, optimize_expression, POSTORDER);
-                optimiser_params->current_replaced_variable_name = tree->right->left->value;
-                optimiser_params->current_replaced_variable_tree = tree->right->right;
+                process_tree_using(*statement, optimize_expression, POSTORDER);
+                optimiser_params->current_replaced_variable_atom =
+                        (*statement)->left->type == SYN_NODE_IDENTIFIER ? (*statement)->left->number.atom : ATOM_NONE;
+                optimiser_params->current_replaced_variable_tree = (*statement)->right;
             }
         }
         default:
@@ -448,6 +781,34 @@ void optimize_node(syntax_abstract_tree_t *tree, optimise_type_t optimise_type)
     }
 }
 
+void optimize_node(syntax_abstract_tree_t *tree, optimise_type_t optimise_type) {
+    if (!tree) return;
+
+    if (tree->type != SYN_NODE_SEQUENCE) {
+        // else-if branch is not a block, its else branch is in place of a statement
+        optimize_node(tree->left, optimise_type);
+        optimize_statement(&tree->right, optimise_type);
+        return;
+    }
+
+    if (optimise_type == OPTIMISE_UNREACHABLE_CODE) {
+        for (size_t i = 0; i < tree->statement_count; i++) optimize_statement(&tree->statements[i], optimise_type);
+        return;
+    }
+
+    // last mentions are kept while removing unused variables, an expression may index nested blocks
+    optimiser_block_index_t *index = push_block_index(tree);
+    if (optimise_type == OPTIMISE_EXPRESSION) reset_atom_entries(index);
+
+    for (size_t i = 0; i < tree->statement_count; i++) {
+        index->current = i;
+        optimize_statement(&tree->statements[i], optimise_type);
+    }
+
+    if (optimise_type == OPTIMISE_UNUSED_VARIABLES) reset_atom_entries(index);
+    pop_block_index();
+}
+
 void optimize_tree(syntax_abstract_tree_t *tree) {
     if (!optimiser_params)
         init_optimiser();
@@ -463,10 +824,13 @@ void init_optimiser() {
     optimiser_parameters_t *params = (optimiser_parameters_t *) malloc(sizeof(optimiser_parameters_t));
 
     params->root_tree = NULL;
-    params->current_unused_variable_name = NULL;
+    params->current_unused_variable_atom = ATOM_NONE;
     params->current_replaced_variable_tree = NULL;
-    params->current_replaced_variable_name = NULL;
+    params->current_replaced_variable_atom = ATOM_NONE;
     params->current_replaced_variable_tree = NULL;
+    params->block_index = NULL;
+    params->atom_entries = NULL;
+    params->atom_capacity = 0;
 
     optimiser_params = params;
 }
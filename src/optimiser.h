@@ -11,8 +11,6 @@
 #ifndef IFJ_PROJ_OPTIMISER_H
 #define IFJ_PROJ_OPTIMISER_H
 
-static char *numbers_buffer;
-
 #define GET_NODE_NUMBERS \
     if (!(tree->left->type & (SYN_NODE_STRING | SYN_NODE_INTEGER | SYN_NODE_FLOAT)) || \
         !(tree->right->type & (SYN_NODE_STRING | SYN_NODE_INTEGER | SYN_NODE_FLOAT)))  \
@@ -33,35 +31,122 @@ static char *numbers_buffer;
     if (tree->child->type == SYN_NODE_STRING) { \
         change_node_type(tree->child, TYPE_INT); \
     } \
-    double child##_number = strtod(tree->child->value->value, &numbers_buffer);
-
-#define PROCESS_DECIMAL(result) \
-    int result_int = (int) result;\
-    double decimal = result - result_int; \
-    char *result_str = (char *) malloc(1024); \
-    if (decimal == 0) \
-    sprintf(result_str, "%d", result_int); \
-    else \
-    sprintf(result_str, "%.10f", result); \
-    bool is_float = tree->left->type == SYN_NODE_FLOAT || tree->right->type == SYN_NODE_FLOAT || tree->type == SYN_NODE_DIV;
-
-#define REPLACE_TREE_VALUE(str, t) \
+    double child##_number = get_node_number(tree->child);
+
+#define GET_RESULT_TYPE \
+    syntax_tree_node_type result_type = \
+            tree->left->type == SYN_NODE_FLOAT || tree->right->type == SYN_NODE_FLOAT || tree->type == SYN_NODE_DIV \
+            ? SYN_NODE_FLOAT : SYN_NODE_INTEGER;
+
+// text is formatted from the stored number, so both describe the same value
+#define REPLACE_TREE_VALUE(t, number_value) \
     tree->type = t; \
-    tree->value = string_init(str); \
-    free_syntax_tree(tree->left); \
-    free_syntax_tree(tree->right); \
+    tree->value = string_base_init(); \
+    if (t == SYN_NODE_FLOAT) { \
+        tree->number.floating = (double) (number_value); \
+        string_append_format(tree->value, "%.17g", tree->number.floating); \
+    } else { \
+        tree->number.integer = (int) (number_value); \
+        string_append_int(tree->value, (int) tree->number.integer); \
+    } \
     tree->left = NULL; \
     tree->right = NULL;
 
+#define OPTIMISER_NO_ENTRY ((size_t) -1)
+
 #include "syntax_analyzer.h"
 #include "semantic_analyzer.h"
 
+/**
+ * @struct optimiser_block_index_t
+ * Identifiers mentioned by the statements of a block. Replacing or removing a variable visits only the statements
+ * mentioning it instead of rescanning the rest of the block
+ *
+ * @var optimiser_block_index_t::block
+ * Indexed SYN_NODE_SEQUENCE node
+ *
+ * @var optimiser_block_index_t::current
+ * Index of the statement being optimised
+ *
+ * @var optimiser_block_index_t::entry_atoms
+ * Identifier of each mention, mentions are ordered by their statements
+ *
+ * @var optimiser_block_index_t::entry_statements
+ * Statement index of each mention
+ *
+ * @var optimiser_block_index_t::entry_next
+ * Next mention of the same identifier, OPTIMISER_NO_ENTRY for the last one
+ *
+ * @var optimiser_block_index_t::entry_previous
+ * Previous mention of the same identifier, OPTIMISER_NO_ENTRY for the first one
+ *
+ * @var optimiser_block_index_t::entry_count
+ * Number of mentions
+ *
+ * @var optimiser_block_index_t::entry_capacity
+ * Number of mentions the arrays can hold
+ *
+ * @var optimiser_block_index_t::statement_entries
+ * First mention of each statement, the extra last item is the number of mentions
+ *
+ * @var optimiser_block_index_t::next_ifs
+ * Index of the first if statement at or after each statement
+ *
+ * @var optimiser_block_index_t::next_whiles
+ * Links leading to the next while statement no replacement has visited yet
+ *
+ * @var optimiser_block_index_t::values
+ * Statements assigning a number literal, ordered by variable, value and position
+ *
+ * @var optimiser_block_index_t::value_lasts
+ * Last statement assigning the same value to the same variable for each item of values
+ *
+ * @var optimiser_block_index_t::value_count
+ * Number of statements assigning a number literal
+ *
+ * @var optimiser_block_index_t::parent
+ * Index of the block optimised around this one
+ */
+typedef struct optimiser_block_index {
+    syntax_abstract_tree_t *block;
+    size_t current;
+    atom_t *entry_atoms;
+    size_t *entry_statements;
+    size_t *entry_next;
+    size_t *entry_previous;
+    size_t entry_count;
+    size_t entry_capacity;
+    size_t *statement_entries;
+    size_t *next_ifs;
+    size_t *next_whiles;
+    size_t *values;
+    size_t *value_lasts;
+    size_t value_count;
+    struct optimiser_block_index *parent;
+} optimiser_block_index_t;
+
+/**
+ * @struct optimiser_parameters_t
+ * State of the optimiser shared by the tree callbacks
+ *
+ * @var optimiser_parameters_t::block_index
+ * Index of the innermost block being optimised, NULL outside of blocks
+ *
+ * @var optimiser_parameters_t::atom_entries
+ * Last mention of each identifier, OPTIMISER_NO_ENTRY unless an index is being built or variables are removed
+ *
+ * @var optimiser_parameters_t::atom_capacity
+ * Number of identifiers atom_entries can hold
+ */
 typedef struct optimiser_parameters {
     syntax_abstract_tree_t *root_tree;
-    string_t *current_unused_variable_name;
+    atom_t current_unused_variable_atom;
     syntax_abstract_tree_t *current_unused_variable_tree;
-    string_t *current_replaced_variable_name;
+    atom_t current_replaced_variable_atom;
     syntax_abstract_tree_t *current_replaced_variable_tree;
+    optimiser_block_index_t *block_index;
+    size_t *atom_entries;
+    size_t atom_capacity;
 } optimiser_parameters_t;
 
 typedef enum {
@@ -88,15 +173,15 @@ bool is_true(syntax_abstract_tree_t *tree);
 
 /**
  * Optimises unreachable while loop
- * @param tree abstract syntax tree
+ * @param statement pointer to the statement in its block, it is set to NULL when the loop is removed
  */
-void optimise_unreachable_while(syntax_abstract_tree_t *tree);
+void optimise_unreachable_while(syntax_abstract_tree_t **statement);
 
 /**
  * Optimises unreachable if statement
- * @param tree abstract syntax tree
+ * @param statement pointer to the statement in its block, it is replaced with the reachable branch
  */
-void optimise_unreachable_if(syntax_abstract_tree_t *tree);
+void optimise_unreachable_if(syntax_abstract_tree_t **statement);
 
 /**
  * Internal function of variables replacement
@@ -118,7 +203,14 @@ void replace_variable_usage(syntax_abstract_tree_t *tree, syntax_abstract_tree_t
 void optimize_expression(syntax_abstract_tree_t *tree);
 
 /**
- * Optimize SYN_NODE_SEQUENCE node
+ * Optimize statement of a block
+ * @param statement pointer to the statement in its block
+ * @param optimise_type type of optimisation
+ */
+void optimize_statement(syntax_abstract_tree_t **statement, optimise_type_t optimise_type);
+
+/**
+ * Optimize statements of SYN_NODE_SEQUENCE node
  * @param tree node to optimize
  * @param optimise_type type of optimisation
  */
@@ -0,0 +1,208 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22.
+ * @authors
+ *   xmoise01, Nikita Moiseev
+ *
+ * @file output_buffer.c
+ * @brief Chunked output buffer
+ * @date 17.10.2026
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "output_buffer.h"
+#include "errors.h"
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+/**
+ * Allocates new empty chunk and appends it to the buffer
+ * @param buffer pointer to the buffer
+ * @return pointer to the chunk
+ */
+static output_chunk_t *output_buffer_add_chunk(output_buffer_t *buffer) {
+    output_chunk_t *chunk = (output_chunk_t *) malloc(sizeof(output_chunk_t));
+    if (chunk == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for output chunk");
+    }
+
+    chunk->next = NULL;
+    chunk->length = 0;
+
+    if (buffer->tail == NULL)
+        buffer->head = chunk;
+    else
+        buffer->tail->next = chunk;
+
+    buffer->tail = chunk;
+    return chunk;
+}
+
+/**
+ * Writes all bytes of the iovec array, continuing after partial writes
+ * @param fd file descriptor
+ * @param iov iovec array, modified in place
+ * @param count number of iovec items
+ * @return 0 on success, -1 if write failed
+ */
+static int output_buffer_writev(int fd, struct iovec *iov, int count) {
+    while (count > 0) {
+        ssize_t written = writev(fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+
+        while (count > 0 && (size_t) written >= iov->iov_len) {
+            written -= (ssize_t) iov->iov_len;
+            iov++;
+            count--;
+        }
+
+        if (count > 0) {
+            iov->iov_base = (char *) iov->iov_base + written;
+            iov->iov_len -= (size_t) written;
+        }
+    }
+
+    return 0;
+}
+
+output_buffer_t *output_buffer_init(FILE *file) {
+    output_buffer_t *buffer = (output_buffer_t *) malloc(sizeof(output_buffer_t));
+    if (buffer == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for output buffer");
+    }
+
+    buffer->file = file;
+    buffer->head = NULL;
+    buffer->tail = NULL;
+    buffer->length = 0;
+    buffer->threshold = OUTPUT_FLUSH_THRESHOLD;
+    return buffer;
+}
+
+void output_buffer_append(output_buffer_t *buffer, const char *data, size_t length) {
+    output_chunk_t *chunk = buffer->tail;
+
+    while (length > 0) {
+        if (chunk == NULL || chunk->length == OUTPUT_CHUNK_SIZE)
+            chunk = output_buffer_add_chunk(buffer);
+
+        size_t size = OUTPUT_CHUNK_SIZE - chunk->length;
+        if (size > length)
+            size = length;
+
+        memcpy(chunk->data + chunk->length, data, size);
+        chunk->length += size;
+        buffer->length += size;
+        data += size;
+        length -= size;
+    }
+
+    if (buffer->length >= buffer->threshold)
+        output_buffer_flush(buffer);
+}
+
+void output_buffer_append_char(output_buffer_t *buffer, char c) {
+    output_chunk_t *chunk = buffer->tail;
+
+    if (chunk != NULL && chunk->length < OUTPUT_CHUNK_SIZE && buffer->length + 1 < buffer->threshold) {
+        chunk->data[chunk->length++] = c;
+        buffer->length++;
+        return;
+    }
+
+    output_buffer_append(buffer, &c, 1);
+}
+
+void output_buffer_append_cstr(output_buffer_t *buffer, const char *str) {
+    output_buffer_append(buffer, str, strlen(str));
+}
+
+void output_buffer_append_int(output_buffer_t *buffer, long long value) {
+    char digits[24];
+    char *end = digits + sizeof(digits);
+    char *start = end;
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long) value : (unsigned long long) value;
+
+    do {
+        *--start = (char) ('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    if (value < 0)
+        *--start = '-';
+
+    output_buffer_append(buffer, start, end - start);
+}
+
+void output_buffer_flush(output_buffer_t *buffer) {
+    if (buffer->length == 0) return;
+
+    fflush(buffer->file);
+    int fd = fileno(buffer->file);
+
+    struct iovec iov[IOV_MAX];
+    int count = 0;
+
+    for (output_chunk_t *chunk = buffer->head; chunk != NULL; chunk = chunk->next) {
+        if (chunk->length == 0) continue;
+
+        if (fd < 0) {
+            if (fwrite(chunk->data, 1, chunk->length, buffer->file) != chunk->length) {
+                INTERNAL_ERROR("Failed to write output");
+            }
+            continue;
+        }
+
+        iov[count].iov_base = chunk->data;
+        iov[count].iov_len = chunk->length;
+        count++;
+
+        if (count == IOV_MAX) {
+            if (output_buffer_writev(fd, iov, count) != 0) {
+                INTERNAL_ERROR("Failed to write output");
+            }
+            count = 0;
+        }
+    }
+
+    if (count > 0 && output_buffer_writev(fd, iov, count) != 0) {
+        INTERNAL_ERROR("Failed to write output");
+    }
+
+    output_chunk_t *chunk = buffer->head->next;
+    while (chunk != NULL) {
+        output_chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    buffer->head->next = NULL;
+    buffer->head->length = 0;
+    buffer->tail = buffer->head;
+    buffer->length = 0;
+}
+
+void output_buffer_free(output_buffer_t *buffer) {
+    if (buffer == NULL) return;
+
+    output_chunk_t *chunk = buffer->head;
+    while (chunk != NULL) {
+        output_chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    free(buffer);
+}
@@ -0,0 +1,116 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22.
+ * @authors
+ *   xmoise01, Nikita Moiseev
+ *
+ * @file output_buffer.h
+ * @brief Chunked output buffer
+ * @date 17.10.2026
+ */
+
+#ifndef IFJ_PROJ_OUTPUT_BUFFER_H
+#define IFJ_PROJ_OUTPUT_BUFFER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define OUTPUT_CHUNK_SIZE (64 * 1024)
+#define OUTPUT_FLUSH_THRESHOLD (4 * 1024 * 1024)
+
+#define OUTPUT_BUFFER_APPEND_LITERAL(buffer, literal) output_buffer_append(buffer, literal, sizeof(literal) - 1)
+
+/**
+ * @struct output_chunk_t
+ * Fixed size block of buffered output
+ *
+ * @var output_chunk_t::next
+ * Next chunk in output order
+ *
+ * @var output_chunk_t::length
+ * Number of bytes written to the chunk
+ *
+ * @var output_chunk_t::data
+ * Chunk bytes
+ */
+typedef struct output_chunk {
+    struct output_chunk *next;
+    size_t length;
+    char data[OUTPUT_CHUNK_SIZE];
+} output_chunk_t;
+
+/**
+ * @struct output_buffer_t
+ * Append-only list of chunks, written to the file by a few large writes
+ *
+ * @var output_buffer_t::file
+ * File the buffer is flushed to
+ *
+ * @var output_buffer_t::head
+ * First chunk
+ *
+ * @var output_buffer_t::tail
+ * Chunk the buffer currently appends to
+ *
+ * @var output_buffer_t::length
+ * Number of buffered bytes
+ *
+ * @var output_buffer_t::threshold
+ * Number of buffered bytes which triggers flush
+ */
+typedef struct output_buffer {
+    FILE *file;
+    output_chunk_t *head;
+    output_chunk_t *tail;
+    size_t length;
+    size_t threshold;
+} output_buffer_t;
+
+/**
+ * Initializes empty output buffer
+ * @param file file the buffer is flushed to
+ * @return pointer to the buffer
+ */
+output_buffer_t *output_buffer_init(FILE *file);
+
+/**
+ * Appends bytes to the buffer. The buffer is flushed when it reaches its threshold
+ * @param buffer pointer to the buffer
+ * @param data bytes to append
+ * @param length number of bytes
+ */
+void output_buffer_append(output_buffer_t *buffer, const char *data, size_t length);
+
+/**
+ * Appends character to the buffer
+ * @param buffer pointer to the buffer
+ * @param c character to append
+ */
+void output_buffer_append_char(output_buffer_t *buffer, char c);
+
+/**
+ * Appends null-terminated string to the buffer
+ * @param buffer pointer to the buffer
+ * @param str string to append
+ */
+void output_buffer_append_cstr(output_buffer_t *buffer, const char *str);
+
+/**
+ * Appends decimal representation of integer to the buffer
+ * @param buffer pointer to the buffer
+ * @param value integer to append
+ */
+void output_buffer_append_int(output_buffer_t *buffer, long long value);
+
+/**
+ * Writes all buffered bytes to the file
+ * @param buffer pointer to the buffer
+ */
+void output_buffer_flush(output_buffer_t *buffer);
+
+/**
+ * Frees buffer with all its chunks. Buffered bytes are not written
+ * @param buffer pointer to the buffer
+ */
+void output_buffer_free(output_buffer_t *buffer);
+
+#endif //IFJ_PROJ_OUTPUT_BUFFER_H
@@ -20,8 +20,7 @@ extern tree_node_t *symtable;
 void semantic_tree_check_internal(syntax_abstract_tree_t *tree) {
     if (!tree) return;
 
-    semantic_tree_check_internal(tree->left);
-    process_tree(tree->right);
+    for (size_t i = 0; i < tree->statement_count; i++) process_tree(tree->statements[i]);
 }
 
 void semantic_tree_check(syntax_abstract_tree_t *tree) {
@@ -58,8 +57,7 @@ void process_tree(syntax_abstract_tree_t *tree) {
         return;
     switch (tree->type) {
         case SYN_NODE_SEQUENCE:
-            process_tree(tree->left);
-            process_tree(tree->right);
+            for (size_t i = 0; i < tree->statement_count; i++) process_tree(tree->statements[i]);
             break;
         case SYN_NODE_ASSIGN: {
             process_assign(tree);
@@ -107,7 +105,7 @@ void process_assign(syntax_abstract_tree_t *tree) {
         create_local_token(id_node, semantic_state->function_name);
         semantic_state_ptr();
     }
-    find_element(semantic_state->symtable_ptr, id_node->value->value)->type = get_data_type(tree->right);
+    find_atom(semantic_state->symtable_ptr, id_node->number.atom)->type = get_data_type(tree->right);
     check_tree_for_float(tree->right);
 }
 
@@ -185,24 +183,31 @@ void check_for_return_value(syntax_abstract_tree_t *tree) {
     data_type needed_return_type = find_token(semantic_state->function_name)->type;
     bool func_has_return_type = needed_return_type != TYPE_ALL;
 
-    if (tree == NULL) {
+    // last statement of a block, else-if branches have their else branch in its place
+    syntax_abstract_tree_t *last = NULL;
+    if (tree != NULL && tree->type != SYN_NODE_SEQUENCE)
+        last = tree->right;
+    else if (tree != NULL && tree->statement_count != 0)
+        last = tree->statements[tree->statement_count - 1];
+
+    if (last == NULL) {
         if (func_has_return_type && needed_return_type != TYPE_VOID) {
             SEMANTIC_FUNC_ARG_ERROR("Function has no return")
         }
         return;
     }
 
-    if (tree->right->type == SYN_NODE_KEYWORD_IF) {
-        check_for_return_value(tree->right->middle);
-        check_for_return_value(tree->right->right);
+    if (last->type == SYN_NODE_KEYWORD_IF) {
+        check_for_return_value(last->middle);
+        check_for_return_value(last->right);
         return;
     }
 
-    bool has_return = tree->right->type == SYN_NODE_KEYWORD_RETURN;
-    bool type_match = needed_return_type & get_data_type(tree->right->right);
+    bool has_return = last->type == SYN_NODE_KEYWORD_RETURN;
+    bool type_match = needed_return_type & get_data_type(last->right);
 
     if (has_return && !func_has_return_type) {
-        data_type type_from_return_expression = get_data_type(tree->right->right);
+        data_type type_from_return_expression = get_data_type(last->right);
         find_token(semantic_state->function_name)->type = type_from_return_expression;
     }
 
@@ -213,7 +218,7 @@ void check_for_return_value(syntax_abstract_tree_t *tree) {
     }
 
     if (has_return) {
-        data_type type_from_return_expression = get_data_type(tree->right->right);
+        data_type type_from_return_expression = get_data_type(last->right);
         if (!type_match) {
             if (needed_return_type == TYPE_VOID || type_from_return_expression == TYPE_VOID) {
                 SEMANTIC_FUNC_RET_ERROR("Redundant return in function %s", semantic_state->function_name)
@@ -232,39 +237,56 @@ void process_call(syntax_abstract_tree_t *tree) {
     int arg_call_counter = count_arguments(tree->right);
 
 
-    if (!strcmp(tree->left->value->value, "readi"))
-        semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
-                                                                        SEMANTIC_READI);
-    else if (!strcmp(tree->left->value->value, "readf"))
-        semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
-                                                                        SEMANTIC_READF);
-    else if (!strcmp(tree->left->value->value, "reads"))
-        semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
-                                                                        SEMANTIC_READS);
-    else if (!strcmp(tree->left->value->value, "write"))
-        semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
-                                                                        SEMANTIC_WRITE);
-    else if (!strcmp(tree->left->value->value, "strlen"))
-        semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
-                                                                        SEMANTIC_STRLEN);
-    else if (!strcmp(tree->left->value->value, "ord"))
-        semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions | SEMANTIC_ORD);
-    else if (!strcmp(tree->left->value->value, "chr"))
-        semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions | SEMANTIC_CHR);
-    else if (!strcmp(tree->left->value->value, "substring"))
-        semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
-                                                                        SEMANTIC_SUBSTRING);
-    else if (!strcmp(tree->left->value->value, "intval"))
-        semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
-                                                                        SEMANTIC_INTVAL);
-    else if (!strcmp(tree->left->value->value, "floatval"))
-        semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
-                                                                        SEMANTIC_FLOATVAL);
-    else if (!strcmp(tree->left->value->value, "strval"))
-        semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
-                                                                        SEMANTIC_STRVAL);
-
-    if (strcmp(semantic_state->function_name, "write") != 0) {
+    switch (tree->left->number.atom) {
+        case ATOM_READI:
+            semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
+                                                                            SEMANTIC_READI);
+            break;
+        case ATOM_READF:
+            semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
+                                                                            SEMANTIC_READF);
+            break;
+        case ATOM_READS:
+            semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
+                                                                            SEMANTIC_READS);
+            break;
+        case ATOM_WRITE:
+            semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
+                                                                            SEMANTIC_WRITE);
+            break;
+        case ATOM_STRLEN:
+            semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
+                                                                            SEMANTIC_STRLEN);
+            break;
+        case ATOM_ORD:
+            semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
+                                                                            SEMANTIC_ORD);
+            break;
+        case ATOM_CHR:
+            semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
+                                                                            SEMANTIC_CHR);
+            break;
+        case ATOM_SUBSTRING:
+            semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
+                                                                            SEMANTIC_SUBSTRING);
+            break;
+        case ATOM_INTVAL:
+            semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
+                                                                            SEMANTIC_INTVAL);
+            break;
+        case ATOM_FLOATVAL:
+            semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
+                                                                            SEMANTIC_FLOATVAL);
+            break;
+        case ATOM_STRVAL:
+            semantic_state->used_functions = (semantic_internal_functions) (semantic_state->used_functions |
+                                                                            SEMANTIC_STRVAL);
+            break;
+        default:
+            break;
+    }
+
+    if (tree->left->number.atom != ATOM_WRITE) {
         if (arg_call_counter != func->argument_count) {
             SEMANTIC_FUNC_ARG_ERROR("Wrong number of arguments")
         }
@@ -313,7 +335,7 @@ bool check_defined(syntax_abstract_tree_t *tree) {
 bool is_defined(syntax_abstract_tree_t *tree) {
     if (tree->type == SYN_NODE_IDENTIFIER) {
         bool is_var = tree->value->value[0] == '$';
-        tree_node_t *node = find_element(is_var ? semantic_state->symtable_ptr : symtable, tree->value->value);
+        tree_node_t *node = find_atom(is_var ? semantic_state->symtable_ptr : symtable, tree->number.atom);
         if (!node) return false;
 
         return node->defined == true;
@@ -339,7 +361,7 @@ data_type get_data_type(syntax_abstract_tree_t *tree) {
         }
         case SYN_NODE_IDENTIFIER:
             check_tree_using(tree, check_defined);
-            return find_element(semantic_state->symtable_ptr, tree->value->value)->type;
+            return find_atom(semantic_state->symtable_ptr, tree->number.atom)->type;
         case SYN_NODE_INTEGER:
             return TYPE_INT;
         case SYN_NODE_FLOAT:
@@ -413,40 +435,38 @@ void change_node_type(syntax_abstract_tree_t *tree, data_type type) {
 
             if (tree->type & SYN_NODE_FLOAT) {
                 tree->type = SYN_NODE_INTEGER;
-                double num = strtod(tree->value->value, &num_buf);
+                tree->number.integer = (int) tree->number.floating;
                 string_clear(tree->value);
-                string_append_string(tree->value, "%d", (int) num);
+                string_append_int(tree->value, (int) tree->number.integer);
             }
             if (tree->type & SYN_NODE_STRING) {
                 tree->type = SYN_NODE_INTEGER;
-                string_t *string_without_quotes = string_substr(tree->value, 1, (int) tree->value->length - 1);
-                double num = strtod(string_without_quotes->value, &num_buf);
+                double num = strtod(tree->value->value, &num_buf);
+                tree->number.integer = (int) num;
                 string_clear(tree->value);
-                string_append_string(tree->value, "%d", (int) num);
+                string_append_int(tree->value, (int) num);
             }
             break;
         }
         case TYPE_FLOAT: {
             if (tree->type & SYN_NODE_INTEGER) {
                 tree->type = SYN_NODE_FLOAT;
-                string_append_string(tree->value, ".0");
+                tree->number.floating = (double) tree->number.integer;
+                STRING_APPEND_LITERAL(tree->value, ".0");
             }
             if (tree->type & SYN_NODE_STRING) {
                 tree->type = SYN_NODE_FLOAT;
                 char *num_buf;
-                string_t *string_without_quotes = string_substr(tree->value, 1, (int) tree->value->length - 1);
-                double num = strtod(string_without_quotes->value, &num_buf);
+                double num = strtod(tree->value->value, &num_buf);
+                tree->number.floating = num;
                 string_clear(tree->value);
-                string_append_string(tree->value, "%g", num);
+                string_append_format(tree->value, "%g", num);
             }
             break;
         }
         case TYPE_STRING: {
             if (tree->type & (SYN_NODE_INTEGER | SYN_NODE_FLOAT)) {
                 tree->type = SYN_NODE_STRING;
-                string_t *value_copy = string_init(tree->value->value);
-                string_clear(tree->value);
-                string_append_string(tree->value, "\"%s\"", value_copy->value);
             }
             break;
         }
@@ -467,7 +487,7 @@ bool is_node_an_int(syntax_abstract_tree_t *tree) {
             return false;
         case SYN_NODE_IDENTIFIER: {
             bool is_var = tree->value->value[0] == '$';
-            if (find_element(is_var ? semantic_state->symtable_ptr : symtable, tree->value->value)->type ==
+            if (find_atom(is_var ? semantic_state->symtable_ptr : symtable, tree->number.atom)->type ==
                 TYPE_FLOAT) {
                 return false;
             }
@@ -481,7 +501,7 @@ bool is_node_an_int(syntax_abstract_tree_t *tree) {
 bool is_only_numbers(syntax_abstract_tree_t *tree) {
     if (tree->type == SYN_NODE_STRING ||
         (tree->type == SYN_NODE_IDENTIFIER &&
-         find_element(semantic_state->symtable_ptr, tree->value->value)->type == TYPE_STRING)) {
+         find_atom(semantic_state->symtable_ptr, tree->number.atom)->type == TYPE_STRING)) {
         return false;
     }
     return true;
@@ -498,13 +518,12 @@ void insert_arguments(syntax_abstract_tree_t *tree) {
                 SEMANTIC_UNDEF_VAR_ERROR("Function %s used before declaration", semantic_state->function_name)
             }
             create_local_token(tree->left, semantic_state->function_name);
-            char *arg_value = tree->left->value->value;
             tree_node_t *arg_node = find_token(semantic_state->function_name)->function_tree;
-            tree_node_t *arg = find_element(arg_node, arg_value);
+            tree_node_t *arg = find_atom(arg_node, tree->left->number.atom);
             arg->type =
-                    tree->left->attrs->token_type == SYN_TOKEN_KEYWORD_INT ? TYPE_INT :
-                    tree->left->attrs->token_type == SYN_TOKEN_KEYWORD_FLOAT ? TYPE_FLOAT :
-                    tree->left->attrs->token_type == SYN_TOKEN_KEYWORD_STRING ? TYPE_STRING : TYPE_ALL;
+                    tree->left->attrs.token_type == SYN_TOKEN_KEYWORD_INT ? TYPE_INT :
+                    tree->left->attrs.token_type == SYN_TOKEN_KEYWORD_FLOAT ? TYPE_FLOAT :
+                    tree->left->attrs.token_type == SYN_TOKEN_KEYWORD_STRING ? TYPE_STRING : TYPE_ALL;
             find_token(semantic_state->function_name)->argument_count = semantic_state->argument_count;
             arg->argument_type = arg->type;
             find_token(semantic_state->function_name)->argument_type = (data_type) (arg->type |
@@ -534,7 +553,7 @@ void set_return_type(syntax_abstract_tree_t *tree) {
     if (tree == NULL) {
         return;
     }
-    switch (tree->attrs->token_type) {
+    switch (tree->attrs.token_type) {
         case SYN_TOKEN_KEYWORD_INT:
             find_token(semantic_state->function_name)->type = TYPE_INT;
             break;
@@ -10,37 +10,85 @@
 
 #include "str.h"
 #include "errors.h"
+#include "arena.h"
 #include <stdio.h>
-#include <stdarg.h>
 
-string_t *string_base_init() {
-    string_t *string = (string_t *) malloc(sizeof(string_t));
-    if (string == NULL) {
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Reallocates string value to hold exactly capacity characters. Values short enough are moved to the inline buffer
+ * @param str pointer to a string
+ * @param capacity new capacity
+ */
+static void string_realloc(string_t *str, size_t capacity) {
+    if (capacity < STRING_INLINE_CAPACITY) {
+        if (!STRING_IS_INLINE(str)) {
+            memcpy(str->inline_value, str->value, str->length + 1);
+            compilation_free(str->value);
+            str->value = str->inline_value;
+        }
+
+        str->capacity = STRING_INLINE_CAPACITY - 1;
+        return;
+    }
+
+    char *new_value;
+    if (STRING_IS_INLINE(str)) {
+        new_value = (char *) compilation_malloc(capacity + 1);
+        if (new_value != NULL)
+            memcpy(new_value, str->inline_value, str->length + 1);
+    } else {
+        new_value = (char *) compilation_realloc(str->value, str->capacity + 1, capacity + 1);
+    }
+
+    if (new_value == NULL) {
         INTERNAL_ERROR("Failed to allocate memory for string");
     }
 
-    string->value = (char *) malloc(STRING_ALLOCATION_SIZE);
-    if (string->value == NULL) {
+    str->value = new_value;
+    str->capacity = capacity;
+}
+
+/**
+ * Grows string capacity geometrically, so it can hold at least required characters
+ * @param str pointer to a string
+ * @param required required capacity
+ */
+static void string_grow(string_t *str, size_t required) {
+    if (required <= str->capacity) return;
+
+    size_t new_capacity = str->capacity * STRING_GROWTH_FACTOR;
+    if (new_capacity < required)
+        new_capacity = required;
+
+    string_realloc(str, new_capacity);
+}
+
+string_t *string_base_init() {
+    string_t *string = (string_t *) compilation_malloc(sizeof(string_t));
+    if (string == NULL) {
         INTERNAL_ERROR("Failed to allocate memory for string");
     }
 
+    string->value = string->inline_value;
     string->length = 0;
+    string->capacity = STRING_INLINE_CAPACITY - 1;
     string->value[0] = '\0';
-    string->capacity = STRING_ALLOCATION_SIZE;
     return string;
 }
 
 string_t *string_init(const char *value) {
     string_t *string = string_base_init();
+    size_t length = strlen(value);
 
-    string->value = (char *) malloc(sizeof(char) * strlen(value) + 4);
-    if (!string->value) {
-        INTERNAL_ERROR("Failed to allocate memory for string");
-    }
+    string_reserve(string, length);
 
-    strcpy(string->value, value);
-    string->length = strlen(value);
-    string->capacity = strlen(value);
+    memcpy(string->value, value, length + 1);
+    string->length = length;
 
     return string;
 }
@@ -49,58 +97,74 @@ void string_append_char(string_t *str, char c) {
     if (str == NULL)
         return;
 
-    if (str->length + 1 >= str->capacity) {
-        size_t new_capacity = str->capacity + STRING_ALLOCATION_SIZE;
-        char *new_value = (char *) malloc(new_capacity + 4);
-        if (new_value == NULL) {
-            INTERNAL_ERROR("Failed to allocate memory for string");
-        }
-
-        memcpy(new_value, str->value, str->length);
-        free(str->value);
-        str->value = new_value;
-        str->capacity = new_capacity;
-    }
+    if (str->length == str->capacity)
+        string_grow(str, str->length + 1);
 
     str->value[str->length++] = c;
     str->value[str->length] = '\0';
 }
 
 void string_append_string(string_t *str, const char *value, ...) {
+    va_list args;
+    va_start(args, value);
+    string_append_vformat(str, value, args);
+    va_end(args);
+}
+
+void string_append_chars(string_t *str, const char *value, size_t length) {
     if (str == NULL || value == NULL)
         return;
 
-    va_list args;
-    va_start(args, value);
+    string_grow(str, str->length + length);
 
-    char *extra_value = (char *) malloc(sizeof(char) * strlen(value) + 4);
+    memcpy(str->value + str->length, value, length);
+    str->length += length;
+    str->value[str->length] = '\0';
+}
 
-    vsprintf(extra_value, value, args);
+void string_append_int(string_t *str, long long value) {
+    char buffer[24];
+    char *digits = buffer + sizeof(buffer);
+    unsigned long long number = value < 0 ? -(unsigned long long) value : (unsigned long long) value;
 
-    va_end(args);
+    do {
+        *--digits = (char) ('0' + number % 10);
+        number /= 10;
+    } while (number);
 
-    size_t new_length = strlen(extra_value);
+    if (value < 0)
+        *--digits = '-';
 
-    if (str->length + new_length >= str->capacity) {
-        size_t new_capacity = str->capacity + new_length;
-        char *new_value = (char *) malloc(new_capacity + 4);
-        if (new_value == NULL) {
-            INTERNAL_ERROR("Failed to allocate memory for string");
-        }
+    string_append_chars(str, digits, buffer + sizeof(buffer) - digits);
+}
 
-        strncpy(new_value, str->value, str->length);
-        new_value[str->length] = '\0';
+void string_append_format(string_t *str, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    string_append_vformat(str, format, args);
+    va_end(args);
+}
+
+void string_append_vformat(string_t *str, const char *format, va_list args) {
+    if (str == NULL || format == NULL)
+        return;
 
-        free(str->value);
-        str->value = new_value;
-        str->capacity = new_capacity;
+    va_list args_copy;
+    va_copy(args_copy, args);
+
+    size_t available = str->capacity - str->length;
+    int formatted_length = vsnprintf(str->value + str->length, available + 1, format, args);
+    if (formatted_length < 0) {
+        INTERNAL_ERROR("Failed to format string");
     }
 
-    strncat(str->value, extra_value, new_length);
-    str->length += new_length;
-    str->value[str->length] = '\0';
+    if ((size_t) formatted_length > available) {
+        string_grow(str, str->length + formatted_length);
+        vsnprintf(str->value + str->length, formatted_length + 1, format, args_copy);
+    }
 
-    free(extra_value);
+    va_end(args_copy);
+    str->length += formatted_length;
 }
 
 void string_clear(string_t *str) {
@@ -116,36 +180,22 @@ void string_replace(string_t *str, char *value) {
 
     size_t new_length = strlen(value);
 
-    if (new_length >= str->capacity) {
-        size_t new_capacity = new_length;
-        char *new_value = (char *) malloc(new_capacity + 4);
-        if (new_value == NULL) {
-            INTERNAL_ERROR("Failed to allocate memory for string");
-        }
+    string_grow(str, new_length);
 
-        free(str->value);
-        str->value = new_value;
-        str->capacity = new_capacity;
-    }
-
-    memcpy(str->value, value, new_length);
+    memmove(str->value, value, new_length);
     str->length = new_length;
     str->value[str->length] = '\0';
 }
 
 string_t *string_substr(string_t *str, int start, int end) {
-    if (str == NULL)
+    if (start < 0 || end < 0)
         return NULL;
 
-    if (start < 0 || end < 0 || start > end || end > str->length)
+    string_view_t slice = string_slice(str, start, end);
+    if (slice.ptr == NULL)
         return NULL;
 
-    string_t *substr = string_base_init();
-
-    for (int i = start; i < end; i++)
-        string_append_char(substr, str->value[i]);
-
-    return substr;
+    return string_init_view(slice);
 }
 
 bool string_check_by(string_t *str, int (*func)(int)) {
@@ -166,9 +216,185 @@ void string_convert_by(string_t *str, int (*func)(int)) {
     }
 }
 
+#define IS_ASCII_DIGIT(c) ((unsigned char) ((c) - '0') < 10)
+#define IS_ASCII_UPPER(c) ((unsigned char) ((c) - 'A') < 26)
+#define IS_ASCII_ALPHA(c) ((unsigned char) (((c) | 0x20) - 'a') < 26)
+#define IS_IDENTIFIER_CHAR(c) (IS_ASCII_ALPHA(c) || IS_ASCII_DIGIT(c) || (c) == '_')
+
+#if defined(__AVX2__)
+#define STRING_VECTOR_SIZE 32
+#define VECTOR_T __m256i
+#define VECTOR_LOAD(ptr) _mm256_loadu_si256((const __m256i *) (ptr))
+#define VECTOR_STORE(ptr, v) _mm256_storeu_si256((__m256i *) (ptr), v)
+#define VECTOR_SET(c) _mm256_set1_epi8((char) (c))
+#define VECTOR_GT(a, b) _mm256_cmpgt_epi8(a, b)
+#define VECTOR_EQ(a, b) _mm256_cmpeq_epi8(a, b)
+#define VECTOR_AND(a, b) _mm256_and_si256(a, b)
+#define VECTOR_OR(a, b) _mm256_or_si256(a, b)
+#define VECTOR_ADD(a, b) _mm256_add_epi8(a, b)
+#define VECTOR_ALL(v) (_mm256_movemask_epi8(v) == -1)
+#elif defined(__SSE2__) || defined(_M_X64)
+#define STRING_VECTOR_SIZE 16
+#define VECTOR_T __m128i
+#define VECTOR_LOAD(ptr) _mm_loadu_si128((const __m128i *) (ptr))
+#define VECTOR_STORE(ptr, v) _mm_storeu_si128((__m128i *) (ptr), v)
+#define VECTOR_SET(c) _mm_set1_epi8((char) (c))
+#define VECTOR_GT(a, b) _mm_cmpgt_epi8(a, b)
+#define VECTOR_EQ(a, b) _mm_cmpeq_epi8(a, b)
+#define VECTOR_AND(a, b) _mm_and_si128(a, b)
+#define VECTOR_OR(a, b) _mm_or_si128(a, b)
+#define VECTOR_ADD(a, b) _mm_add_epi8(a, b)
+#define VECTOR_ALL(v) (_mm_movemask_epi8(v) == 0xFFFF)
+#endif
+
+#ifdef STRING_VECTOR_SIZE
+/**
+ * Compares every byte of vector with an inclusive range. Bytes above 0x7F never match
+ * @param v vector of characters
+ * @param low lowest character of the range
+ * @param high highest character of the range
+ * @return mask with 0xFF in bytes which are in the range
+ */
+#define VECTOR_IN_RANGE(v, low, high) VECTOR_AND(VECTOR_GT(v, VECTOR_SET((low) - 1)), VECTOR_GT(VECTOR_SET((high) + 1), v))
+#endif
+
+void string_chars_to_lower(char *data, size_t length) {
+    size_t i = 0;
+
+#ifdef STRING_VECTOR_SIZE
+    const VECTOR_T case_bit = VECTOR_SET(0x20);
+
+    for (; i + STRING_VECTOR_SIZE <= length; i += STRING_VECTOR_SIZE) {
+        VECTOR_T chars = VECTOR_LOAD(data + i);
+        VECTOR_T upper = VECTOR_IN_RANGE(chars, 'A', 'Z');
+        VECTOR_STORE(data + i, VECTOR_ADD(chars, VECTOR_AND(upper, case_bit)));
+    }
+#endif
+
+    for (; i < length; i++) {
+        if (IS_ASCII_UPPER(data[i])) data[i] = (char) (data[i] | 0x20);
+    }
+}
+
+size_t string_span_digits(const char *data, size_t length) {
+    size_t i = 0;
+
+#ifdef STRING_VECTOR_SIZE
+    for (; i + STRING_VECTOR_SIZE <= length; i += STRING_VECTOR_SIZE) {
+        VECTOR_T chars = VECTOR_LOAD(data + i);
+        if (!VECTOR_ALL(VECTOR_IN_RANGE(chars, '0', '9'))) break;
+    }
+#endif
+
+    while (i < length && IS_ASCII_DIGIT(data[i])) i++;
+
+    return i;
+}
+
+size_t string_span_identifier(const char *data, size_t length) {
+    size_t i = 0;
+
+#ifdef STRING_VECTOR_SIZE
+    const VECTOR_T case_bit = VECTOR_SET(0x20);
+    const VECTOR_T underscore = VECTOR_SET('_');
+
+    for (; i + STRING_VECTOR_SIZE <= length; i += STRING_VECTOR_SIZE) {
+        VECTOR_T chars = VECTOR_LOAD(data + i);
+        VECTOR_T alpha = VECTOR_IN_RANGE(VECTOR_OR(chars, case_bit), 'a', 'z');
+        VECTOR_T digit = VECTOR_IN_RANGE(chars, '0', '9');
+        VECTOR_T valid = VECTOR_OR(VECTOR_OR(alpha, digit), VECTOR_EQ(chars, underscore));
+        if (!VECTOR_ALL(valid)) break;
+    }
+#endif
+
+    while (i < length && IS_IDENTIFIER_CHAR(data[i])) i++;
+
+    return i;
+}
+
+void string_to_lower(string_t *str) {
+    if (str == NULL) return;
+
+    string_chars_to_lower(str->value, str->length);
+}
+
+bool string_is_digits(string_t *str) {
+    if (str == NULL) return false;
+
+    return string_span_digits(str->value, str->length) == str->length;
+}
+
+bool string_is_identifier(string_t *str) {
+    if (str == NULL) return false;
+
+    return string_span_identifier(str->value, str->length) == str->length;
+}
+
+void string_reserve(string_t *str, size_t capacity) {
+    if (str == NULL || capacity <= str->capacity) return;
+
+    string_realloc(str, capacity);
+}
+
+void string_shrink_to_fit(string_t *str) {
+    if (str == NULL || str->length == str->capacity || STRING_IS_INLINE(str)) return;
+
+    string_realloc(str, str->length);
+}
+
+string_t *string_init_view(string_view_t view) {
+    string_t *string = string_base_init();
+    string_append_chars(string, view.ptr, view.len);
+    return string;
+}
+
+string_view_t string_view_from_cstr(const char *value) {
+    string_view_t view = {value, value ? strlen(value) : 0};
+    return view;
+}
+
+string_view_t string_view_from_string(const string_t *str) {
+    string_view_t view = {str->value, str->length};
+    return view;
+}
+
+string_view_t string_slice(const string_t *str, size_t start, size_t end) {
+    string_view_t view = {NULL, 0};
+
+    if (str == NULL || start > end || end > str->length)
+        return view;
+
+    view.ptr = str->value + start;
+    view.len = end - start;
+    return view;
+}
+
+int string_view_compare(string_view_t a, string_view_t b) {
+    int result = memcmp(a.ptr, b.ptr, a.len < b.len ? a.len : b.len);
+    if (result != 0) return result;
+
+    return a.len < b.len ? -1 : a.len > b.len;
+}
+
+bool string_view_equals(string_view_t a, string_view_t b) {
+    return a.len == b.len && memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+unsigned int string_view_hash(string_view_t view) {
+    unsigned int hash = 2166136261u;
+
+    for (size_t i = 0; i < view.len; i++) {
+        hash ^= (unsigned char) view.ptr[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
 void string_free(string_t *str) {
     if (str == NULL) return;
 
-    free(str->value);
-    free(str);
+    if (!STRING_IS_INLINE(str))
+        compilation_free(str->value);
+    compilation_free(str);
 }
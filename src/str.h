@@ -14,8 +14,10 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdarg.h>
 
-#define STRING_ALLOCATION_SIZE sizeof(char)
+#define STRING_INLINE_CAPACITY 24
+#define STRING_GROWTH_FACTOR 2
 
 /**
  * @struct string_t
@@ -28,14 +30,35 @@
  * String length
  *
  * @var string_t::capacity
- * String capacity
+ * Number of characters the string can hold without reallocation (terminating null character excluded)
+ *
+ * @var string_t::inline_value
+ * Inline buffer used as string value while it is short enough, so short strings need no extra allocation
  */
 typedef struct string {
     char *value;
     size_t length;
     size_t capacity;
+    char inline_value[STRING_INLINE_CAPACITY];
 } string_t;
 
+#define STRING_IS_INLINE(str) ((str)->value == (str)->inline_value)
+
+/**
+ * @struct string_view_t
+ * Non-owning view of characters, which are not necessarily null-terminated
+ *
+ * @var string_view_t::ptr
+ * Pointer to the first character
+ *
+ * @var string_view_t::len
+ * Number of characters
+ */
+typedef struct string_view {
+    const char *ptr;
+    size_t len;
+} string_view_t;
+
 /**
  * Initializes string
  * @return pointer to string
@@ -63,6 +86,38 @@ void string_append_char(string_t *str, char c);
  */
 void string_append_string(string_t *str, const char *value, ...);
 
+/**
+ * Appends length characters to string
+ * @param str pointer to string
+ * @param value characters to append
+ * @param length number of characters
+ */
+void string_append_chars(string_t *str, const char *value, size_t length);
+
+/**
+ * Appends decimal representation of an integer to string
+ * @param str pointer to string
+ * @param value integer value
+ */
+void string_append_int(string_t *str, long long value);
+
+/**
+ * Appends formatted string to string
+ * @param str pointer to string
+ * @param format printf format
+ */
+void string_append_format(string_t *str, const char *format, ...);
+
+/**
+ * Appends formatted string to string
+ * @param str pointer to string
+ * @param format printf format
+ * @param args format arguments
+ */
+void string_append_vformat(string_t *str, const char *format, va_list args);
+
+#define STRING_APPEND_LITERAL(str, literal) string_append_chars(str, literal, sizeof(literal) - 1)
+
 /**
  * Clears string
  * @param str pointer to string
@@ -100,6 +155,119 @@ bool string_check_by(string_t *str, int (*func)(int));
  */
 void string_convert_by(string_t *str, int (*func)(int));
 
+/**
+ * Converts ASCII uppercase letters to lowercase
+ * @param data pointer to characters
+ * @param length number of characters
+ */
+void string_chars_to_lower(char *data, size_t length);
+
+/**
+ * Counts leading ASCII digits
+ * @param data pointer to characters
+ * @param length number of characters
+ * @return index of the first character which is not a digit, length if there is no such character
+ */
+size_t string_span_digits(const char *data, size_t length);
+
+/**
+ * Counts leading identifier characters (ASCII letters, digits and underscore)
+ * @param data pointer to characters
+ * @param length number of characters
+ * @return index of the first character which is not an identifier character, length if there is no such character
+ */
+size_t string_span_identifier(const char *data, size_t length);
+
+/**
+ * Converts ASCII uppercase letters in string to lowercase
+ * @param str pointer to a string
+ */
+void string_to_lower(string_t *str);
+
+/**
+ * Checks if string consists of ASCII digits only
+ * @param str pointer to a string
+ * @return true if every character is a digit, false otherwise
+ */
+bool string_is_digits(string_t *str);
+
+/**
+ * Checks if string consists of identifier characters only
+ * @param str pointer to a string
+ * @return true if every character is a letter, digit or underscore, false otherwise
+ */
+bool string_is_identifier(string_t *str);
+
+/**
+ * Makes sure the string can hold at least capacity characters without reallocation
+ * @param str pointer to a string
+ * @param capacity requested capacity
+ */
+void string_reserve(string_t *str, size_t capacity);
+
+/**
+ * Releases the memory which is not used by string value
+ * @param str pointer to a string
+ */
+void string_shrink_to_fit(string_t *str);
+
+/**
+ * Initializes string with value of a view
+ * @param view string view
+ * @return pointer to string
+ */
+string_t *string_init_view(string_view_t view);
+
+/**
+ * Creates view of a null-terminated string
+ * @param value string value
+ * @return string view
+ */
+string_view_t string_view_from_cstr(const char *value);
+
+/**
+ * Creates view of a string value
+ * @param str pointer to a string
+ * @return string view
+ */
+string_view_t string_view_from_string(const string_t *str);
+
+/**
+ * Creates view of a part of string value without copying it
+ * @param str pointer to a string
+ * @param start start index
+ * @param end end index
+ * @return string view, empty view with NULL pointer if indexes are out of range
+ */
+string_view_t string_slice(const string_t *str, size_t start, size_t end);
+
+/**
+ * Compares two views like strcmp
+ * @param a first view
+ * @param b second view
+ * @return negative value if a is smaller, 0 if views are equal, positive value if a is greater
+ */
+int string_view_compare(string_view_t a, string_view_t b);
+
+/**
+ * Checks if two views contain the same characters
+ * @param a first view
+ * @param b second view
+ * @return true if views are equal, false otherwise
+ */
+bool string_view_equals(string_view_t a, string_view_t b);
+
+/**
+ * Computes FNV-1a hash of view characters
+ * @param view string view
+ * @return hash value
+ */
+unsigned int string_view_hash(string_view_t view);
+
+/**
+ * Frees string
+ * @param str pointer to a string
+ */
 void string_free(string_t *str);
 
 #endif //IFJ_PROJ_STRING_H
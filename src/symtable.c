@@ -13,6 +13,7 @@
 #include "symtable.h"
 #include "syntax_analyzer.h"
 #include "semantic_analyzer.h"
+#include "arena.h"
 
 
 tree_node_t *symtable;
@@ -38,7 +39,7 @@ tree_node_t *init_tree() {
     insert_return_type(readf_func_name, (data_type) (TYPE_FLOAT | TYPE_NULL));
     find_token(readf_func_name)->argument_count = 0;
 
-    data_type *type_array = (data_type *) malloc(sizeof(data_type) * 4);
+    data_type *type_array = (data_type *) compilation_malloc(sizeof(data_type) * 4);
 
     char *write_func_name = "write";
     type_array[0] = TYPE_ALL;
@@ -127,7 +128,7 @@ void insert_return_type(char *key, data_type type) {
 
 void insert_args(char *key, int arg_count, data_type *type_array) {
     tree_node_t *function_ptr = find_element(symtable, key);
-    data_type *args = (data_type *) malloc(sizeof(data_type) * arg_count);
+    data_type *args = (data_type *) compilation_malloc(sizeof(data_type) * arg_count);
     find_element(symtable, key)->args_array = args;
     data_type *arg_ptr = find_element(symtable, function_ptr->key)->args_array;
     for (int i = 0; i < arg_count; i++) {
@@ -135,14 +136,16 @@ void insert_args(char *key, int arg_count, data_type *type_array) {
     }
 }
 
-tree_node_t *create_node(char *key) {
-    tree_node_t *result = (tree_node_t *) malloc(sizeof(tree_node_t));
+tree_node_t *create_node(atom_t atom) {
+    tree_node_t *result = (tree_node_t *) compilation_malloc(sizeof(tree_node_t));
     if (result == 0) {
         INTERNAL_ERROR("Malloc for BST failed");
     }
     result->left = NULL;
     result->right = NULL;
-    result->key = key;
+    result->key = (char *) atom_name(atom);
+    result->key_length = strlen(result->key);
+    result->atom = atom;
     result->defined = false;
     result->code_generator_defined = false;
     result->global = false;
@@ -156,76 +159,94 @@ tree_node_t *create_node(char *key) {
     return result;
 }
 
-int comparator(tree_node_t *root, char *key) {
-    if (strcmp(root->key, key) == 0) {
-        return 0;
-    }
-    if (strcmp(root->key, key) > 0) {
-        return -1;
+int comparator(tree_node_t *root, atom_t atom) {
+    // atoms are dense and mostly interned in insertion order, scrambling them keeps the tree balanced
+    uint32_t root_order = root->atom * 2654435761U;
+    uint32_t order = atom * 2654435761U;
+
+    return root_order == order ? 0 : root_order > order ? -1 : 1;
+}
+
+bool insert_atom(tree_node_t **rootptr, atom_t atom) {
+    while (*rootptr != NULL) {
+        switch (comparator(*rootptr, atom)) {
+            case 0:
+                return false;
+            case -1:
+                rootptr = &(*rootptr)->left;
+                break;
+            default:
+                rootptr = &(*rootptr)->right;
+                break;
+        }
     }
-    return 1;
 
+    (*rootptr) = create_node(atom);
+    return true;
 }
 
 bool insert_element(tree_node_t **rootptr, char *key) {
-    tree_node_t *root = *rootptr;
-    if (root == NULL) {
-        //tree empty
-        (*rootptr) = create_node(key);
-        return true;
-    }
-    switch (comparator(root, key)) {
-        case 0:
-            return false;
-        case -1:
-            return insert_element(&(root->left), key);
-        case 1:
-            return insert_element(&(root->right), key);
-    }
+    return insert_atom(rootptr, atom_intern(key, strlen(key)));
 }
 
 bool insert_token(char *key) {
     return insert_element(&symtable, key);
 }
 
-tree_node_t *find_element(tree_node_t *root, char *key) {
-    if (root == NULL) {
-        return NULL;
-    }
-    switch (comparator(root, key)) {
-        case 0:
-            return root;
-        case -1:
-            return find_element(root->left, key);
-        case 1:
-            return find_element(root->right, key);
+tree_node_t *find_atom(tree_node_t *root, atom_t atom) {
+    while (root != NULL) {
+        switch (comparator(root, atom)) {
+            case 0:
+                return root;
+            case -1:
+                root = root->left;
+                break;
+            default:
+                root = root->right;
+                break;
+        }
     }
+
+    return NULL;
+}
+
+tree_node_t *find_element(tree_node_t *root, char *key) {
+    atom_t atom = atom_find(key, strlen(key));
+    if (atom == ATOM_NONE) return NULL;
+
+    return find_atom(root, atom);
 }
 
 tree_node_t *find_token(char *key) {
     return find_element(symtable, key);
 }
 
-bool delete_element(tree_node_t **rootptr, char *key) {
+/**
+ * Deletes node by the atom of its key
+ * @param rootptr pointer to the pointer to the root of the tree
+ * @param atom atom of the key
+ * @return true if key was deleted, false otherwise
+ */
+static bool delete_atom(tree_node_t **rootptr, atom_t atom) {
     tree_node_t *root = *rootptr;
     if (root == NULL) {
         return false;
     }
-    switch (comparator(root, key)) {
+    switch (comparator(root, atom)) {
         case 0: {
             if (root->left == NULL && root->right == NULL) {
-                free(root);
+                compilation_free(root);
                 (*rootptr) = NULL;
                 return true;
             }
             if (root->left == NULL) {
                 (*rootptr) = root->right;
-                free(root);
+                compilation_free(root);
                 return true;
             }
             if (root->right == NULL) {
                 (*rootptr) = root->left;
-                free(root);
+                compilation_free(root);
                 return true;
             }
             tree_node_t *temp = root->right;
@@ -233,17 +254,26 @@ bool delete_element(tree_node_t **rootptr, char *key) {
                 temp = temp->left;
             }
             root->key = temp->key;
-            return delete_element(&(root->right), key);
+            root->key_length = temp->key_length;
+            root->atom = temp->atom;
+            return delete_atom(&(root->right), atom);
         }
         case -1: {
-            return delete_element(&(root->left), key);
+            return delete_atom(&(root->left), atom);
         }
         case 1: {
-            return delete_element(&(root->right), key);
+            return delete_atom(&(root->right), atom);
         }
     }
 }
 
+bool delete_element(tree_node_t **rootptr, char *key) {
+    atom_t atom = atom_find(key, strlen(key));
+    if (atom == ATOM_NONE) return false;
+
+    return delete_atom(rootptr, atom);
+}
+
 bool delete_token(char *key) {
     return delete_element(&symtable, key);
 }
@@ -253,7 +283,7 @@ void dispose_tree(tree_node_t **root) {
 
     dispose_tree(&((*root)->left));
     dispose_tree(&((*root)->right));
-    free(*root);
+    compilation_free(*root);
     *root = NULL;
 }
 
@@ -297,16 +327,16 @@ void print_symtable() {
 }
 
 void create_global_token(syntax_abstract_tree_t *tree) {
-    insert_token(tree->value->value);
-    find_token(tree->value->value)->defined = true;
-    find_token(tree->value->value)->global = true;
+    insert_atom(&symtable, tree->number.atom);
+    tree_node_t *token = find_atom(symtable, tree->number.atom);
+    token->defined = true;
+    token->global = true;
 }
 
 void create_local_token(syntax_abstract_tree_t *tree, char *function_name) {
     tree_node_t *local_sym_table = find_token(function_name)->function_tree;
-    char *key = tree->value->value;
-    insert_element(&local_sym_table, key);
-    tree_node_t *local_token = find_element(local_sym_table, key);
+    insert_atom(&local_sym_table, tree->number.atom);
+    tree_node_t *local_token = find_atom(local_sym_table, tree->number.atom);
     local_token->local = true;
     local_token->defined = true;
     find_token(function_name)->function_tree = local_sym_table;
@@ -14,6 +14,8 @@
 #define IFJ_PROJ_2022_SYMTABLE_H
 
 #include "errors.h"
+#include "str.h"
+#include "atom_table.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -56,6 +58,12 @@ typedef enum {
  *
  * @bool tree_node_t::global
  * Is variable global
+ *
+ * @var tree_node_t::key_length
+ * Length of the key
+ *
+ * @var tree_node_t::atom
+ * Atom of the key, nodes are ordered by it
  */
 typedef struct tree_node {
     struct tree_node *function_tree;
@@ -71,6 +79,8 @@ typedef struct tree_node {
     char *key;
     struct tree_node *left;
     struct tree_node *right;
+    size_t key_length;
+    atom_t atom;
 } tree_node_t;
 
 /**
@@ -109,18 +119,34 @@ void insert_args(char *key, int arg_count, data_type *type_array);
 
 /**
  * Creates tree node with key
- * @param pointer to the token
+ * @param atom atom of the key
  * @return pointer to the tree node
  */
-tree_node_t *create_node(char *key);
+tree_node_t *create_node(atom_t atom);
 
 /**
- * Compare token value with key in the node
+ * Compare atom with key in the node. Atoms are compared scrambled, so keys interned in order keep the tree balanced
  * @param root pointer to the node
- * @param pointer to the token, which value is compared with key
+ * @param atom atom which is compared with key
  * @return 0 if values are equal, -1 if value in the node is greater, 1 if value in the node is smaller
  */
-int comparator(tree_node_t *root, char *key);
+int comparator(tree_node_t *root, atom_t atom);
+
+/**
+ * Inserts atom into the tree
+ * @param rootptr pointer to the pointer to the root of the tree
+ * @param atom atom of the key
+ * @return true if key was inserted, false if key already exists in the tree
+ */
+bool insert_atom(tree_node_t **rootptr, atom_t atom);
+
+/**
+ * Finds atom in the tree
+ * @param root pointer to the root of the tree
+ * @param atom atom of the key
+ * @return pointer to the node if key was found, NULL otherwise
+ */
+tree_node_t *find_atom(tree_node_t *root, atom_t atom);
 
 /**
  * Inserts value into the tree
@@ -11,7 +11,12 @@
 
 #include "syntax_analyzer.h"
 #include "symtable.h"
+#include "arena.h"
 #include "semantic_analyzer.h"
+#include <string.h>
+
+// nodes of the calling thread, all trees are released at once by dispose_syntax_trees
+static __thread arena_t *syntax_tree_arena = NULL;
 
 struct {
     char *text, *enum_text;
@@ -63,47 +68,76 @@ struct {
         {"?>",       "PHPClose",           SYN_TOKEN_PHP_CLOSE,            false, false, false, -1, (syntax_tree_node_type) -1},
 };
 
-syntax_abstract_tree_t *
-make_binary_node(syntax_tree_node_type type, syntax_abstract_tree_t *left, syntax_abstract_tree_t *right) {
-    syntax_abstract_tree_t *tree = (syntax_abstract_tree_t *) malloc(sizeof(syntax_abstract_tree_t));
+void syntax_context_init(syntax_context_t *context, lexical_source_t *source, lexical_stream_t *stream) {
+    context->source = source;
+    context->stream = stream;
+    context->token.type = END_OF_FILE;
+    context->token.offset = source->position;
+    context->token.length = 0;
+    context->token.number.integer = 0;
+}
+
+void get_next_syntax_token(syntax_context_t *context) {
+    if (context->stream != NULL)
+        lexical_stream_next(context->stream, &context->token);
+    else
+        get_next_span(context->source, &context->token);
+}
+
+/**
+ * Allocates a syntax tree node from the node arena of the calling thread
+ * @return pointer to the uninitialized node
+ */
+static syntax_abstract_tree_t *alloc_syntax_tree_node() {
+    if (syntax_tree_arena == NULL) syntax_tree_arena = arena_init();
+
+    syntax_abstract_tree_t *tree = (syntax_abstract_tree_t *) arena_alloc(syntax_tree_arena,
+                                                                          sizeof(syntax_abstract_tree_t));
     if (tree == NULL) {
         INTERNAL_ERROR("Failed to allocate memory for syntax tree node")
     }
 
-    syntax_abstract_tree_attr_t *attrs = (syntax_abstract_tree_attr_t *) malloc(sizeof(syntax_abstract_tree_attr_t));
-    if (attrs == NULL) {
-        INTERNAL_ERROR("Failed to allocate memory for syntax tree node attributes")
-    }
+    return tree;
+}
+
+syntax_abstract_tree_t *
+make_ternary_node(syntax_tree_node_type type, syntax_abstract_tree_t *left, syntax_abstract_tree_t *middle,
+                  syntax_abstract_tree_t *right) {
+    syntax_abstract_tree_t *tree = alloc_syntax_tree_node();
 
     tree->type = type;
     tree->value = NULL;
     tree->left = left;
-    tree->middle = NULL;
+    tree->middle = middle;
     tree->right = right;
-    tree->attrs = attrs;
+    tree->statements = NULL;
+    tree->statement_count = 0;
+    tree->attrs.token_type = SYN_TOKEN_EOF;
+    tree->number.integer = 0;
 
     return tree;
 }
 
 syntax_abstract_tree_t *
-make_ternary_node(syntax_tree_node_type type, syntax_abstract_tree_t *left, syntax_abstract_tree_t *middle,
-                  syntax_abstract_tree_t *right) {
-    syntax_abstract_tree_t *tree = (syntax_abstract_tree_t *) malloc(sizeof(syntax_abstract_tree_t));
-    if (tree == NULL) {
-        INTERNAL_ERROR("Failed to allocate memory for syntax tree node")
+make_binary_node(syntax_tree_node_type type, syntax_abstract_tree_t *left, syntax_abstract_tree_t *right) {
+    return make_ternary_node(type, left, NULL, right);
+}
+
+syntax_abstract_tree_t *make_block_node(syntax_abstract_tree_t **statements, size_t count) {
+    if (count > UINT32_MAX) {
+        INTERNAL_ERROR("Too many statements in a block")
     }
 
-    syntax_abstract_tree_attr_t *attrs = (syntax_abstract_tree_attr_t *) malloc(sizeof(syntax_abstract_tree_attr_t));
-    if (attrs == NULL) {
-        INTERNAL_ERROR("Failed to allocate memory for syntax tree node attributes")
+    syntax_abstract_tree_t *tree = make_binary_node(SYN_NODE_SEQUENCE, NULL, NULL);
+    if (count == 0) return tree;
+
+    tree->statements = (syntax_abstract_tree_t **) arena_alloc(syntax_tree_arena, count * sizeof(*statements));
+    if (tree->statements == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for syntax tree block")
     }
 
-    tree->type = type;
-    tree->value = NULL;
-    tree->left = left;
-    tree->middle = middle;
-    tree->right = right;
-    tree->attrs = attrs;
+    memcpy(tree->statements, statements, count * sizeof(*statements));
+    tree->statement_count = (uint32_t) count;
 
     return tree;
 }
@@ -112,6 +146,16 @@ syntax_abstract_tree_t *make_binary_leaf(syntax_tree_node_type type, string_t *v
     syntax_abstract_tree_t *tree = make_binary_node(type, NULL, NULL);
 
     tree->value = value;
+    if (type == SYN_NODE_IDENTIFIER && value != NULL) tree->number.atom = atom_intern(value->value, value->length);
+
+    return tree;
+}
+
+syntax_abstract_tree_t *make_identifier_leaf(string_t *value, atom_t atom) {
+    syntax_abstract_tree_t *tree = make_binary_node(SYN_NODE_IDENTIFIER, NULL, NULL);
+
+    tree->value = value;
+    tree->number.atom = atom;
 
     return tree;
 }
@@ -127,6 +171,14 @@ syntax_abstract_tree_t *make_ternary_leaf(syntax_tree_node_type type, string_t *
 void syntax_abstract_tree_print(FILE *output, syntax_abstract_tree_t *tree) {
     if (!tree) return;
 
+    if (tree->type == SYN_NODE_SEQUENCE && tree->statement_count != 0) {
+        for (size_t i = 0; i < tree->statement_count; i++) {
+            fprintf(output, "%d ", tree->type);
+            syntax_abstract_tree_print(output, tree->statements[i]);
+        }
+        return;
+    }
+
     syntax_abstract_tree_print(output, tree->left);
     fprintf(output, "%d ", tree->type);
     syntax_abstract_tree_print(output, tree->middle);
@@ -148,19 +200,19 @@ bool is_correct_if(syntax_abstract_tree_t *tree) {
     return true;
 }
 
-void expect_token(const char *msg, syntax_tree_token_type type) {
-    if (get_token_type(lexical_token->type) != type) {
+void expect_token(syntax_context_t *context, const char *msg, syntax_tree_token_type type) {
+    if (get_token_type(context->token.type) != type) {
         SYNTAX_ERROR("%s Expecting %s, found: %s\n", msg, attributes[type].text,
-                     attributes[get_token_type(lexical_token->type)].text)
+                     attributes[get_token_type(context->token.type)].text)
     }
 }
 
-syntax_abstract_tree_t *f_args(FILE *fd, syntax_abstract_tree_t *args) {
-    syntax_tree_token_type type = get_token_type(lexical_token->type);
+syntax_abstract_tree_t *f_args(syntax_context_t *context, syntax_abstract_tree_t *args) {
+    syntax_tree_token_type type = get_token_type(context->token.type);
     if (type == SYN_TOKEN_LEFT_PARENTHESIS) {
-        GET_NEXT_TOKEN(fd)
-        if (get_token_type(lexical_token->type) == SYN_TOKEN_RIGHT_PARENTHESIS) {
-            GET_NEXT_TOKEN(fd)
+        GET_NEXT_TOKEN(context)
+        if (get_token_type(context->token.type) == SYN_TOKEN_RIGHT_PARENTHESIS) {
+            GET_NEXT_TOKEN(context)
             return args;
         }
     }
@@ -168,23 +220,25 @@ syntax_abstract_tree_t *f_args(FILE *fd, syntax_abstract_tree_t *args) {
     if (args == NULL)
         args = make_binary_node(SYN_NODE_FUNCTION_ARG, NULL, NULL);
 
-    args->left = make_binary_leaf(SYN_NODE_IDENTIFIER, string_init(""));
+    args->left = make_identifier_leaf(NULL, ATOM_NONE);
 
-    type = get_token_type(lexical_token->type);
+    type = get_token_type(context->token.type);
     switch (type) {
         case SYN_TOKEN_KEYWORD_VOID:
         case SYN_TOKEN_KEYWORD_INT:
         case SYN_TOKEN_KEYWORD_FLOAT:
         case SYN_TOKEN_KEYWORD_STRING: {
-            args->left->attrs->token_type = type;
-            GET_NEXT_TOKEN(fd)
-            expect_token("Function argument declaration", SYN_TOKEN_IDENTIFIER);
-            args->left->value = string_init(lexical_token->value);
+            args->left->attrs.token_type = type;
+            GET_NEXT_TOKEN(context)
+            expect_token(context, "Function argument declaration", SYN_TOKEN_IDENTIFIER);
+            args->left->value = TOKEN_VALUE(context);
+            args->left->number.atom = context->token.number.atom;
             break;
         }
         case SYN_TOKEN_IDENTIFIER: {
-            args->left->value = string_init(lexical_token->value);
-            args->left->attrs->token_type = SYN_TOKEN_KEYWORD_VOID;
+            args->left->value = TOKEN_VALUE(context);
+            args->left->number.atom = context->token.number.atom;
+            args->left->attrs.token_type = SYN_TOKEN_KEYWORD_VOID;
             break;
         }
         default: {
@@ -192,216 +246,252 @@ syntax_abstract_tree_t *f_args(FILE *fd, syntax_abstract_tree_t *args) {
         }
     }
 
-    GET_NEXT_TOKEN(fd)
-    type = get_token_type(lexical_token->type);
+    GET_NEXT_TOKEN(context)
+    type = get_token_type(context->token.type);
 
     if (type == SYN_TOKEN_RIGHT_PARENTHESIS || type == SYN_TOKEN_COMMA) {
-        GET_NEXT_TOKEN(fd)
+        GET_NEXT_TOKEN(context)
         if (type == SYN_TOKEN_RIGHT_PARENTHESIS)
             return args;
     } else {
         SYNTAX_ERROR("Expecting ',' or ')', found: %s\n", attributes[type].text)
     }
 
-    args->right = f_args(fd, args->right);
+    args->right = f_args(context, args->right);
     return args;
 }
 
-syntax_abstract_tree_t *f_dec_stats(FILE *fd) {
+syntax_abstract_tree_t *f_dec_stats(syntax_context_t *context) {
     syntax_abstract_tree_t *func;
 
-    expect_token("Function", SYN_TOKEN_KEYWORD_FUNCTION);
-    GET_NEXT_TOKEN(fd)
-    expect_token("Identifier", SYN_TOKEN_IDENTIFIER);
+    expect_token(context, "Function", SYN_TOKEN_KEYWORD_FUNCTION);
+    GET_NEXT_TOKEN(context)
+    expect_token(context, "Identifier", SYN_TOKEN_IDENTIFIER);
     func = make_binary_node(SYN_NODE_FUNCTION_DECLARATION,
-                            make_binary_leaf(SYN_NODE_IDENTIFIER, string_init(lexical_token->value)),
+                            TOKEN_IDENTIFIER(context),
                             NULL);
-    GET_NEXT_TOKEN(fd)
-    expect_token("Left parenthesis", SYN_TOKEN_LEFT_PARENTHESIS);
+    GET_NEXT_TOKEN(context)
+    expect_token(context, "Left parenthesis", SYN_TOKEN_LEFT_PARENTHESIS);
     // TODO: Add checking arguments unique IDs
-    func->middle = f_args(fd, NULL);
+    func->middle = f_args(context, NULL);
 
-    if (get_token_type(lexical_token->type) == SYN_TOKEN_COLON) {
-        GET_NEXT_TOKEN(fd)
-        syntax_tree_token_type type = get_token_type(lexical_token->type);
+    if (get_token_type(context->token.type) == SYN_TOKEN_COLON) {
+        GET_NEXT_TOKEN(context)
+        syntax_tree_token_type type = get_token_type(context->token.type);
         if (type != SYN_TOKEN_KEYWORD_VOID && type != SYN_TOKEN_KEYWORD_INT &&
             type != SYN_TOKEN_KEYWORD_FLOAT && type != SYN_TOKEN_KEYWORD_STRING) {
             SYNTAX_ERROR("Expecting function return type, found: %s\n", attributes[type].text)
         }
-        func->attrs->token_type = type;
-        GET_NEXT_TOKEN(fd)
+        func->attrs.token_type = type;
+        GET_NEXT_TOKEN(context)
     } else {
-        func->attrs->token_type = SYN_TOKEN_EOF;
+        func->attrs.token_type = SYN_TOKEN_EOF;
     }
 
-    expect_token("Left curly brackets", SYN_TOKEN_LEFT_CURLY_BRACKETS);
+    expect_token(context, "Left curly brackets", SYN_TOKEN_LEFT_CURLY_BRACKETS);
 
-    func->right = stmt(fd);
+    func->right = stmt(context);
 
     return func;
 }
 
-syntax_abstract_tree_t *parenthesis_expression(FILE *fd) {
-    expect_token("Left parenthesis", SYN_TOKEN_LEFT_PARENTHESIS);
-    GET_NEXT_TOKEN(fd)
-    syntax_abstract_tree_t *tree = expression(fd, 0);
-    expect_token("Right parenthesis", SYN_TOKEN_RIGHT_PARENTHESIS);
-    GET_NEXT_TOKEN(fd)
+syntax_abstract_tree_t *parenthesis_expression(syntax_context_t *context) {
+    expect_token(context, "Left parenthesis", SYN_TOKEN_LEFT_PARENTHESIS);
+    GET_NEXT_TOKEN(context)
+    syntax_abstract_tree_t *tree = expression(context, 0);
+    expect_token(context, "Right parenthesis", SYN_TOKEN_RIGHT_PARENTHESIS);
+    GET_NEXT_TOKEN(context)
     return tree;
 }
 
-syntax_abstract_tree_t *expression(FILE *fd, int precedence) {
+syntax_abstract_tree_t *expression(syntax_context_t *context, int precedence) {
     syntax_abstract_tree_t *x = NULL, *node;
     syntax_tree_token_type op;
 
-    switch (lexical_token->type) {
+    switch (context->token.type) {
         case LEFT_PARENTHESIS:
-            x = parenthesis_expression(fd);
+            x = parenthesis_expression(context);
             break;
         case MINUS:
         case PLUS:
-            op = get_token_type(lexical_token->type);
-            GET_NEXT_TOKEN(fd)
-            node = expression(fd, attributes[SYN_TOKEN_NEGATE].precedence);
+            op = get_token_type(context->token.type);
+            GET_NEXT_TOKEN(context)
+            node = expression(context, attributes[SYN_TOKEN_NEGATE].precedence);
             x = (op == SYN_TOKEN_SUB) ? make_binary_node(SYN_NODE_NEGATE, node, NULL) : node;
             break;
         case LOGICAL_NOT: {
-            GET_NEXT_TOKEN(fd)
-            node = expression(fd, attributes[SYN_TOKEN_NOT].precedence);
+            GET_NEXT_TOKEN(context)
+            node = expression(context, attributes[SYN_TOKEN_NOT].precedence);
             x = make_binary_node(SYN_NODE_NOT, node, NULL);
             break;
         }
         case IDENTIFIER: {
-            bool is_variable = lexical_token->value[0] == '$';
+            bool is_variable = lexical_span_view(context->source, &context->token).ptr[0] == '$';
             if (is_variable) {
-                x = make_binary_leaf(SYN_NODE_IDENTIFIER, string_init(lexical_token->value));
-                GET_NEXT_TOKEN(fd)
+                x = TOKEN_IDENTIFIER(context);
+                GET_NEXT_TOKEN(context)
             } else {
                 x = make_binary_node(SYN_NODE_CALL,
-                                     make_binary_leaf(SYN_NODE_IDENTIFIER, string_init(lexical_token->value)), NULL);
-                GET_NEXT_TOKEN(fd)
-                for (expect_token("Left parenthesis", SYN_TOKEN_LEFT_PARENTHESIS);; expect_token("Comma",
+                                     TOKEN_IDENTIFIER(context), NULL);
+                GET_NEXT_TOKEN(context)
+                for (expect_token(context, "Left parenthesis", SYN_TOKEN_LEFT_PARENTHESIS);; expect_token(context, "Comma",
                                                                                                  SYN_TOKEN_COMMA)) {
-                    GET_NEXT_TOKEN(fd)
-                    if (get_token_type(lexical_token->type) == SYN_TOKEN_RIGHT_PARENTHESIS)
+                    GET_NEXT_TOKEN(context)
+                    if (get_token_type(context->token.type) == SYN_TOKEN_RIGHT_PARENTHESIS)
                         break;
-                    x->right = make_binary_node(SYN_NODE_ARGS, expression(fd, 0), x->right);
-                    if (get_token_type(lexical_token->type) == SYN_TOKEN_RIGHT_PARENTHESIS)
+                    x->right = make_binary_node(SYN_NODE_ARGS, expression(context, 0), x->right);
+                    if (get_token_type(context->token.type) == SYN_TOKEN_RIGHT_PARENTHESIS)
                         break;
-                    expect_token("Comma", SYN_TOKEN_COMMA);
+                    expect_token(context, "Comma", SYN_TOKEN_COMMA);
                 }
-                GET_NEXT_TOKEN(fd)
+                GET_NEXT_TOKEN(context)
             }
             break;
         }
         case KEYWORD_NULL:
             x = make_binary_leaf(SYN_NODE_KEYWORD_NULL, NULL);
-            GET_NEXT_TOKEN(fd)
+            GET_NEXT_TOKEN(context)
             break;
         case INTEGER:
-            x = make_binary_leaf(SYN_NODE_INTEGER, string_init(lexical_token->value));
-            GET_NEXT_TOKEN(fd)
+            x = make_binary_leaf(SYN_NODE_INTEGER, TOKEN_VALUE(context));
+            x->number = context->token.number;
+            GET_NEXT_TOKEN(context)
             break;
         case FLOAT:
-            x = make_binary_leaf(SYN_NODE_FLOAT, string_init(lexical_token->value));
-            GET_NEXT_TOKEN(fd)
+            x = make_binary_leaf(SYN_NODE_FLOAT, TOKEN_VALUE(context));
+            x->number = context->token.number;
+            GET_NEXT_TOKEN(context)
             break;
         case STRING:
-            x = make_binary_leaf(SYN_NODE_STRING, string_init(lexical_token->value));
-            GET_NEXT_TOKEN(fd)
+            x = make_binary_leaf(SYN_NODE_STRING, lexical_span_string(context->source, &context->token));
+            GET_NEXT_TOKEN(context)
             break;
         default: {
-            SYNTAX_ERROR("Expected expression, got: %s\n", get_readable_error_char(lexical_token->value))
+            SYNTAX_ERROR("Expected expression, got: %s\n", get_readable_error_char(TOKEN_VALUE(context)->value))
         }
     }
 
 
-    while (attributes[get_token_type(lexical_token->type)].is_binary &&
-           attributes[get_token_type(lexical_token->type)].precedence >= precedence) {
-        syntax_tree_token_type internal_op = get_token_type(lexical_token->type);
+    while (attributes[get_token_type(context->token.type)].is_binary &&
+           attributes[get_token_type(context->token.type)].precedence >= precedence) {
+        syntax_tree_token_type internal_op = get_token_type(context->token.type);
 
-        GET_NEXT_TOKEN(fd)
+        GET_NEXT_TOKEN(context)
 
         int q = attributes[internal_op].precedence;
         if (!attributes[internal_op].right_associative) q++;
 
-        node = expression(fd, q);
+        node = expression(context, q);
         x = make_binary_node(attributes[internal_op].node_type, x, node);
     }
 
     return x;
 }
 
-syntax_abstract_tree_t *args(FILE *fd) {
+syntax_abstract_tree_t *args(syntax_context_t *context) {
     syntax_abstract_tree_t *tree = NULL, *node;
 
-    if (get_token_type(lexical_token->type) == SYN_TOKEN_RIGHT_PARENTHESIS) {
-        GET_NEXT_TOKEN(fd)
+    if (get_token_type(context->token.type) == SYN_TOKEN_RIGHT_PARENTHESIS) {
+        GET_NEXT_TOKEN(context)
         return NULL;
     }
 
-    tree = make_binary_node(SYN_NODE_ARGS, expression(fd, 0), NULL);
+    tree = make_binary_node(SYN_NODE_ARGS, expression(context, 0), NULL);
 
-    while (get_token_type(lexical_token->type) == SYN_TOKEN_COMMA) {
-        expect_token("Comma", SYN_TOKEN_COMMA);
-        GET_NEXT_TOKEN(fd)
-        node = expression(fd, 0);
+    while (get_token_type(context->token.type) == SYN_TOKEN_COMMA) {
+        expect_token(context, "Comma", SYN_TOKEN_COMMA);
+        GET_NEXT_TOKEN(context)
+        node = expression(context, 0);
         tree = make_binary_node(SYN_NODE_ARGS, node, tree);
     }
 
-    GET_NEXT_TOKEN(fd)
+    GET_NEXT_TOKEN(context)
 
     return tree;
 }
 
-syntax_abstract_tree_t *stmt(FILE *fd) {
+/**
+ * Parses statements into a sequence node
+ * @param context Parse context
+ * @param end Token ending the statements, the end of file ends them too
+ * @return Sequence node, NULL if there are no statements
+ */
+static syntax_abstract_tree_t *statement_block(syntax_context_t *context, LEXICAL_FSM_TOKENS end) {
+    syntax_abstract_tree_t **statements = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+
+    while (context->token.type != end && context->token.type != END_OF_FILE) {
+        syntax_abstract_tree_t *statement = stmt(context);
+
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : SYNTAX_BLOCK_MIN_CAPACITY;
+            syntax_abstract_tree_t **resized = (syntax_abstract_tree_t **) realloc(
+                    statements, capacity * sizeof(syntax_abstract_tree_t *));
+            if (resized == NULL) {
+                INTERNAL_ERROR("Failed to allocate memory for syntax tree block")
+            }
+
+            statements = resized;
+        }
+
+        statements[count++] = statement;
+    }
+
+    syntax_abstract_tree_t *tree = count ? make_block_node(statements, count) : NULL;
+    free(statements);
+
+    return tree;
+}
+
+syntax_abstract_tree_t *stmt(syntax_context_t *context) {
     syntax_abstract_tree_t *tree = NULL, *v, *e, *s, *s2;
 
-    switch (lexical_token->type) {
+    switch (context->token.type) {
         case IDENTIFIER: {
-            v = make_binary_leaf(SYN_NODE_IDENTIFIER, string_init(lexical_token->value));
-            bool is_variable = lexical_token->value[0] == '$';
-            GET_NEXT_TOKEN(fd)
+            v = TOKEN_IDENTIFIER(context);
+            bool is_variable = lexical_span_view(context->source, &context->token).ptr[0] == '$';
+            GET_NEXT_TOKEN(context)
             if (is_variable) {
-                syntax_tree_token_type current_token_type = get_token_type(lexical_token->type);
+                syntax_tree_token_type current_token_type = get_token_type(context->token.type);
                 if (current_token_type != SYN_TOKEN_ASSIGN && current_token_type != SYN_TOKEN_SEMICOLON) {
                     SYNTAX_ERROR("Expected assignment or semicolon, got: %s\n",
-                                 get_readable_error_char(lexical_token->value))
+                                 get_readable_error_char(TOKEN_VALUE(context)->value))
                 }
 
                 if (current_token_type == SYN_TOKEN_SEMICOLON) {
                     tree = v;
-                    GET_NEXT_TOKEN(fd)
+                    GET_NEXT_TOKEN(context)
                     break;
                 }
             } else {
-                expect_token("Left parenthesis", SYN_TOKEN_LEFT_PARENTHESIS);
+                expect_token(context, "Left parenthesis", SYN_TOKEN_LEFT_PARENTHESIS);
             }
-            GET_NEXT_TOKEN(fd)
-            e = is_variable ? expression(fd, 0) : args(fd);
+            GET_NEXT_TOKEN(context)
+            e = is_variable ? expression(context, 0) : args(context);
             tree = make_binary_node(is_variable ? SYN_NODE_ASSIGN : SYN_NODE_CALL, v, e);
-            expect_token("Semicolon", SYN_TOKEN_SEMICOLON);
-            GET_NEXT_TOKEN(fd)
+            expect_token(context, "Semicolon", SYN_TOKEN_SEMICOLON);
+            GET_NEXT_TOKEN(context)
             break;
         }
         case INTEGER: {
-            tree = expression(fd, 0);
-            expect_token("Semicolon", SYN_TOKEN_SEMICOLON);
-            GET_NEXT_TOKEN(fd)
+            tree = expression(context, 0);
+            expect_token(context, "Semicolon", SYN_TOKEN_SEMICOLON);
+            GET_NEXT_TOKEN(context)
             break;
         }
         case KEYWORD_IF: {
-            GET_NEXT_TOKEN(fd)
-            e = parenthesis_expression(fd);
-            bool exists_if_body = get_token_type(lexical_token->type) == SYN_TOKEN_LEFT_CURLY_BRACKETS;
-            s = stmt(fd);
+            GET_NEXT_TOKEN(context)
+            e = parenthesis_expression(context);
+            bool exists_if_body = get_token_type(context->token.type) == SYN_TOKEN_LEFT_CURLY_BRACKETS;
+            s = stmt(context);
             if (s == NULL && exists_if_body)
                 s = make_binary_leaf(SYN_NODE_SEQUENCE, NULL);
             s2 = NULL;
-            if (lexical_token->type == KEYWORD_ELSE) {
-                GET_NEXT_TOKEN(fd)
-                bool curly_braces = get_token_type(lexical_token->type) == SYN_TOKEN_LEFT_CURLY_BRACKETS;
-                s2 = stmt(fd);
+            if (context->token.type == KEYWORD_ELSE) {
+                GET_NEXT_TOKEN(context)
+                bool curly_braces = get_token_type(context->token.type) == SYN_TOKEN_LEFT_CURLY_BRACKETS;
+                s2 = stmt(context);
 
                 bool is_empty_statement = curly_braces && s2 == NULL;
 
@@ -414,117 +504,135 @@ syntax_abstract_tree_t *stmt(FILE *fd) {
                 SYNTAX_ERROR("Incorrect if statement\n")
             }
             if (tree->middle->type != SYN_NODE_SEQUENCE)
-                tree->middle = make_binary_node(SYN_NODE_SEQUENCE, NULL, tree->middle);
+                tree->middle = make_block_node(&tree->middle, 1);
             if (tree->right != NULL && tree->right->type != SYN_NODE_SEQUENCE &&
                 tree->right->type != SYN_NODE_KEYWORD_IF)
-                tree->right = make_binary_node(SYN_NODE_SEQUENCE, NULL, tree->right);
+                tree->right = make_block_node(&tree->right, 1);
             break;
         }
         case KEYWORD_WHILE: {
-            GET_NEXT_TOKEN(fd)
-            e = parenthesis_expression(fd);
-            bool curly_braces = get_token_type(lexical_token->type) == SYN_TOKEN_LEFT_CURLY_BRACKETS;
-            s = stmt(fd);
+            GET_NEXT_TOKEN(context)
+            e = parenthesis_expression(context);
+            bool curly_braces = get_token_type(context->token.type) == SYN_TOKEN_LEFT_CURLY_BRACKETS;
+            s = stmt(context);
             bool is_empty_statement = curly_braces && s == NULL;
             tree = make_binary_node(SYN_NODE_KEYWORD_WHILE, e, s);
             if (s == NULL && !is_empty_statement) {
                 SYNTAX_ERROR("Expected statement after while\n")
             }
             if (!s || s->type != SYN_NODE_SEQUENCE)
-                tree->right = make_binary_node(SYN_NODE_SEQUENCE, NULL, s);
+                tree->right = make_block_node(&s, 1);
             break;
         }
         case KEYWORD_FUNCTION: {
-            tree = f_dec_stats(fd);
+            tree = f_dec_stats(context);
             break;
         }
         case KEYWORD_RETURN: {
-            GET_NEXT_TOKEN(fd)
-            if (get_token_type(lexical_token->type) == SYN_TOKEN_SEMICOLON) {
+            GET_NEXT_TOKEN(context)
+            if (get_token_type(context->token.type) == SYN_TOKEN_SEMICOLON) {
                 tree = make_binary_node(SYN_NODE_KEYWORD_RETURN, NULL, make_binary_leaf(SYN_NODE_KEYWORD_VOID, NULL));
             } else {
-                tree = make_binary_node(SYN_NODE_KEYWORD_RETURN, NULL, expression(fd, 0));
-                expect_token("Semicolon", SYN_TOKEN_SEMICOLON);
+                tree = make_binary_node(SYN_NODE_KEYWORD_RETURN, NULL, expression(context, 0));
+                expect_token(context, "Semicolon", SYN_TOKEN_SEMICOLON);
             }
-            GET_NEXT_TOKEN(fd)
+            GET_NEXT_TOKEN(context)
             break;
         }
         case LEFT_CURLY_BRACKETS: {
-            expect_token("Left curly brackets", SYN_TOKEN_LEFT_CURLY_BRACKETS);
-            GET_NEXT_TOKEN(fd)
-            while (lexical_token->type != RIGHT_CURLY_BRACKETS && lexical_token->type != END_OF_FILE) {
-                tree = make_binary_node(SYN_NODE_SEQUENCE, tree, stmt(fd));
-            }
-            expect_token("Right curly brackets", SYN_TOKEN_RIGHT_CURLY_BRACKETS);
-            GET_NEXT_TOKEN(fd)
+            expect_token(context, "Left curly brackets", SYN_TOKEN_LEFT_CURLY_BRACKETS);
+            GET_NEXT_TOKEN(context)
+            tree = statement_block(context, RIGHT_CURLY_BRACKETS);
+            expect_token(context, "Right curly brackets", SYN_TOKEN_RIGHT_CURLY_BRACKETS);
+            GET_NEXT_TOKEN(context)
             break;
         }
         case END_OF_FILE: {
             break;
         }
         case CLOSE_PHP_BRACKET: {
-            lexical_token = get_token(fd);
+            GET_NEXT_TOKEN(context)
             break;
         }
         default: {
-            SYNTAX_ERROR("Expected statement, got: %s\n", lexical_token->value)
+            SYNTAX_ERROR("Expected statement, got: %s\n", TOKEN_VALUE(context)->value)
         }
     }
 
     return tree;
 }
 
-syntax_abstract_tree_t *load_syntax_tree(FILE *fd) {
-    GET_NEXT_TOKEN(fd)
+syntax_abstract_tree_t *load_syntax_tree_context(syntax_context_t *context) {
+    GET_NEXT_TOKEN(context)
 
-    expect_token("PHP Open bracket", SYN_TOKEN_PHP_OPEN);
-    lexical_token = get_token(fd);
+    expect_token(context, "PHP Open bracket", SYN_TOKEN_PHP_OPEN);
+    GET_NEXT_TOKEN(context)
 
-    if (lexical_token->type == KEYWORD_DECLARE) {
-        GET_NEXT_TOKEN(fd)
-        expect_token("Left parenthesis", SYN_TOKEN_LEFT_PARENTHESIS);
-        GET_NEXT_TOKEN(fd)
+    if (context->token.type == KEYWORD_DECLARE) {
+        GET_NEXT_TOKEN(context)
+        expect_token(context, "Left parenthesis", SYN_TOKEN_LEFT_PARENTHESIS);
+        GET_NEXT_TOKEN(context)
 
-        if (lexical_token->type != IDENTIFIER && strcmp(lexical_token->value, "strict_types") != 0) {
+        if (context->token.type != IDENTIFIER || context->token.number.atom != ATOM_STRICT_TYPES) {
             SYNTAX_ERROR("Expected strict types keyword\n")
         }
 
-        GET_NEXT_TOKEN(fd)
-        expect_token("Assignment", SYN_TOKEN_ASSIGN);
+        GET_NEXT_TOKEN(context)
+        expect_token(context, "Assignment", SYN_TOKEN_ASSIGN);
 
-        GET_NEXT_TOKEN(fd)
-        expect_token("Integer", SYN_TOKEN_INTEGER);
+        GET_NEXT_TOKEN(context)
+        expect_token(context, "Integer", SYN_TOKEN_INTEGER);
 
         // TODO: set other compiler variables depending on strict types value
 
-        GET_NEXT_TOKEN(fd)
-        expect_token("Right parenthesis", SYN_TOKEN_RIGHT_PARENTHESIS);
-        GET_NEXT_TOKEN(fd)
-        expect_token("Semicolon", SYN_TOKEN_SEMICOLON);
-        GET_NEXT_TOKEN(fd)
+        GET_NEXT_TOKEN(context)
+        expect_token(context, "Right parenthesis", SYN_TOKEN_RIGHT_PARENTHESIS);
+        GET_NEXT_TOKEN(context)
+        expect_token(context, "Semicolon", SYN_TOKEN_SEMICOLON);
+        GET_NEXT_TOKEN(context)
     } else {
         SYNTAX_ERROR("Expected declare keyword\n")
     }
 
-    syntax_abstract_tree_t *tree = NULL;
-
-    while (lexical_token->type != END_OF_FILE && lexical_token->type != CLOSE_PHP_BRACKET) {
-        tree = make_binary_node(SYN_NODE_SEQUENCE, tree, stmt(fd));
-    }
+    syntax_abstract_tree_t *tree = statement_block(context, CLOSE_PHP_BRACKET);
 
-    if (lexical_token->type != CLOSE_PHP_BRACKET && lexical_token->type != END_OF_FILE) {
-        SYNTAX_ERROR("Expected end of file, got: %s\n", lexical_token->value)
+    if (context->token.type != CLOSE_PHP_BRACKET && context->token.type != END_OF_FILE) {
+        SYNTAX_ERROR("Expected end of file, got: %s\n", TOKEN_VALUE(context)->value)
     } else {
-        lexical_token = get_token(fd);
+        GET_NEXT_TOKEN(context)
     }
 
-    if (lexical_token->type != END_OF_FILE) {
-        SYNTAX_ERROR("Expected end of file, got: %s\n", lexical_token->value)
+    if (context->token.type != END_OF_FILE) {
+        SYNTAX_ERROR("Expected end of file, got: %s\n", TOKEN_VALUE(context)->value)
     }
 
     return tree;
 }
 
+syntax_abstract_tree_t *load_syntax_tree_source(lexical_source_t *source) {
+    syntax_context_t context;
+    syntax_context_init(&context, source, NULL);
+
+    return load_syntax_tree_context(&context);
+}
+
+syntax_abstract_tree_t *load_syntax_tree_tokens(lexical_source_t *source) {
+    syntax_context_t context;
+    syntax_context_init(&context, source, lexical_stream_init(source));
+
+    syntax_abstract_tree_t *tree = load_syntax_tree_context(&context);
+    lexical_stream_free(context.stream);
+    return tree;
+}
+
+syntax_abstract_tree_t *load_syntax_tree(FILE *fd) {
+    lexical_source_t *source = lexical_source_open(fd);
+    syntax_abstract_tree_t *tree = load_syntax_tree_source(source);
+    lexical_source_close(source);
+
+    return tree;
+}
+
 syntax_tree_token_type get_token_type(LEXICAL_FSM_TOKENS token) {
     switch (token) {
         case END_OF_FILE:
@@ -618,7 +726,12 @@ syntax_tree_token_type get_token_type(LEXICAL_FSM_TOKENS token) {
 
 bool check_tree_using(syntax_abstract_tree_t *tree, bool (*check)(syntax_abstract_tree_t *)) {
     if (!tree) return true;
-    return check(tree) &&
+    if (!check(tree)) return false;
+
+    for (size_t i = 0; i < tree->statement_count; i++)
+        if (!check_tree_using(tree->statements[i], check)) return false;
+
+    return
            check_tree_using(tree->left, check) &&
            check_tree_using(tree->middle, check) &&
            check_tree_using(tree->right, check);
@@ -627,6 +740,10 @@ bool check_tree_using(syntax_abstract_tree_t *tree, bool (*check)(syntax_abstrac
 syntax_abstract_tree_t *get_from_tree_using(syntax_abstract_tree_t *tree, bool (*check)(syntax_abstract_tree_t *)) {
     if (!tree) return NULL;
     if (check(tree)) return tree;
+    for (size_t i = 0; i < tree->statement_count; i++) {
+        syntax_abstract_tree_t *statement = get_from_tree_using(tree->statements[i], check);
+        if (statement) return statement;
+    }
     syntax_abstract_tree_t *node = get_from_tree_using(tree->left, check);
     if (node) return node;
     node = get_from_tree_using(tree->middle, check);
@@ -643,6 +760,9 @@ void *process_tree_using(syntax_abstract_tree_t *tree, void (*process)(syntax_ab
     if (traversal_type == PREORDER)process(tree);
     process_tree_using(tree->left, process, traversal_type);
     if (traversal_type == INORDER)process(tree);
+    // statements are in place of the right child, so they are processed in a loop, not recursively
+    for (size_t i = 0; i < tree->statement_count; i++)
+        process_tree_using(tree->statements[i], process, traversal_type);
     process_tree_using(tree->middle, process, traversal_type);
     process_tree_using(tree->right, process, traversal_type);
     if (traversal_type == POSTORDER)process(tree);
@@ -669,12 +789,21 @@ bool compare_syntax_tree(syntax_abstract_tree_t *tree1, syntax_abstract_tree_t *
 
     if (tree1->type != tree2->type) return false;
 
+    if (tree1->type == SYN_NODE_IDENTIFIER && tree1->number.atom != tree2->number.atom) return false;
+
     if (tree1->value && tree2->value) {
-        if (strcmp(tree1->value->value, tree2->value->value) != 0) return false;
+        if (!string_view_equals(string_view_from_string(tree1->value), string_view_from_string(tree2->value)))
+            return false;
     } else if ((!tree1->value ^ !tree2->value) == 1) {
         return false;
     }
 
+    // sequences used to be compared as chains from their last statements
+    for (size_t i = 1; i <= tree1->statement_count && i <= tree2->statement_count; i++)
+        if (!compare_syntax_tree(tree1->statements[tree1->statement_count - i],
+                                 tree2->statements[tree2->statement_count - i]))
+            return false;
+
     return compare_syntax_tree(tree1->left, tree2->left) &&
            compare_syntax_tree(tree1->middle, tree2->middle) &&
            compare_syntax_tree(tree1->right, tree2->right);
@@ -683,29 +812,43 @@ bool compare_syntax_tree(syntax_abstract_tree_t *tree1, syntax_abstract_tree_t *
 syntax_abstract_tree_t *tree_copy(syntax_abstract_tree_t *tree) {
     if (!tree) return NULL;
 
-    syntax_abstract_tree_t *new_tree = (syntax_abstract_tree_t *) malloc(sizeof(syntax_abstract_tree_t));
+    syntax_abstract_tree_t *new_tree = alloc_syntax_tree_node();
     new_tree->type = tree->type;
-    new_tree->value = tree->value != NULL ? string_init(tree->value->value) : NULL;
+    // identifiers are never modified in place, so the copy can share them; literals are converted in place
+    if (tree->value == NULL || tree->type == SYN_NODE_IDENTIFIER)
+        new_tree->value = tree->value;
+    else
+        new_tree->value = string_init_view(string_view_from_string(tree->value));
+    new_tree->attrs = tree->attrs;
+    new_tree->number = tree->number;
     new_tree->left = tree_copy(tree->left);
     new_tree->middle = tree_copy(tree->middle);
     new_tree->right = tree_copy(tree->right);
+    new_tree->statements = NULL;
+    new_tree->statement_count = tree->statement_count;
+
+    if (tree->statement_count != 0) {
+        new_tree->statements = (syntax_abstract_tree_t **) arena_alloc(
+                syntax_tree_arena, tree->statement_count * sizeof(syntax_abstract_tree_t *));
+        if (new_tree->statements == NULL) {
+            INTERNAL_ERROR("Failed to allocate memory for syntax tree block")
+        }
+
+        for (size_t i = 0; i < tree->statement_count; i++)
+            new_tree->statements[i] = tree_copy(tree->statements[i]);
+    }
 
     return new_tree;
 }
 
-void free_syntax_tree(syntax_abstract_tree_t *tree) {
-    if (!tree) return;
+double get_node_number(syntax_abstract_tree_t *tree) {
+    if (tree->type == SYN_NODE_INTEGER) return (double) tree->number.integer;
+    if (tree->type == SYN_NODE_FLOAT) return tree->number.floating;
 
-    free_syntax_tree(tree->left);
-    free_syntax_tree(tree->middle);
-    free_syntax_tree(tree->right);
+    return 0;
+}
 
-    // TODO: check why sometimes makes SEGFAULT
-//    if (tree->attrs != NULL) {
-//        free(tree->attrs);
-//        tree->attrs = NULL;
-//    }
-//    string_free(tree->value);
-    tree->value = NULL;
-    free(tree);
+void dispose_syntax_trees() {
+    arena_destroy(syntax_tree_arena);
+    syntax_tree_arena = NULL;
 }
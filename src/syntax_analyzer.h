@@ -14,10 +14,18 @@
 #include <stdbool.h>
 #include "errors.h"
 #include "lexical_fsm.h"
+#include "lexical_stream.h"
 
-#define GET_NEXT_TOKEN(fd) \
-    free_lexical_token(lexical_token); \
-    lexical_token = get_token(fd);
+#define SYNTAX_BLOCK_MIN_CAPACITY 16
+
+#define GET_NEXT_TOKEN(context) \
+    get_next_syntax_token(context);
+
+/**
+ * Copies value of the current token, used where the parser keeps the value or reports it
+ */
+#define TOKEN_VALUE(context) lexical_span_value((context)->source, &(context)->token)
+#define TOKEN_IDENTIFIER(context) make_identifier_leaf(TOKEN_VALUE(context), (context)->token.number.atom)
 /**
  * Syntax non-terminal symbols enumeration
  */
@@ -116,13 +124,19 @@ typedef enum {
     POSTORDER,
 } syntax_tree_traversal_type;
 
-typedef struct syntax_abstract_tree_attr syntax_abstract_tree_attr_t;
-
 typedef struct syntax_abstract_tree syntax_abstract_tree_t;
 
-struct syntax_abstract_tree_attr {
+/**
+ * @struct syntax_abstract_tree_attr_t
+ * Attributes of a syntax tree node
+ *
+ * @var syntax_abstract_tree_attr_t::token_type
+ * Declared type of function arguments and return values
+ */
+typedef struct syntax_abstract_tree_attr {
     syntax_tree_token_type token_type;
-};
+} syntax_abstract_tree_attr_t;
+
 /**
  * @struct syntax_ast_t
  * Syntax abstract tree structure
@@ -130,25 +144,65 @@ struct syntax_abstract_tree_attr {
  * @var syntax_ast_t::type
  * Type of the node
  *
+ * @var syntax_ast_t::statement_count
+ * Number of statements of a sequence node
+ *
  * @var syntax_ast_t::left
  * Left child node
  *
  * @var syntax_ast_t::right
  * Right child node
  *
+ * @var syntax_ast_t::statements
+ * Statements of a sequence node in program order, removed statements are NULL. Sequence nodes have no children
+ *
  * @var syntax_ast_t::value
  * Value of the node
+ *
+ * @var syntax_ast_t::attrs
+ * Attributes of the node
+ *
+ * @var syntax_ast_t::number
+ * Numeric value of integer and float nodes, atom of identifier nodes
  */
 struct syntax_abstract_tree {
     syntax_tree_node_type type;
+    uint32_t statement_count;
     syntax_abstract_tree_t *left;
     syntax_abstract_tree_t *middle;
     syntax_abstract_tree_t *right;
+    syntax_abstract_tree_t **statements;
     string_t *value;
-    syntax_abstract_tree_attr_t *attrs;
+    syntax_abstract_tree_attr_t attrs;
+    lexical_number_t number;
 };
 
-static lexical_token_t *lexical_token;
+/**
+ * @struct syntax_context_t
+ * State of a single parse, so several sources can be parsed at once
+ *
+ * @var syntax_context_t::source
+ * Source being parsed
+ *
+ * @var syntax_context_t::stream
+ * Tokens of the source when it was tokenized in advance, NULL if tokens are read from the source
+ *
+ * @var syntax_context_t::token
+ * Current token
+ */
+typedef struct syntax_context {
+    lexical_source_t *source;
+    lexical_stream_t *stream;
+    lexical_span_t token;
+} syntax_context_t;
+
+/**
+ * Initializes parse context
+ * @param context Context to initialize
+ * @param source Source code
+ * @param stream Tokens of the source, NULL to read tokens from the source
+ */
+void syntax_context_init(syntax_context_t *context, lexical_source_t *source, lexical_stream_t *stream);
 
 /**
  * Makes a new syntax abstract tree node
@@ -161,7 +215,15 @@ syntax_abstract_tree_t *
 make_binary_node(syntax_tree_node_type type, syntax_abstract_tree_t *left, syntax_abstract_tree_t *right);
 
 /**
- * Makes a new syntax abstract tree node without children
+ * Makes a new sequence node holding a block of statements
+ * @param statements Statements of the block, they are copied
+ * @param count Number of statements
+ * @return New syntax abstract tree node
+ */
+syntax_abstract_tree_t *make_block_node(syntax_abstract_tree_t **statements, size_t count);
+
+/**
+ * Makes a new syntax abstract tree node without children. Names of identifier nodes are interned
  * @param type Type of the node
  * @param value Value of the node
  * @return New syntax abstract tree node
@@ -169,11 +231,26 @@ make_binary_node(syntax_tree_node_type type, syntax_abstract_tree_t *left, synta
 syntax_abstract_tree_t *make_binary_leaf(syntax_tree_node_type type, string_t *value);
 
 /**
- * Checks if the token matches the expected token, otherwise throws an error
+ * Makes a new identifier node with a name interned in advance
+ * @param value Name of the identifier
+ * @param atom Atom of the name
+ * @return New syntax abstract tree node
+ */
+syntax_abstract_tree_t *make_identifier_leaf(string_t *value, atom_t atom);
+
+/**
+ * Reads next token into the current token, from the token stream when the source was tokenized in advance
+ * @param context Parse context
+ */
+void get_next_syntax_token(syntax_context_t *context);
+
+/**
+ * Checks if the current token matches the expected token, otherwise throws an error
+ * @param context Parse context
  * @param msg Error message
  * @param type Expected token type
  */
-void expect_token(const char *msg, syntax_tree_token_type type);
+void expect_token(syntax_context_t *context, const char *msg, syntax_tree_token_type type);
 
 /**
  * Converts lexical analyzer token to syntax analyzer token
@@ -184,47 +261,68 @@ syntax_tree_token_type get_token_type(LEXICAL_FSM_TOKENS token);
 
 /**
  * Parse function declaration arguments
- * @param fd File descriptor
+ * @param context Parse context
  * @param args Syntax abstract tree with current/next argument
  * @return Syntax abstract tree with all arguments
  */
-syntax_abstract_tree_t *f_args(FILE *fd, syntax_abstract_tree_t *args);
+syntax_abstract_tree_t *f_args(syntax_context_t *context, syntax_abstract_tree_t *args);
 
 /**
  * Parse function declaration
- * @param fd File descriptor
+ * @param context Parse context
  * @return Syntax abstract tree with function declaration
  */
-syntax_abstract_tree_t *f_dec_stats(FILE *fd);
+syntax_abstract_tree_t *f_dec_stats(syntax_context_t *context);
 
 /**
  * Parses expression in brackets
- * @param fd File descriptor
+ * @param context Parse context
  * @return Syntax abstract tree with expression in brackets
  */
-syntax_abstract_tree_t *parenthesis_expression(FILE *fd);
+syntax_abstract_tree_t *parenthesis_expression(syntax_context_t *context);
 
 /**
  * Parses expression
- * @param fd File descriptor
+ * @param context Parse context
  * @param precedence Precedence
  * @return Syntax abstract tree with expression
  */
-syntax_abstract_tree_t *expression(FILE *fd, int precedence);
+syntax_abstract_tree_t *expression(syntax_context_t *context, int precedence);
 
 /**
  * Parses function call arguments
- * @param fd File descriptor
+ * @param context Parse context
  * @return Syntax abstract tree with function call arguments
  */
-syntax_abstract_tree_t *args(FILE *fd);
+syntax_abstract_tree_t *args(syntax_context_t *context);
 
 /**
  * Parses statement non-terminal
- * @param fd File descriptor
+ * @param context Parse context
  * @return Syntax abstract tree with statement
  */
-syntax_abstract_tree_t *stmt(FILE *fd);
+syntax_abstract_tree_t *stmt(syntax_context_t *context);
+
+/**
+ * Parses all tree using parse context
+ * @param context Parse context
+ * @return Syntax abstract tree with all tree
+ */
+syntax_abstract_tree_t *load_syntax_tree_context(syntax_context_t *context);
+
+/**
+ * Parses all tree from source
+ * @param source Source code
+ * @return Syntax abstract tree with all tree
+ */
+syntax_abstract_tree_t *load_syntax_tree_source(lexical_source_t *source);
+
+/**
+ * Parses all tree from source, which is tokenized as a whole before parsing
+ * @param source Source code
+ * @return Syntax abstract tree with all tree
+ */
+syntax_abstract_tree_t *load_syntax_tree_tokens(lexical_source_t *source);
 
 /**
  * Parses all tree from file stream
@@ -235,7 +333,8 @@ syntax_abstract_tree_t *load_syntax_tree(FILE *fd);
 
 
 /**
- * Prints the syntax abstract tree using the inorder traversal
+ * Prints the syntax abstract tree using the inorder traversal. Sequence node is printed before each of its
+ * statements, as the former chains of sequence nodes were
  * @param output Output file stream
  * @param tree Syntax abstract tree
  */
@@ -284,9 +383,16 @@ bool compare_syntax_tree(syntax_abstract_tree_t *tree1, syntax_abstract_tree_t *
 syntax_abstract_tree_t *tree_copy(syntax_abstract_tree_t *tree);
 
 /**
- * Frees the syntax abstract tree
- * @param tree Syntax abstract tree
+ * Gets numeric value of integer or float node
+ * @param tree Syntax abstract tree node
+ * @return Value of the node, 0 for other nodes
+ */
+double get_node_number(syntax_abstract_tree_t *tree);
+
+/**
+ * Frees all syntax tree nodes created by the calling thread. Nodes are allocated from an arena, so removed subtrees
+ * are simply unlinked and released here together with the rest
  */
-void free_syntax_tree(syntax_abstract_tree_t *tree);
+void dispose_syntax_trees();
 
 #endif //IFJ_PROJ_SYNTAX_ANALYZER_H
@@ -0,0 +1,254 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22.
+ * @authors
+ *   xmoise01, Nikita Moiseev
+ *
+ * @file syntax_tree_pool.c
+ * @brief Compact index-based syntax tree storage
+ * @date 17.10.2026
+ */
+
+#include "syntax_tree_pool.h"
+#include "errors.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Resizes all node arrays of the pool
+ * @param pool pointer to the pool
+ * @param capacity new number of nodes
+ */
+static void syntax_tree_pool_resize(syntax_tree_pool_t *pool, size_t capacity) {
+    uint8_t *kinds = (uint8_t *) realloc(pool->kinds, capacity * sizeof(uint8_t));
+    if (kinds == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for syntax tree pool");
+    }
+    pool->kinds = kinds;
+
+    uint8_t *token_types = (uint8_t *) realloc(pool->token_types, capacity * sizeof(uint8_t));
+    if (token_types == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for syntax tree pool");
+    }
+    pool->token_types = token_types;
+
+    syntax_node_index_t *lefts = (syntax_node_index_t *) realloc(pool->lefts, capacity * sizeof(syntax_node_index_t));
+    if (lefts == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for syntax tree pool");
+    }
+    pool->lefts = lefts;
+
+    syntax_node_index_t *middles = (syntax_node_index_t *) realloc(pool->middles,
+                                                                   capacity * sizeof(syntax_node_index_t));
+    if (middles == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for syntax tree pool");
+    }
+    pool->middles = middles;
+
+    syntax_node_index_t *rights = (syntax_node_index_t *) realloc(pool->rights, capacity * sizeof(syntax_node_index_t));
+    if (rights == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for syntax tree pool");
+    }
+    pool->rights = rights;
+
+    syntax_node_payload_t *payloads = (syntax_node_payload_t *) realloc(pool->payloads,
+                                                                        capacity * sizeof(syntax_node_payload_t));
+    if (payloads == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for syntax tree pool");
+    }
+    pool->payloads = payloads;
+
+    pool->capacity = capacity;
+}
+
+/**
+ * Appends string value to the pool text
+ * @param pool pointer to the pool
+ * @param value value bytes
+ * @param length number of bytes
+ * @return offset of the value in the pool text
+ */
+static uint32_t syntax_tree_pool_append_text(syntax_tree_pool_t *pool, const char *value, size_t length) {
+    if (pool->text_length + length > UINT32_MAX) {
+        INTERNAL_ERROR("String values are too large for syntax tree pool");
+    }
+
+    if (pool->text_length + length > pool->text_capacity) {
+        size_t capacity = pool->text_capacity ? pool->text_capacity * 2 : SYNTAX_TREE_POOL_MIN_CAPACITY;
+        while (capacity < pool->text_length + length) capacity *= 2;
+
+        char *text = (char *) realloc(pool->text, capacity);
+        if (text == NULL) {
+            INTERNAL_ERROR("Failed to allocate memory for syntax tree pool");
+        }
+
+        pool->text = text;
+        pool->text_capacity = capacity;
+    }
+
+    uint32_t offset = (uint32_t) pool->text_length;
+    memcpy(pool->text + offset, value, length);
+    pool->text_length += length;
+
+    return offset;
+}
+
+/**
+ * Reserves contiguous statement indices
+ * @param pool pointer to the pool
+ * @param count number of statements
+ * @return index of the first statement in the pool statements
+ */
+static uint32_t syntax_tree_pool_reserve_statements(syntax_tree_pool_t *pool, size_t count) {
+    if (pool->statement_count + count > UINT32_MAX) {
+        INTERNAL_ERROR("Blocks are too large for syntax tree pool");
+    }
+
+    if (pool->statement_count + count > pool->statement_capacity) {
+        size_t capacity = pool->statement_capacity ? pool->statement_capacity * 2 : SYNTAX_TREE_POOL_MIN_CAPACITY;
+        while (capacity < pool->statement_count + count) capacity *= 2;
+
+        syntax_node_index_t *statements = (syntax_node_index_t *) realloc(pool->statements,
+                                                                          capacity * sizeof(syntax_node_index_t));
+        if (statements == NULL) {
+            INTERNAL_ERROR("Failed to allocate memory for syntax tree pool");
+        }
+
+        pool->statements = statements;
+        pool->statement_capacity = capacity;
+    }
+
+    uint32_t first = (uint32_t) pool->statement_count;
+    pool->statement_count += count;
+
+    return first;
+}
+
+syntax_tree_pool_t *syntax_tree_pool_init() {
+    syntax_tree_pool_t *pool = (syntax_tree_pool_t *) calloc(1, sizeof(syntax_tree_pool_t));
+    if (pool == NULL) {
+        INTERNAL_ERROR("Failed to allocate memory for syntax tree pool");
+    }
+
+    syntax_tree_pool_resize(pool, SYNTAX_TREE_POOL_MIN_CAPACITY);
+
+    // reserved node, so children can use zero as no node
+    pool->kinds[0] = 0;
+    pool->token_types[0] = SYN_TOKEN_EOF;
+    pool->lefts[0] = pool->middles[0] = pool->rights[0] = SYNTAX_NODE_NONE;
+    pool->payloads[0].integer = 0;
+    pool->count = 1;
+
+    return pool;
+}
+
+syntax_node_index_t syntax_tree_pool_add(syntax_tree_pool_t *pool, syntax_tree_node_type type,
+                                         syntax_node_index_t left, syntax_node_index_t middle,
+                                         syntax_node_index_t right) {
+    if (pool->count == UINT32_MAX) {
+        INTERNAL_ERROR("Syntax tree is too large for syntax tree pool");
+    }
+    if (pool->count == pool->capacity) syntax_tree_pool_resize(pool, pool->capacity * 2);
+
+    uint8_t kind = 0;
+    while (kind < 31 && ((unsigned) type >> kind) != 1) kind++;
+
+    syntax_node_index_t index = (syntax_node_index_t) pool->count++;
+    pool->kinds[index] = kind;
+    pool->token_types[index] = SYN_TOKEN_EOF;
+    pool->lefts[index] = left;
+    pool->middles[index] = middle;
+    pool->rights[index] = right;
+    pool->payloads[index].integer = 0;
+
+    return index;
+}
+
+syntax_node_index_t syntax_tree_pool_from_tree(syntax_tree_pool_t *pool, syntax_abstract_tree_t *tree) {
+    if (!tree) return SYNTAX_NODE_NONE;
+
+    // parent is added before its children, so walks go forward through the arrays
+    syntax_node_index_t index = syntax_tree_pool_add(pool, tree->type, SYNTAX_NODE_NONE, SYNTAX_NODE_NONE,
+                                                     SYNTAX_NODE_NONE);
+    pool->token_types[index] = (uint8_t) tree->attrs.token_type;
+
+    switch (tree->type) {
+        case SYN_NODE_INTEGER:
+            pool->payloads[index].integer = tree->number.integer;
+            break;
+        case SYN_NODE_FLOAT:
+            pool->payloads[index].floating = tree->number.floating;
+            break;
+        case SYN_NODE_IDENTIFIER:
+            pool->payloads[index].atom = tree->number.atom;
+            break;
+        case SYN_NODE_STRING: {
+            uint32_t offset = syntax_tree_pool_append_text(pool, tree->value->value, tree->value->length);
+            pool->payloads[index].text.offset = offset;
+            pool->payloads[index].text.length = (uint32_t) tree->value->length;
+            break;
+        }
+        case SYN_NODE_SEQUENCE: {
+            // statements of one block stay contiguous, nested blocks reserve their own range later
+            uint32_t first = syntax_tree_pool_reserve_statements(pool, tree->statement_count);
+            pool->payloads[index].block.first = first;
+            pool->payloads[index].block.count = tree->statement_count;
+
+            for (uint32_t i = 0; i < tree->statement_count; i++) {
+                syntax_node_index_t statement = syntax_tree_pool_from_tree(pool, tree->statements[i]);
+                pool->statements[first + i] = statement;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    // arrays can move while children are added
+    syntax_node_index_t left = syntax_tree_pool_from_tree(pool, tree->left);
+    pool->lefts[index] = left;
+    syntax_node_index_t middle = syntax_tree_pool_from_tree(pool, tree->middle);
+    pool->middles[index] = middle;
+    syntax_node_index_t right = syntax_tree_pool_from_tree(pool, tree->right);
+    pool->rights[index] = right;
+
+    return index;
+}
+
+void syntax_tree_pool_process(syntax_tree_pool_t *pool, syntax_node_index_t index,
+                              void (*process)(syntax_tree_pool_t *, syntax_node_index_t),
+                              syntax_tree_traversal_type traversal_type) {
+    if (index == SYNTAX_NODE_NONE) return;
+
+    if (traversal_type == PREORDER) process(pool, index);
+    syntax_tree_pool_process(pool, pool->lefts[index], process, traversal_type);
+    if (traversal_type == INORDER) process(pool, index);
+    if (syntax_tree_pool_type(pool, index) == SYN_NODE_SEQUENCE) {
+        syntax_node_payload_t block = pool->payloads[index];
+        for (uint32_t i = 0; i < block.block.count; i++)
+            syntax_tree_pool_process(pool, pool->statements[block.block.first + i], process, traversal_type);
+    }
+    syntax_tree_pool_process(pool, pool->middles[index], process, traversal_type);
+    syntax_tree_pool_process(pool, pool->rights[index], process, traversal_type);
+    if (traversal_type == POSTORDER) process(pool, index);
+}
+
+size_t syntax_tree_pool_bytes(const syntax_tree_pool_t *pool) {
+    size_t node_size = 2 * sizeof(uint8_t) + 3 * sizeof(syntax_node_index_t) + sizeof(syntax_node_payload_t);
+
+    return sizeof(syntax_tree_pool_t) + pool->count * node_size + pool->statement_count * sizeof(syntax_node_index_t) +
+           pool->text_length;
+}
+
+void syntax_tree_pool_free(syntax_tree_pool_t *pool) {
+    if (pool == NULL) return;
+
+    free(pool->kinds);
+    free(pool->token_types);
+    free(pool->lefts);
+    free(pool->middles);
+    free(pool->rights);
+    free(pool->payloads);
+    free(pool->statements);
+    free(pool->text);
+    free(pool);
+}
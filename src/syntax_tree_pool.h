@@ -0,0 +1,194 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22.
+ * @authors
+ *   xmoise01, Nikita Moiseev
+ *
+ * @file syntax_tree_pool.h
+ * @brief Compact index-based syntax tree storage
+ * @date 17.10.2026
+ */
+
+#ifndef IFJ_PROJ_SYNTAX_TREE_POOL_H
+#define IFJ_PROJ_SYNTAX_TREE_POOL_H
+
+#include <stdint.h>
+#include "syntax_analyzer.h"
+
+#define SYNTAX_TREE_POOL_MIN_CAPACITY 256
+
+/**
+ * Index of a node in a pool, SYNTAX_NODE_NONE marks a missing child
+ */
+typedef uint32_t syntax_node_index_t;
+
+#define SYNTAX_NODE_NONE ((syntax_node_index_t) 0)
+
+/**
+ * @union syntax_node_payload_t
+ * Literal value stored inline in a pool node
+ *
+ * @var syntax_node_payload_t::integer
+ * Value of integer nodes
+ *
+ * @var syntax_node_payload_t::floating
+ * Value of float nodes
+ *
+ * @var syntax_node_payload_t::atom
+ * Name of identifier nodes
+ *
+ * @var syntax_node_payload_t::text
+ * Offset and length of string node value in the pool text
+ *
+ * @var syntax_node_payload_t::block
+ * First index and number of sequence node statements in the pool statements
+ */
+typedef union syntax_node_payload {
+    int64_t integer;
+    double floating;
+    atom_t atom;
+    struct {
+        uint32_t offset;
+        uint32_t length;
+    } text;
+    struct {
+        uint32_t first;
+        uint32_t count;
+    } block;
+} syntax_node_payload_t;
+
+/**
+ * @struct syntax_tree_pool_t
+ * Syntax tree nodes stored as structure of arrays, nodes refer to their children by 32-bit indices. Node 0 is
+ * reserved, so a zero index means no child
+ *
+ * @var syntax_tree_pool_t::kinds
+ * Bit index of the node type, the type is 1 << kind
+ *
+ * @var syntax_tree_pool_t::token_types
+ * Declared type of function arguments and return values
+ *
+ * @var syntax_tree_pool_t::lefts
+ * Left child indices
+ *
+ * @var syntax_tree_pool_t::middles
+ * Middle child indices
+ *
+ * @var syntax_tree_pool_t::rights
+ * Right child indices
+ *
+ * @var syntax_tree_pool_t::payloads
+ * Literal values of the nodes
+ *
+ * @var syntax_tree_pool_t::statements
+ * Statement indices of all sequence nodes, removed statements are SYNTAX_NODE_NONE
+ *
+ * @var syntax_tree_pool_t::statement_count
+ * Number of used statement indices
+ *
+ * @var syntax_tree_pool_t::statement_capacity
+ * Number of allocated statement indices
+ *
+ * @var syntax_tree_pool_t::text
+ * Bytes of all string values
+ *
+ * @var syntax_tree_pool_t::text_length
+ * Number of used text bytes
+ *
+ * @var syntax_tree_pool_t::text_capacity
+ * Number of allocated text bytes
+ *
+ * @var syntax_tree_pool_t::count
+ * Number of nodes including the reserved one
+ *
+ * @var syntax_tree_pool_t::capacity
+ * Number of nodes the arrays can hold
+ */
+typedef struct syntax_tree_pool {
+    uint8_t *kinds;
+    uint8_t *token_types;
+    syntax_node_index_t *lefts;
+    syntax_node_index_t *middles;
+    syntax_node_index_t *rights;
+    syntax_node_payload_t *payloads;
+    syntax_node_index_t *statements;
+    size_t statement_count;
+    size_t statement_capacity;
+    char *text;
+    size_t text_length;
+    size_t text_capacity;
+    size_t count;
+    size_t capacity;
+} syntax_tree_pool_t;
+
+/**
+ * Initializes empty pool
+ * @return pointer to the pool
+ */
+syntax_tree_pool_t *syntax_tree_pool_init();
+
+/**
+ * Adds node to the pool
+ * @param pool pointer to the pool
+ * @param type type of the node
+ * @param left left child index
+ * @param middle middle child index
+ * @param right right child index
+ * @return index of the node
+ */
+syntax_node_index_t syntax_tree_pool_add(syntax_tree_pool_t *pool, syntax_tree_node_type type,
+                                         syntax_node_index_t left, syntax_node_index_t middle,
+                                         syntax_node_index_t right);
+
+/**
+ * Copies a syntax tree into the pool
+ * @param pool pointer to the pool
+ * @param tree syntax tree
+ * @return index of the tree root, SYNTAX_NODE_NONE for empty tree
+ */
+syntax_node_index_t syntax_tree_pool_from_tree(syntax_tree_pool_t *pool, syntax_abstract_tree_t *tree);
+
+/**
+ * Gets type of a node
+ * @param pool pointer to the pool
+ * @param index node index
+ * @return type of the node
+ */
+static inline syntax_tree_node_type syntax_tree_pool_type(const syntax_tree_pool_t *pool, syntax_node_index_t index) {
+    return (syntax_tree_node_type) (1U << pool->kinds[index]);
+}
+
+/**
+ * Gets value of a string node
+ * @param pool pointer to the pool
+ * @param index node index
+ * @return value bytes, they are not null-terminated
+ */
+static inline const char *syntax_tree_pool_text(const syntax_tree_pool_t *pool, syntax_node_index_t index) {
+    return pool->text + pool->payloads[index].text.offset;
+}
+
+/**
+ * Processes pool tree using the given function
+ * @param pool pointer to the pool
+ * @param index root index
+ * @param process function called with every node
+ * @param traversal_type order the nodes are processed in
+ */
+void syntax_tree_pool_process(syntax_tree_pool_t *pool, syntax_node_index_t index,
+                              void (*process)(syntax_tree_pool_t *, syntax_node_index_t),
+                              syntax_tree_traversal_type traversal_type);
+
+/**
+ * Gets number of bytes held by the pool nodes and their values
+ * @param pool pointer to the pool
+ * @return number of used bytes
+ */
+size_t syntax_tree_pool_bytes(const syntax_tree_pool_t *pool);
+
+/**
+ * Frees the pool
+ * @param pool pointer to the pool
+ */
+void syntax_tree_pool_free(syntax_tree_pool_t *pool);
+
+#endif //IFJ_PROJ_SYNTAX_TREE_POOL_H
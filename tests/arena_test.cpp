@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+extern "C" {
+#include "../src/arena.h"
+#include "../src/arena.c"
+#include "../src/str.h"
+}
+
+namespace ifj {
+    namespace tests {
+        namespace {
+            class ArenaTest : public ::testing::Test {
+            protected:
+                arena_t *arena;
+
+                void SetUp() override {
+                    arena = arena_init();
+                }
+
+                void TearDown() override {
+                    set_compilation_arena(NULL);
+                    arena_destroy(arena);
+                }
+            };
+
+            TEST_F(ArenaTest, Alloc) {
+                char *first = (char *) arena_alloc(arena, 3);
+                char *second = (char *) arena_alloc(arena, 40);
+
+                EXPECT_EQ((size_t) first % ARENA_ALIGNMENT, 0);
+                EXPECT_EQ((size_t) second % ARENA_ALIGNMENT, 0);
+                EXPECT_EQ(second - first, ARENA_ALIGNMENT);
+                EXPECT_TRUE(arena_contains(arena, first));
+                EXPECT_TRUE(arena_contains(arena, second + 39));
+
+                int value = 0;
+                EXPECT_FALSE(arena_contains(arena, &value));
+            }
+
+            TEST_F(ArenaTest, LargeAlloc) {
+                char *small = (char *) arena_alloc(arena, 16);
+                char *large = (char *) arena_alloc(arena, ARENA_CHUNK_SIZE * 4);
+                memset(large, 'a', ARENA_CHUNK_SIZE * 4);
+
+                EXPECT_TRUE(arena_contains(arena, small));
+                EXPECT_TRUE(arena_contains(arena, large + ARENA_CHUNK_SIZE * 4 - 1));
+            }
+
+            TEST_F(ArenaTest, Reset) {
+                for (int i = 0; i < 100000; i++)
+                    arena_alloc(arena, 32);
+
+                arena_reset(arena);
+                EXPECT_EQ(arena->head->next, nullptr);
+                EXPECT_EQ(arena->head->used, 0);
+
+                char *reused = (char *) arena_alloc(arena, 32);
+                EXPECT_TRUE(arena_contains(arena, reused));
+            }
+
+            TEST_F(ArenaTest, CompilationMalloc) {
+                set_compilation_arena(arena);
+
+                char *first = (char *) compilation_malloc(10);
+                EXPECT_TRUE(arena_contains(arena, first));
+
+                char *resized = (char *) compilation_realloc(first, 10, 100);
+                EXPECT_EQ(resized, first);
+
+                compilation_free(resized);
+                EXPECT_EQ(compilation_malloc(10), first);
+
+                set_compilation_arena(NULL);
+                char *heap = (char *) compilation_malloc(10);
+                EXPECT_FALSE(arena_contains(arena, heap));
+                compilation_free(heap);
+            }
+
+            TEST_F(ArenaTest, Strings) {
+                set_compilation_arena(arena);
+
+                string_t *str = string_init("$$__TMP_");
+                EXPECT_TRUE(arena_contains(arena, str));
+
+                for (int i = 0; i < 1000; i++)
+                    string_append_int(str, i);
+
+                EXPECT_FALSE(STRING_IS_INLINE(str));
+                EXPECT_TRUE(arena_contains(arena, str->value));
+                EXPECT_EQ(strncmp(str->value, "$$__TMP_0123", 12), 0);
+
+                string_free(str);
+            }
+        }
+    }
+}
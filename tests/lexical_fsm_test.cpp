@@ -2,12 +2,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <unistd.h>
 
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wwritable-strings"
 extern "C" {
+#include "../src/arena.h"
 #include "../src/lexical_fsm.h"
 #include "../src/lexical_fsm.c"
+#include "../src/lexical_source.c"
+#include "../src/lexical_stream.c"
+#include "../src/atom_table.c"
 }
 
 namespace ifj {
@@ -17,7 +22,7 @@ namespace ifj {
             protected:
                 lexical_token_stack_t *token_stack;
                 string_t *token;
-                FILE *fd{};
+                lexical_source_t *source{};
 
                 LexicalAnalyzerTest() {
                     token_stack = lexical_token_stack_init();
@@ -25,9 +30,7 @@ namespace ifj {
                 }
 
                 ~LexicalAnalyzerTest() override {
-                    if (fd != nullptr) {
-                        fclose(fd);
-                    }
+                    lexical_source_close(source);
                 }
 
                 void SetUp() override {
@@ -49,13 +52,14 @@ namespace ifj {
 
                     va_end(tokens);
 
-                    fd = fmemopen(input, strlen(input), "r");
-                    LEXICAL_FSM_TOKENS token_type = get_next_token(fd, token);
+                    lexical_source_close(source);
+                    source = test_lex_input(input);
+                    LEXICAL_FSM_TOKENS token_type = get_next_token_source(source, token);
 
                     while (token_type != END_OF_FILE) {
                         string_t *token_value = string_init(token->value);
                         lexical_token_stack_push(token_stack, (lexical_token_t) {token_type, token_value->value});
-                        token_type = get_next_token(fd, token);
+                        token_type = get_next_token_source(source, token);
                     }
 
                     while (!lexical_token_stack_empty(token_stack)) {
@@ -234,6 +238,9 @@ namespace ifj {
                                (lexical_token_t) {IDENTIFIER, "$a"},
                                (lexical_token_t) {SEMICOLON, ";"}
                 );
+                EXPECT_EXIT(IsStackCorrect("$a & $b;", 0),
+                            ::testing::ExitedWithCode(LEXICAL_ERROR_CODE),
+                            "\\[LEXICAL ERROR\\] Invalid operator: &");
             }
 
             TEST_F(LexicalAnalyzerTest, RelationalOperators) {
@@ -261,6 +268,24 @@ namespace ifj {
                                (lexical_token_t) {IDENTIFIER, "$b"},
                                (lexical_token_t) {SEMICOLON, ";"}
                 );
+                IsStackCorrect("$a<$b>1;", 6,
+                               (lexical_token_t) {IDENTIFIER, "$a"},
+                               (lexical_token_t) {LESS, "<"},
+                               (lexical_token_t) {IDENTIFIER, "$b"},
+                               (lexical_token_t) {GREATER, ">"},
+                               (lexical_token_t) {INTEGER, "1"},
+                               (lexical_token_t) {SEMICOLON, ";"}
+                );
+                IsStackCorrect("($a<=$b)", 5,
+                               (lexical_token_t) {LEFT_PARENTHESIS, "("},
+                               (lexical_token_t) {IDENTIFIER, "$a"},
+                               (lexical_token_t) {LESS_EQUAL, "<="},
+                               (lexical_token_t) {IDENTIFIER, "$b"},
+                               (lexical_token_t) {RIGHT_PARENTHESIS, ")"}
+                );
+                EXPECT_EXIT(IsStackCorrect("$a <== $b;", 0),
+                            ::testing::ExitedWithCode(LEXICAL_ERROR_CODE),
+                            "\\[LEXICAL ERROR\\] Invalid operator: <==");
             }
 
             TEST_F(LexicalAnalyzerTest, ArithmeticExpressions) {
@@ -438,6 +463,24 @@ namespace ifj {
                                (lexical_token_t) {SEMICOLON, ";"},
                                (lexical_token_t) {RIGHT_CURLY_BRACKETS, "}"}
                 );
+                IsStackCorrect("?INT ?Float ?sTrInG ElSe WHILE rEtUrN VOID DECLARE", 8,
+                               (lexical_token_t) {KEYWORD_INTEGER, "?int"},
+                               (lexical_token_t) {KEYWORD_FLOAT, "?float"},
+                               (lexical_token_t) {KEYWORD_STRING, "?string"},
+                               (lexical_token_t) {KEYWORD_ELSE, "else"},
+                               (lexical_token_t) {KEYWORD_WHILE, "while"},
+                               (lexical_token_t) {KEYWORD_RETURN, "return"},
+                               (lexical_token_t) {KEYWORD_VOID, "void"},
+                               (lexical_token_t) {KEYWORD_DECLARE, "declare"}
+                );
+                IsStackCorrect("readString intval Iff nulls ?in $Var_A", 6,
+                               (lexical_token_t) {IDENTIFIER, "readstring"},
+                               (lexical_token_t) {IDENTIFIER, "intval"},
+                               (lexical_token_t) {IDENTIFIER, "iff"},
+                               (lexical_token_t) {IDENTIFIER, "nulls"},
+                               (lexical_token_t) {IDENTIFIER, "?in"},
+                               (lexical_token_t) {IDENTIFIER, "$Var_A"}
+                );
             }
 
             TEST_F(LexicalAnalyzerTest, NegativeExpressions) {
@@ -513,6 +556,36 @@ namespace ifj {
                 );
             }
 
+            TEST_F(LexicalAnalyzerTest, LongRuns) {
+                IsStackCorrect("$a = 1;                                        \n\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t$b"
+                               "// comment longer than a vector block with * and */ and \"quotes\"\n"
+                               "/* multi-line comment longer than a vector block * with ** stars **/"
+                               "\"double quoted string longer than a vector block with \\\" and ' and $\""
+                               "'single quoted string longer than a vector block with \\' and \" and $'"
+                               "/***/ $c", 8,
+                               (lexical_token_t) {IDENTIFIER, "$a"},
+                               (lexical_token_t) {ASSIGN, "="},
+                               (lexical_token_t) {INTEGER, "1"},
+                               (lexical_token_t) {SEMICOLON, ";"},
+                               (lexical_token_t) {IDENTIFIER, "$b"},
+                               (lexical_token_t) {STRING,
+                                                  "\"double quoted string longer than a vector block with \\\" and ' and $\""},
+                               (lexical_token_t) {STRING,
+                                                  "'single quoted string longer than a vector block with \\' and \" and $'"},
+                               (lexical_token_t) {IDENTIFIER, "$c"}
+                );
+
+                EXPECT_EXIT(IsStackCorrect("\"string longer than a vector block with \xC3\xA1 inside\"", 1,
+                                           (lexical_token_t) {STRING, ""}),
+                            ::testing::ExitedWithCode(LEXICAL_ERROR_CODE),
+                            "\\[LEXICAL ERROR\\] Invalid string format");
+
+                EXPECT_EXIT(IsStackCorrect("/* comment longer than a vector block without an end *", 1,
+                                           (lexical_token_t) {END_OF_FILE, ""}),
+                            ::testing::ExitedWithCode(LEXICAL_ERROR_CODE),
+                            "\\[LEXICAL ERROR\\] Unexpected end of file");
+            }
+
             TEST_F(LexicalAnalyzerTest, IntegerType) {
                 IsStackCorrect("$b = 62345;"
                                " 42  ", 5,
@@ -563,6 +636,243 @@ namespace ifj {
 
             }
 
+            TEST_F(LexicalAnalyzerTest, NumberValues) {
+                lexical_number_t number;
+                source = test_lex_input("62345 0.125 12E+2 1e5 1.5-2 2.5e-3 12345678901234567890.5");
+
+                EXPECT_EQ(get_next_token_number(source, token, &number), INTEGER);
+                EXPECT_EQ(number.integer, 62345);
+                EXPECT_EQ(get_next_token_number(source, token, &number), FLOAT);
+                EXPECT_EQ(number.floating, 0.125);
+                EXPECT_EQ(get_next_token_number(source, token, &number), FLOAT);
+                EXPECT_EQ(number.floating, 1200.0);
+                EXPECT_EQ(get_next_token_number(source, token, &number), FLOAT);
+                EXPECT_STREQ(token->value, "1e5");
+                EXPECT_EQ(number.floating, 1e5);
+                EXPECT_EQ(get_next_token_number(source, token, &number), FLOAT);
+                EXPECT_EQ(number.floating, 1.5);
+                EXPECT_EQ(get_next_token_number(source, token, &number), MINUS);
+                EXPECT_EQ(get_next_token_number(source, token, &number), INTEGER);
+                EXPECT_EQ(number.integer, 2);
+                EXPECT_EQ(get_next_token_number(source, token, &number), FLOAT);
+                EXPECT_EQ(number.floating, 2.5e-3);
+                EXPECT_EQ(get_next_token_number(source, token, &number), FLOAT);
+                EXPECT_EQ(number.floating, 12345678901234567890.5);
+                EXPECT_EQ(get_next_token_number(source, token, &number), END_OF_FILE);
+
+                // integers that do not fit into int64_t become floats
+                lexical_source_close(source);
+                source = test_lex_input("9223372036854775807 9223372036854775808 123456789012345678901234567890");
+                EXPECT_EQ(get_next_token_number(source, token, &number), INTEGER);
+                EXPECT_EQ(number.integer, INT64_MAX);
+                EXPECT_EQ(get_next_token_number(source, token, &number), FLOAT);
+                EXPECT_STREQ(token->value, "9223372036854775808");
+                EXPECT_EQ(number.floating, 9223372036854775808.0);
+                EXPECT_EQ(get_next_token_number(source, token, &number), FLOAT);
+                EXPECT_EQ(number.floating, 123456789012345678901234567890.0);
+                EXPECT_EQ(get_next_token_number(source, token, &number), END_OF_FILE);
+
+                EXPECT_EXIT(get_next_token_number(test_lex_input("99999999999999999999a"), token, &number),
+                            ::testing::ExitedWithCode(LEXICAL_ERROR_CODE),
+                            "\\[LEXICAL ERROR\\] Invalid integer number format");
+            }
+
+            TEST_F(LexicalAnalyzerTest, Spans) {
+                lexical_span_t span;
+                source = test_lex_input("<?PHP  $Value=WHILE 'a b'  ");
+
+                EXPECT_EQ(get_next_span(source, &span), OPEN_PHP_BRACKET);
+                EXPECT_EQ(span.offset, 0);
+                EXPECT_EQ(span.length, 5);
+                EXPECT_STREQ(lexical_span_value(source, &span)->value, "<?php");
+                EXPECT_EQ(get_next_span(source, &span), IDENTIFIER);
+                EXPECT_EQ(span.offset, 7);
+                EXPECT_EQ(span.length, 6);
+                EXPECT_EQ(lexical_span_view(source, &span).ptr, source->data + 7);
+                EXPECT_STREQ(lexical_span_value(source, &span)->value, "$Value");
+                EXPECT_EQ(get_next_span(source, &span), ASSIGN);
+                EXPECT_EQ(span.offset, 13);
+                EXPECT_EQ(get_next_span(source, &span), KEYWORD_WHILE);
+                EXPECT_EQ(span.length, 5);
+                EXPECT_STREQ(lexical_span_value(source, &span)->value, "while");
+                EXPECT_EQ(get_next_span(source, &span), STRING);
+                EXPECT_EQ(span.offset, 20);
+                EXPECT_EQ(span.length, 5);
+                EXPECT_EQ(get_next_span(source, &span), END_OF_FILE);
+                EXPECT_EQ(span.length, 0);
+            }
+
+            TEST_F(LexicalAnalyzerTest, StringValues) {
+                lexical_span_t span;
+                string_t *value;
+                source = test_lex_input("\"\" 'a b' \"tab\\tquote\\\"\\\\\" \"nul\\0end\" \"\\q!\"");
+
+                EXPECT_EQ(get_next_span(source, &span), STRING);
+                EXPECT_EQ(lexical_span_string(source, &span)->length, 0);
+                EXPECT_EQ(get_next_span(source, &span), STRING);
+                EXPECT_STREQ(lexical_span_string(source, &span)->value, "a b");
+                EXPECT_EQ(get_next_span(source, &span), STRING);
+                EXPECT_STREQ(lexical_span_string(source, &span)->value, "tab\tquote\"\\");
+                EXPECT_EQ(get_next_span(source, &span), STRING);
+                value = lexical_span_string(source, &span);
+                EXPECT_EQ(value->length, 7);
+                EXPECT_EQ(memcmp(value->value, "nul\0end", 7), 0);
+                EXPECT_EQ(get_next_span(source, &span), STRING);
+                EXPECT_STREQ(lexical_span_string(source, &span)->value, "!");
+            }
+
+            TEST_F(LexicalAnalyzerTest, TokenValueArena) {
+                source = test_lex_input("$a_rather_long_variable_name_outside_inline_buffer");
+                arena_t *arena = arena_init();
+                set_compilation_arena(arena);
+
+                lexical_token_t *token_value = get_token_source(source);
+                string_t *value = take_token_value(token_value);
+                EXPECT_FALSE(arena_contains(arena, token_value->value_string));
+                EXPECT_TRUE(arena_contains(arena, value));
+                EXPECT_TRUE(arena_contains(arena, value->value));
+                EXPECT_NE(value->value, token_value->value);
+
+                free_lexical_token(token_value);
+                EXPECT_STREQ(value->value, "$a_rather_long_variable_name_outside_inline_buffer");
+
+                set_compilation_arena(NULL);
+                arena_destroy(arena);
+            }
+
+            TEST_F(LexicalAnalyzerTest, Atoms) {
+                lexical_span_t first, second, third, function;
+                source = test_lex_input("$value $other $value Write");
+
+                EXPECT_EQ(get_next_span(source, &first), IDENTIFIER);
+                EXPECT_EQ(get_next_span(source, &second), IDENTIFIER);
+                EXPECT_EQ(get_next_span(source, &third), IDENTIFIER);
+                EXPECT_EQ(get_next_span(source, &function), IDENTIFIER);
+                EXPECT_NE(first.number.atom, ATOM_NONE);
+                EXPECT_NE(first.number.atom, second.number.atom);
+                EXPECT_EQ(first.number.atom, third.number.atom);
+                EXPECT_EQ(first.number.atom, atom_find("$value", 6));
+                EXPECT_STREQ(atom_name(second.number.atom), "$other");
+                EXPECT_EQ(atom_find("$missing", 8), ATOM_NONE);
+                EXPECT_EQ(atom_intern("write", 5), ATOM_WRITE);
+                EXPECT_EQ(function.number.atom, ATOM_WRITE);
+                EXPECT_EQ(atom_fold_case(atom_intern("WRite", 5)), ATOM_WRITE);
+                EXPECT_NE(atom_find("$Value", 6), first.number.atom);
+
+                // growing the table keeps earlier atoms
+                for (int i = 0; i < 10000; i++) {
+                    std::string name = "$name_" + std::to_string(i);
+                    EXPECT_EQ(atom_intern(name.c_str(), name.size()), atom_intern(name.c_str(), name.size()));
+                }
+                EXPECT_EQ(atom_find("$value", 6), first.number.atom);
+                EXPECT_STREQ(atom_name(atom_find("$name_9999", 10)), "$name_9999");
+            }
+
+            TEST_F(LexicalAnalyzerTest, Stream) {
+                lexical_span_t span;
+                source = test_lex_input("$a = 2.5; ?>");
+                lexical_stream_t *stream = lexical_stream_init(source);
+
+                EXPECT_EQ(stream->count, 6);
+                EXPECT_EQ(lexical_stream_peek(stream, 2), FLOAT);
+                EXPECT_EQ(lexical_stream_next(stream, &span), IDENTIFIER);
+                EXPECT_EQ(span.offset, 0);
+                EXPECT_EQ(span.length, 2);
+                EXPECT_EQ(lexical_stream_next(stream, &span), ASSIGN);
+                EXPECT_EQ(lexical_stream_next(stream, &span), FLOAT);
+                EXPECT_EQ(span.number.floating, 2.5);
+                EXPECT_STREQ(lexical_span_value(source, &span)->value, "2.5");
+                EXPECT_EQ(lexical_stream_next(stream, &span), SEMICOLON);
+                EXPECT_EQ(lexical_stream_next(stream, &span), CLOSE_PHP_BRACKET);
+                EXPECT_EQ(lexical_stream_next(stream, &span), END_OF_FILE);
+                EXPECT_EQ(lexical_stream_next(stream, &span), END_OF_FILE);
+                EXPECT_EQ(lexical_stream_peek(stream, 10), END_OF_FILE);
+
+                lexical_stream_free(stream);
+            }
+
+            TEST_F(LexicalAnalyzerTest, ParallelStream) {
+                // every line break is inside a comment or a string, so chunks start in all lexer states
+                std::string input = "<?php\n";
+                while (input.size() < 4 * LEXICAL_STREAM_MIN_CHUNK)
+                    input += "$a = 1.5e3; /* multi-line\n comment */ $b = \"string\n body\"; $c = 'single\n quoted';"
+                             " // comment\n";
+
+                source = test_lex_input((char *) input.c_str());
+                lexical_stream_t *serial = lexical_stream_init(source);
+                source->position = 0;
+                lexical_stream_t *parallel = lexical_stream_init_parallel(source, 4);
+
+                ASSERT_EQ(parallel->count, serial->count);
+                EXPECT_EQ(memcmp(parallel->types, serial->types, serial->count), 0);
+                EXPECT_EQ(memcmp(parallel->offsets, serial->offsets, serial->count * sizeof(uint32_t)), 0);
+                EXPECT_EQ(memcmp(parallel->lengths, serial->lengths, serial->count * sizeof(uint32_t)), 0);
+                EXPECT_EQ(memcmp(parallel->numbers, serial->numbers, serial->count * sizeof(lexical_number_t)), 0);
+                EXPECT_EQ(source->position, input.size() + 1);
+
+                lexical_stream_free(serial);
+                lexical_stream_free(parallel);
+
+                input.replace(input.find("1.5e3", 3 * LEXICAL_STREAM_MIN_CHUNK), 5, "1.5e ");
+                EXPECT_EXIT({
+                                source = test_lex_input((char *) input.c_str());
+                                lexical_stream_init_parallel(source, 4);
+                            },
+                            ::testing::ExitedWithCode(LEXICAL_ERROR_CODE),
+                            "\\[LEXICAL ERROR\\] Invalid float number format");
+            }
+
+            TEST_F(LexicalAnalyzerTest, Relex) {
+                struct {
+                    const char *before;
+                    const char *after;
+                    size_t offset;
+                    size_t removed;
+                    size_t inserted;
+                    size_t first;
+                    size_t removed_tokens;
+                    size_t inserted_tokens;
+                } cases[] = {
+                        // identifier grows, the rest of the line is reused
+                        {"$a = 1; $bc = 2; $d = 3;", "$a = 1; $bxc = 2; $d = 3;", 10, 0, 1, 4, 1, 1},
+                        // comment swallows tokens up to the token after the original comment end
+                        {"$a = 1; $b = 2; /* c */ $d = 3;", "$a = 1; /* $b = 2; /* c */ $d = 3;", 8, 0, 3, 4, 5, 1},
+                        {"$a = 1 + 2; $b = 3;", "$a = 1; $b = 3;", 6, 4, 0, 2, 3, 1},
+                        {"$a = 1; $b = 2;", "$a = 1; $b = 2; $c = 3;", 15, 0, 8, 7, 1, 5},
+                        {"$a = 1; $b = 2;", "$x = 1; $b = 2;", 1, 1, 1, 0, 1, 1},
+                        {"$a = 12; $b = 2;", "$a = 1.5; $b = 2;", 5, 2, 3, 2, 1, 1},
+                        // tokens ending at the old source end are lexed up to the new END_OF_FILE
+                        {"$a = 1;\n", "$a = 1;", 7, 1, 0, 3, 2, 2},
+                        {"//", "/", 1, 1, 0, 0, 1, 2},
+                        {"; if ", "; if", 4, 1, 0, 1, 2, 2},
+                };
+
+                for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+                    lexical_source_t *before = lexical_source_from_memory(cases[i].before, strlen(cases[i].before));
+                    lexical_source_t *after = lexical_source_from_memory(cases[i].after, strlen(cases[i].after));
+                    lexical_stream_t *stream = lexical_stream_init(before);
+
+                    lexical_stream_change_t change = lexical_stream_relex(stream, after, cases[i].offset,
+                                                                          cases[i].removed, cases[i].inserted);
+                    EXPECT_EQ(change.first, cases[i].first) << cases[i].after;
+                    EXPECT_EQ(change.removed, cases[i].removed_tokens) << cases[i].after;
+                    EXPECT_EQ(change.inserted, cases[i].inserted_tokens) << cases[i].after;
+
+                    after->position = 0;
+                    lexical_stream_t *fresh = lexical_stream_init(after);
+                    ASSERT_EQ(stream->count, fresh->count) << cases[i].after;
+                    EXPECT_EQ(memcmp(stream->types, fresh->types, fresh->count), 0);
+                    EXPECT_EQ(memcmp(stream->offsets, fresh->offsets, fresh->count * sizeof(uint32_t)), 0);
+                    EXPECT_EQ(memcmp(stream->lengths, fresh->lengths, fresh->count * sizeof(uint32_t)), 0);
+                    EXPECT_EQ(memcmp(stream->numbers, fresh->numbers, fresh->count * sizeof(lexical_number_t)), 0);
+
+                    lexical_stream_free(stream);
+                    lexical_stream_free(fresh);
+                    lexical_source_close(before);
+                    lexical_source_close(after);
+                }
+            }
+
             TEST_F(LexicalAnalyzerTest, StringType) {
                 IsStackCorrect("$a = \"abc\";", 4,
                                (lexical_token_t) {IDENTIFIER, "$a"},
@@ -852,6 +1162,61 @@ namespace ifj {
 
                 );
             }
+
+            TEST_F(LexicalAnalyzerTest, SourceFromFile) {
+                const char *input = "<?php\n$a = 5;";
+                FILE *file = tmpfile();
+                fputs(input, file);
+                rewind(file);
+                EXPECT_EQ(getc(file), '<');
+
+                lexical_source_t *file_source = lexical_source_open(file);
+
+                EXPECT_NE(file_source->mapping, nullptr);
+                EXPECT_EQ(file_source->length, strlen(input) - 1);
+                EXPECT_EQ(strncmp(file_source->data, input + 1, file_source->length), 0);
+
+                lexical_source_close(file_source);
+                fclose(file);
+            }
+
+            TEST_F(LexicalAnalyzerTest, SourceFromPipe) {
+                std::string input(3 * LEXICAL_SOURCE_READ_SIZE, ' ');
+                input += "$a = 5;";
+
+                int pipe_fds[2];
+                ASSERT_EQ(pipe(pipe_fds), 0);
+
+                if (fork() == 0) {
+                    close(pipe_fds[0]);
+                    write(pipe_fds[1], input.c_str(), input.length());
+                    close(pipe_fds[1]);
+                    _exit(0);
+                }
+
+                close(pipe_fds[1]);
+                FILE *file = fdopen(pipe_fds[0], "r");
+                lexical_source_t *pipe_source = lexical_source_open(file);
+
+                EXPECT_EQ(pipe_source->mapping, nullptr);
+                EXPECT_EQ(pipe_source->length, input.length());
+                EXPECT_EQ(get_next_token_source(pipe_source, token), IDENTIFIER);
+                EXPECT_STREQ(token->value, "$a");
+
+                lexical_source_close(pipe_source);
+                fclose(file);
+            }
+
+            TEST_F(LexicalAnalyzerTest, FileShim) {
+                char input[] = "$a = 5;";
+                FILE *file = fmemopen(input, strlen(input), "r");
+                LEXICAL_FSM_TOKENS expected[] = {IDENTIFIER, ASSIGN, INTEGER, SEMICOLON, END_OF_FILE};
+
+                for (LEXICAL_FSM_TOKENS type: expected)
+                    EXPECT_EQ(get_next_token(file, token), type);
+
+                fclose(file);
+            }
         }
     }
 }
@@ -26,6 +26,7 @@ namespace ifj {
 
                 void TearDown() override {
                     dispose_symtable();
+                    dispose_syntax_trees();
                 }
 
                 void CheckOptimisedTree(const std::string &input, const std::vector<int> &expected_output) {
@@ -37,7 +38,7 @@ namespace ifj {
                     char *actual = (char *) malloc(expected_str.length() + 1000);
                     output_fd = fmemopen(actual, expected_str.length() + 1000, "w");
 
-                    syntax_abstract_tree_t *tree = load_syntax_tree(test_lex_input((char *) input.c_str()));
+                    syntax_abstract_tree_t *tree = load_syntax_tree_source(test_lex_input((char *) input.c_str()));
                     semantic_tree_check(tree);
                     optimize_tree(tree);
                     syntax_abstract_tree_print(output_fd, tree);
@@ -63,6 +64,36 @@ namespace ifj {
                                    {SYN_NODE_SEQUENCE});
             }
 
+            TEST_F(OptimiserTest, FoldedNumbers) {
+                syntax_abstract_tree_t *tree = load_syntax_tree_source(
+                        test_lex_input((char *) "<?php declare(strict_types=1);"
+                                                "$a = 0.1 + 0.2; $b = 10 / 3; $c = 2 * 3; $d = 1.5 < 2;"));
+                semantic_tree_check(tree);
+
+                for (uint32_t i = 0; i < tree->statement_count; i++)
+                    process_tree_using(tree->statements[i]->right, optimize_expression, POSTORDER);
+
+                syntax_abstract_tree_t *sum = tree->statements[0]->right;
+                EXPECT_EQ(sum->type, SYN_NODE_FLOAT);
+                EXPECT_EQ(sum->number.floating, 0.1 + 0.2);
+                EXPECT_EQ(strtod(sum->value->value, NULL), sum->number.floating);
+
+                syntax_abstract_tree_t *quotient = tree->statements[1]->right;
+                EXPECT_EQ(quotient->type, SYN_NODE_FLOAT);
+                EXPECT_EQ(quotient->number.floating, 10.0 / 3);
+                EXPECT_EQ(strtod(quotient->value->value, NULL), quotient->number.floating);
+
+                syntax_abstract_tree_t *product = tree->statements[2]->right;
+                EXPECT_EQ(product->type, SYN_NODE_INTEGER);
+                EXPECT_EQ(product->number.integer, 6);
+                EXPECT_STREQ(product->value->value, "6");
+
+                syntax_abstract_tree_t *less = tree->statements[3]->right;
+                EXPECT_EQ(less->type, SYN_NODE_INTEGER);
+                EXPECT_EQ(less->number.integer, 1);
+                EXPECT_STREQ(less->value->value, "1");
+            }
+
             TEST_F(OptimiserTest, VariablesReplace) {
                 CheckOptimisedTree("<?php declare(strict_types=1);"
                                    "$a = 1;"
@@ -70,6 +101,41 @@ namespace ifj {
                                    {SYN_NODE_SEQUENCE, SYN_NODE_SEQUENCE,});
             }
 
+            TEST_F(OptimiserTest, VariablesReplaceBlock) {
+                syntax_abstract_tree_t *tree = load_syntax_tree_source(
+                        test_lex_input((char *) "<?php declare(strict_types=1);"
+                                                "$a = 1; $b = 2; $c = $a + $b; $a = 3; $d = $a * 2; $b = 2;"
+                                                "$e = $b - $a; while ($c < $a) { $c = $c + 1; } $f = 5; $f = 5;"
+                                                "if ($e < 0) { $g = $a + $e; } else { $g = 0; } $h = $a + $b;"));
+                semantic_tree_check(tree);
+
+                if (!optimiser_params)
+                    init_optimiser();
+                optimiser_params->root_tree = tree;
+
+                optimize_node(tree, OPTIMISE_EXPRESSION);
+                // $b is replaced after its last assignment of the same value only
+                EXPECT_EQ(tree->statements[2]->right->type, SYN_NODE_ADD);
+                EXPECT_EQ(tree->statements[2]->right->left->number.integer, 1);
+                EXPECT_EQ(tree->statements[2]->right->right->type, SYN_NODE_IDENTIFIER);
+                EXPECT_EQ(tree->statements[4]->right->type, SYN_NODE_INTEGER);
+                EXPECT_EQ(tree->statements[4]->right->number.integer, 6);
+                EXPECT_EQ(tree->statements[6]->right->type, SYN_NODE_INTEGER);
+                EXPECT_EQ(tree->statements[6]->right->number.integer, -1);
+                EXPECT_EQ(tree->statements[7]->left->left->type, SYN_NODE_IDENTIFIER);
+                EXPECT_EQ(tree->statements[10]->middle->statements[0]->right->type, SYN_NODE_INTEGER);
+                EXPECT_EQ(tree->statements[10]->middle->statements[0]->right->number.integer, 2);
+                // replacing stops at the if statement
+                EXPECT_EQ(tree->statements[11]->right->type, SYN_NODE_ADD);
+                EXPECT_EQ(optimiser_params->block_index, nullptr);
+
+                optimize_node(tree, OPTIMISE_UNUSED_VARIABLES);
+
+                EXPECT_NE(tree->statements[8], nullptr);
+                EXPECT_EQ(tree->statements[9], nullptr);
+                EXPECT_EQ(optimiser_params->block_index, nullptr);
+            }
+
             TEST_F(OptimiserTest, UnreachableIfElimination) {
                 CheckOptimisedTree("<?php"
                                    "declare(strict_types=1);"
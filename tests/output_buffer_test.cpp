@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <climits>
+
+extern "C" {
+#include "../src/output_buffer.h"
+#include "../src/output_buffer.c"
+}
+
+namespace ifj {
+    namespace tests {
+        namespace {
+            class OutputBufferTest : public ::testing::Test {
+            protected:
+                FILE *file;
+                output_buffer_t *buffer;
+
+                void SetUp() override {
+                    file = tmpfile();
+                    buffer = output_buffer_init(file);
+                }
+
+                void TearDown() override {
+                    output_buffer_free(buffer);
+                    fclose(file);
+                }
+
+                std::string read_file() {
+                    std::string result;
+                    char data[4096];
+                    size_t length;
+
+                    fflush(file);
+                    rewind(file);
+                    while ((length = fread(data, 1, sizeof(data), file)) > 0)
+                        result.append(data, length);
+
+                    return result;
+                }
+            };
+
+            TEST_F(OutputBufferTest, Append) {
+                OUTPUT_BUFFER_APPEND_LITERAL(buffer, "MOVE");
+                output_buffer_append_char(buffer, ' ');
+                output_buffer_append_cstr(buffer, "GF");
+                output_buffer_append_char(buffer, '@');
+                output_buffer_append(buffer, "abcdef", 1);
+                output_buffer_append_char(buffer, '\n');
+
+                EXPECT_EQ(buffer->length, 10);
+                EXPECT_EQ(read_file(), "");
+
+                output_buffer_flush(buffer);
+
+                EXPECT_EQ(buffer->length, 0);
+                EXPECT_EQ(read_file(), "MOVE GF@a\n");
+            }
+
+            TEST_F(OutputBufferTest, AppendInt) {
+                output_buffer_append_int(buffer, 0);
+                output_buffer_append_char(buffer, ' ');
+                output_buffer_append_int(buffer, -42);
+                output_buffer_append_char(buffer, ' ');
+                output_buffer_append_int(buffer, LLONG_MAX);
+                output_buffer_append_char(buffer, ' ');
+                output_buffer_append_int(buffer, LLONG_MIN);
+                output_buffer_flush(buffer);
+
+                EXPECT_EQ(read_file(), "0 -42 9223372036854775807 -9223372036854775808");
+            }
+
+            TEST_F(OutputBufferTest, Chunks) {
+                std::string expected;
+
+                for (int i = 0; i < 50000; i++) {
+                    OUTPUT_BUFFER_APPEND_LITERAL(buffer, "PUSHS int@");
+                    output_buffer_append_int(buffer, i);
+                    output_buffer_append_char(buffer, '\n');
+                    expected += "PUSHS int@" + std::to_string(i) + "\n";
+                }
+
+                EXPECT_NE(buffer->head, buffer->tail);
+                EXPECT_EQ(buffer->length, expected.length());
+
+                output_buffer_flush(buffer);
+
+                EXPECT_EQ(buffer->head, buffer->tail);
+                EXPECT_EQ(read_file(), expected);
+            }
+
+            TEST_F(OutputBufferTest, Threshold) {
+                buffer->threshold = OUTPUT_CHUNK_SIZE;
+                std::string data(OUTPUT_CHUNK_SIZE - 1, 'x');
+
+                output_buffer_append(buffer, data.c_str(), data.length());
+                EXPECT_EQ(buffer->length, data.length());
+
+                output_buffer_append_char(buffer, 'y');
+                EXPECT_EQ(buffer->length, 0);
+
+                OUTPUT_BUFFER_APPEND_LITERAL(buffer, "z");
+                output_buffer_flush(buffer);
+
+                EXPECT_EQ(read_file(), data + "yz");
+            }
+
+            TEST_F(OutputBufferTest, MemoryStream) {
+                char data[64] = {0};
+                FILE *stream = fmemopen(data, sizeof(data), "w");
+                output_buffer_t *memory_buffer = output_buffer_init(stream);
+
+                OUTPUT_BUFFER_APPEND_LITERAL(memory_buffer, ".IFJcode22\n");
+                output_buffer_flush(memory_buffer);
+                fflush(stream);
+
+                EXPECT_STREQ(data, ".IFJcode22\n");
+
+                output_buffer_free(memory_buffer);
+                fclose(stream);
+            }
+        }
+    }
+}
@@ -23,23 +23,23 @@ namespace ifj {
         namespace {
             class SemanticAnalysisTest : public ::testing::Test {
             protected:
-                FILE *fd{};
+                lexical_source_t *source{};
                 syntax_abstract_tree_t *tree{};
 
                 SemanticAnalysisTest() = default;
 
                 void TearDown() override {
-                    if (fd != nullptr) {
-                        fclose(fd);
-                    }
+                    lexical_source_close(source);
 
                     dispose_symtable();
+                    dispose_syntax_trees();
                 }
 
                 void ProcessInput(const std::string &input) {
-                    fd = test_lex_input((char *) input.c_str());
+                    lexical_source_close(source);
+                    source = test_lex_input((char *) input.c_str());
 
-                    tree = load_syntax_tree(fd);
+                    tree = load_syntax_tree_source(source);
                     semantic_tree_check(tree);
                 }
 
@@ -343,6 +343,25 @@ namespace ifj {
                                      }
                 );
 
+                CheckSymTableEntries("<?php declare(strict_types=1); function Foo(): void {}"
+                                     "foo(); WRITE(\"x\"); $S = STRLEN(\"abc\");",
+                                     {
+                                             (tree_node_t) {
+                                                     .defined = true,
+                                                     .key = "foo",
+                                             },
+                                             (tree_node_t) {
+                                                     .defined = true,
+                                                     .key = "write",
+                                             },
+                                             (tree_node_t) {
+                                                     .type = TYPE_INT,
+                                                     .defined = true,
+                                                     .key = "$S",
+                                             }
+                                     }
+                );
+
                 EXPECT_EXIT(CheckSymTableEntries("<?php declare(strict_types=1); strlen(\"a\", 2);", {}),
                             ::testing::ExitedWithCode(SEMANTIC_FUNC_ARG_ERROR_CODE),
                             "\\[SEMANTIC FUNC ARG ERROR\\] Wrong number of arguments");
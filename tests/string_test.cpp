@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <climits>
 
 extern "C" {
 #include "../src/str.h"
@@ -31,6 +32,29 @@ namespace ifj {
                 EXPECT_STREQ(str->value, "Hello world 123");
             }
 
+            TEST(String, AppendFormat) {
+                string_t *str = string_init("$$__TMP_");
+                string_append_format(str, "%d_%s_%s", 123456789, "a_rather_long_argument", "which_overflows");
+                EXPECT_STREQ(str->value, "$$__TMP_123456789_a_rather_long_argument_which_overflows");
+                EXPECT_EQ(str->length, strlen(str->value));
+            }
+
+            TEST(String, AppendInt) {
+                string_t *str = string_init("label");
+                string_append_int(str, 0);
+                string_append_int(str, 42);
+                string_append_int(str, -7);
+                string_append_int(str, LLONG_MIN);
+                EXPECT_STREQ(str->value, "label042-7-9223372036854775808");
+            }
+
+            TEST(String, AppendLiteral) {
+                string_t *str = string_init("loop1");
+                STRING_APPEND_LITERAL(str, "_cond");
+                EXPECT_STREQ(str->value, "loop1_cond");
+                EXPECT_EQ(str->length, 10);
+            }
+
             TEST(String, Clear) {
                 string_t *str = string_init("Hello world");
                 string_clear(str);
@@ -61,6 +85,141 @@ namespace ifj {
                 EXPECT_STREQ(str->value, "Hello World");
                 EXPECT_STREQ(substr->value, "Hello");
             }
+
+            TEST(String, StringSlice) {
+                string_t *str = string_init("\"Hello World\"");
+                string_view_t slice = string_slice(str, 1, str->length - 1);
+
+                EXPECT_EQ(slice.ptr, str->value + 1);
+                EXPECT_EQ(slice.len, 11);
+                EXPECT_TRUE(string_view_equals(slice, string_view_from_cstr("Hello World")));
+                EXPECT_EQ(string_slice(str, 3, 2).ptr, nullptr);
+                EXPECT_EQ(string_slice(str, 0, str->length + 1).ptr, nullptr);
+                EXPECT_EQ(string_substr(str, 5, 100), nullptr);
+                EXPECT_STREQ(string_substr(str, 7, 12)->value, "World");
+            }
+
+            TEST(String, Reserve) {
+                string_t *str = string_init("Hello");
+                string_reserve(str, 1024);
+                EXPECT_GE(str->capacity, 1024);
+                EXPECT_STREQ(str->value, "Hello");
+
+                char *reserved_value = str->value;
+                for (int i = 0; i < 1000; i++)
+                    string_append_char(str, 'a');
+                EXPECT_EQ(str->value, reserved_value);
+                EXPECT_EQ(str->length, 1005);
+            }
+
+            TEST(String, ShrinkToFit) {
+                string_t *str = string_init("Hello");
+                string_reserve(str, 1024);
+                string_shrink_to_fit(str);
+                EXPECT_TRUE(STRING_IS_INLINE(str));
+                EXPECT_STREQ(str->value, "Hello");
+
+                string_append_string(str, " world");
+                EXPECT_STREQ(str->value, "Hello world");
+            }
+
+            TEST(String, InlineValue) {
+                string_t *str = string_init("$$__TMP_12");
+                EXPECT_TRUE(STRING_IS_INLINE(str));
+
+                string_append_string(str, "_a_long_suffix_which_does_not_fit");
+                EXPECT_FALSE(STRING_IS_INLINE(str));
+                EXPECT_STREQ(str->value, "$$__TMP_12_a_long_suffix_which_does_not_fit");
+
+                string_replace(str, "label");
+                string_shrink_to_fit(str);
+                EXPECT_TRUE(STRING_IS_INLINE(str));
+                EXPECT_STREQ(str->value, "label");
+
+                string_free(str);
+            }
+
+            TEST(String, View) {
+                string_t *str = string_init("$abc");
+                string_view_t view = string_view_from_string(str);
+                string_view_t prefix = {"$abcd", 4};
+
+                EXPECT_TRUE(string_view_equals(view, prefix));
+                EXPECT_EQ(string_view_hash(view), string_view_hash(prefix));
+                EXPECT_EQ(string_view_compare(view, prefix), 0);
+                EXPECT_LT(string_view_compare(view, string_view_from_cstr("$abcd")), 0);
+                EXPECT_GT(string_view_compare(view, string_view_from_cstr("$ab")), 0);
+                EXPECT_LT(string_view_compare(string_view_from_cstr("$abb"), view), 0);
+                EXPECT_NE(string_view_hash(view), string_view_hash(string_view_from_cstr("$abd")));
+
+                string_t *copy = string_init_view(prefix);
+                EXPECT_STREQ(copy->value, "$abc");
+            }
+
+            TEST(String, GeometricGrowth) {
+                string_t *str = string_base_init();
+                int reallocations = 0;
+                size_t capacity = str->capacity;
+
+                for (int i = 0; i < (1 << 22); i++) {
+                    string_append_char(str, (char) ('a' + i % 26));
+                    if (str->capacity != capacity) {
+                        reallocations++;
+                        capacity = str->capacity;
+                    }
+                }
+
+                EXPECT_EQ(str->length, 1 << 22);
+                EXPECT_LE(reallocations, 24);
+                EXPECT_EQ(str->value[str->length], '\0');
+                EXPECT_EQ(str->value[27], 'b');
+            }
+
+            TEST(String, ToLower) {
+                string_t *str = string_init("WHILE_Function?INT@[`{~09 \xC1\xDA Declare(strict_types=1)");
+                string_to_lower(str);
+
+                EXPECT_STREQ(str->value, "while_function?int@[`{~09 \xC1\xDA declare(strict_types=1)");
+
+                string_t *short_str = string_init("NuLL");
+                string_to_lower(short_str);
+
+                EXPECT_STREQ(short_str->value, "null");
+            }
+
+            TEST(String, IsDigits) {
+                std::string digits(100, '7');
+
+                EXPECT_TRUE(string_is_digits(string_init(digits.c_str())));
+                EXPECT_TRUE(string_is_digits(string_init("0123456789")));
+                EXPECT_TRUE(string_is_digits(string_init("")));
+                EXPECT_FALSE(string_is_digits(string_init("12a4")));
+
+                for (size_t i = 0; i < digits.length(); i++) {
+                    std::string invalid = digits;
+                    invalid[i] = i % 2 ? '/' : ':';
+
+                    EXPECT_EQ(string_span_digits(invalid.c_str(), invalid.length()), i);
+                    EXPECT_FALSE(string_is_digits(string_init(invalid.c_str())));
+                }
+            }
+
+            TEST(String, IsIdentifier) {
+                std::string identifier = "abcdefghijklmnopqrstuvwxyz_ABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+
+                EXPECT_TRUE(string_is_identifier(string_init(identifier.c_str())));
+                EXPECT_FALSE(string_is_identifier(string_init("$var")));
+
+                const char invalid_chars[] = {'@', '[', '`', '{', '/', ':', '^', ' ', '$', (char) 0xC1};
+                for (char c: invalid_chars) {
+                    for (size_t i = 0; i < identifier.length(); i += 7) {
+                        std::string invalid = identifier;
+                        invalid[i] = c;
+
+                        EXPECT_EQ(string_span_identifier(invalid.c_str(), invalid.length()), i);
+                    }
+                }
+            }
         }
     }
 }
@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <thread>
 
 extern "C" {
 #include "../src/errors.h"
@@ -7,12 +8,36 @@ extern "C" {
 #include "../src/symtable.c"
 #include "../src/syntax_analyzer.h"
 #include "../src/syntax_analyzer.c"
+#include "../src/syntax_tree_pool.h"
+#include "../src/syntax_tree_pool.c"
 }
 
 
 namespace ifj {
     namespace tests {
         namespace {
+            std::vector<std::string> visited_nodes;
+
+            void visit_tree_node(syntax_abstract_tree_t *tree) {
+                std::string node = std::to_string(tree->type) + ":" + std::to_string(tree->attrs.token_type);
+                if (tree->type == SYN_NODE_INTEGER) node += ":" + std::to_string(tree->number.integer);
+                if (tree->type == SYN_NODE_FLOAT) node += ":" + std::to_string(tree->number.floating);
+                if (tree->type == SYN_NODE_IDENTIFIER) node += ":" + std::to_string(tree->number.atom);
+                if (tree->type == SYN_NODE_STRING) node += ":" + std::string(tree->value->value, tree->value->length);
+                visited_nodes.push_back(node);
+            }
+
+            void visit_pool_node(syntax_tree_pool_t *pool, syntax_node_index_t index) {
+                syntax_tree_node_type type = syntax_tree_pool_type(pool, index);
+                std::string node = std::to_string(type) + ":" + std::to_string(pool->token_types[index]);
+                if (type == SYN_NODE_INTEGER) node += ":" + std::to_string(pool->payloads[index].integer);
+                if (type == SYN_NODE_FLOAT) node += ":" + std::to_string(pool->payloads[index].floating);
+                if (type == SYN_NODE_IDENTIFIER) node += ":" + std::to_string(pool->payloads[index].atom);
+                if (type == SYN_NODE_STRING)
+                    node += ":" + std::string(syntax_tree_pool_text(pool, index), pool->payloads[index].text.length);
+                visited_nodes.push_back(node);
+            }
+
             class SyntaxAnalyzerTest : public ::testing::Test {
             protected:
                 FILE *output_fd{};
@@ -27,9 +52,11 @@ namespace ifj {
 
                 void TearDown() override {
                     dispose_symtable();
+                    dispose_syntax_trees();
                 }
 
-                void IsSyntaxTreeCorrect(const std::string &input, const std::vector<int> &expected_output) {
+                void IsSyntaxTreeCorrect(const std::string &input, const std::vector<int> &expected_output,
+                                         bool pre_tokenized = false) {
                     std::string expected_str;
 
                     for (auto &str: expected_output)
@@ -38,7 +65,9 @@ namespace ifj {
                     char *actual = (char *) malloc(expected_str.length() + 1000);
                     output_fd = fmemopen(actual, expected_str.length() + 1000, "w");
 
-                    syntax_abstract_tree_t *tree = load_syntax_tree(test_lex_input((char *) input.c_str()));
+                    lexical_source_t *source = test_lex_input((char *) input.c_str());
+                    syntax_abstract_tree_t *tree = pre_tokenized ? load_syntax_tree_tokens(source)
+                                                                 : load_syntax_tree_source(source);
                     syntax_abstract_tree_print(output_fd, tree);
 
                     fseek(output_fd, 0, SEEK_SET);
@@ -48,11 +77,76 @@ namespace ifj {
                 }
 
                 void SyntaxTreeWithError(const std::string &input) {
-                    syntax_abstract_tree_t *tree = load_syntax_tree(test_lex_input((char *) input.c_str()));
+                    syntax_abstract_tree_t *tree = load_syntax_tree_source(test_lex_input((char *) input.c_str()));
                     EXPECT_EQ(tree, nullptr);
                 }
             };
 
+            TEST_F(SyntaxAnalyzerTest, PreTokenized) {
+                IsSyntaxTreeCorrect("<?php declare(strict_types=1); $a = 12.2 + 32;",
+                                    {SYN_NODE_SEQUENCE, SYN_NODE_IDENTIFIER, SYN_NODE_ASSIGN, SYN_NODE_FLOAT,
+                                     SYN_NODE_ADD, SYN_NODE_INTEGER}, true);
+                IsSyntaxTreeCorrect("<?php declare(strict_types=1); $a = 1; f(1 + 2, $a); ?>",
+                                    {SYN_NODE_SEQUENCE, SYN_NODE_IDENTIFIER, SYN_NODE_ASSIGN, SYN_NODE_INTEGER,
+                                     SYN_NODE_SEQUENCE, SYN_NODE_IDENTIFIER, SYN_NODE_CALL, SYN_NODE_IDENTIFIER,
+                                     SYN_NODE_ARGS, SYN_NODE_INTEGER, SYN_NODE_ADD, SYN_NODE_INTEGER, SYN_NODE_ARGS},
+                                    true);
+
+                EXPECT_EXIT(load_syntax_tree_tokens(test_lex_input("<?php declare(strict_types=1); $a = ")),
+                            ::testing::ExitedWithCode(SYNTAX_ERROR_CODE),
+                            "\\[SYNTAX ERROR\\] Expected expression, got: EOF");
+            }
+
+            TEST_F(SyntaxAnalyzerTest, Contexts) {
+                lexical_source_t *first_source = test_lex_input("$a = 1; $b = 2;");
+                lexical_source_t *second_source = test_lex_input("f(1); $c = \"x\";");
+                syntax_context_t first, second;
+                syntax_context_init(&first, first_source, NULL);
+                syntax_context_init(&second, second_source, lexical_stream_init(second_source));
+
+                GET_NEXT_TOKEN(&first)
+                GET_NEXT_TOKEN(&second)
+                syntax_abstract_tree_t *first_a = stmt(&first);
+                syntax_abstract_tree_t *second_f = stmt(&second);
+                syntax_abstract_tree_t *first_b = stmt(&first);
+                syntax_abstract_tree_t *second_c = stmt(&second);
+
+                EXPECT_EQ(first_a->type, SYN_NODE_ASSIGN);
+                EXPECT_STREQ(first_a->left->value->value, "$a");
+                EXPECT_EQ(second_f->type, SYN_NODE_CALL);
+                EXPECT_STREQ(second_f->left->value->value, "f");
+                EXPECT_EQ(first_b->type, SYN_NODE_ASSIGN);
+                EXPECT_STREQ(first_b->left->value->value, "$b");
+                EXPECT_EQ(second_c->type, SYN_NODE_ASSIGN);
+                EXPECT_STREQ(second_c->right->value->value, "x");
+                EXPECT_EQ(first.token.type, END_OF_FILE);
+                EXPECT_EQ(second.token.type, END_OF_FILE);
+
+                lexical_stream_free(second.stream);
+                lexical_source_close(first_source);
+                lexical_source_close(second_source);
+
+                std::string program = "<?php declare(strict_types=1);";
+                for (int i = 0; i < 1000; i++)
+                    program += " $a = f($a * 2, \"s\") . 1.5; if ($a < 3) { $b = 1; } else { while ($b) { $b = $b - 1; } }";
+
+                // atoms belong to the thread, so every thread compares with its own stream-backed parse
+                bool equal[4];
+                std::vector<std::thread> threads;
+                for (auto &result: equal)
+                    threads.emplace_back([&result, &program]() {
+                        syntax_abstract_tree_t *tree = load_syntax_tree_source(test_lex_input((char *) program.c_str()));
+                        syntax_abstract_tree_t *expected = load_syntax_tree_tokens(
+                                test_lex_input((char *) program.c_str()));
+                        result = compare_syntax_tree(tree, expected);
+                        dispose_syntax_trees();
+                        atom_table_dispose();
+                    });
+                for (auto &thread: threads) thread.join();
+
+                for (bool result: equal) EXPECT_TRUE(result);
+            }
+
             TEST_F(SyntaxAnalyzerTest, Assignment) {
                 IsSyntaxTreeCorrect("<?php declare(strict_types=1); $a = 12 + 32;",
                                     {SYN_NODE_SEQUENCE, SYN_NODE_IDENTIFIER, SYN_NODE_ASSIGN, SYN_NODE_INTEGER,
@@ -539,6 +633,14 @@ namespace ifj {
                             ::testing::ExitedWithCode(SYNTAX_ERROR_CODE),
                             "\\[SYNTAX ERROR\\] PHP Open bracket Expecting <\\?php, found: INTEGER");
 
+                EXPECT_EXIT(IsSyntaxTreeCorrect("<?php declare(12=1); $a = 1;", {}),
+                            ::testing::ExitedWithCode(SYNTAX_ERROR_CODE),
+                            "\\[SYNTAX ERROR\\] Expected strict types keyword");
+
+                EXPECT_EXIT(IsSyntaxTreeCorrect("<?php declare(strict=1); $a = 1;", {}),
+                            ::testing::ExitedWithCode(SYNTAX_ERROR_CODE),
+                            "\\[SYNTAX ERROR\\] Expected strict types keyword");
+
                 EXPECT_EXIT(IsSyntaxTreeCorrect("<?php declare(strict_types=1); $a = 1; ?>;", {}),
                             ::testing::ExitedWithCode(LEXICAL_ERROR_CODE),
                             "\\[LEXICAL ERROR\\] Unexpected character: ;");
@@ -637,6 +739,53 @@ namespace ifj {
                                      SYN_NODE_KEYWORD_WHILE, SYN_NODE_SEQUENCE});
             }
 
+            TEST_F(SyntaxAnalyzerTest, FlatBlocks) {
+                // walks have to stay shallow for long programs
+                std::string program = "<?php declare(strict_types=1);";
+                for (int i = 0; i < 200000; i++) program += " write(1); $a = 2;";
+                program += " if (1) { $b = 1; {} } else { $c = 2; }";
+
+                syntax_abstract_tree_t *tree = load_syntax_tree_source(test_lex_input((char *) program.c_str()));
+                ASSERT_EQ(tree->type, SYN_NODE_SEQUENCE);
+                ASSERT_EQ(tree->statement_count, 400001);
+                EXPECT_EQ(tree->left, nullptr);
+                EXPECT_EQ(tree->right, nullptr);
+
+                syntax_abstract_tree_t *condition = tree->statements[400000];
+                ASSERT_EQ(condition->type, SYN_NODE_KEYWORD_IF);
+                EXPECT_EQ(condition->middle->statement_count, 2);
+                EXPECT_EQ(condition->middle->statements[1], nullptr);
+                EXPECT_EQ(condition->right->statement_count, 1);
+
+                visited_nodes.clear();
+                process_tree_using(tree, visit_tree_node, POSTORDER);
+                EXPECT_EQ(visited_nodes.size(), 200000 * 7 + 11);
+                EXPECT_TRUE(compare_syntax_tree(tree, tree_copy(tree)));
+            }
+
+            TEST_F(SyntaxAnalyzerTest, TreePool) {
+                syntax_abstract_tree_t *tree = load_syntax_tree_source(test_lex_input(
+                        "<?php declare(strict_types=1); function f(int $x, ?string $s): float { return $x * 1.5; }"
+                        " $a = f(2, \"s\\0t\"); if ($a >= 3) { write(\"\", $a); } else { while ($a) { $a = $a - 1; } }"));
+                syntax_tree_pool_t *pool = syntax_tree_pool_init();
+                syntax_node_index_t root = syntax_tree_pool_from_tree(pool, tree);
+
+                for (syntax_tree_traversal_type traversal: {PREORDER, INORDER, POSTORDER}) {
+                    visited_nodes.clear();
+                    process_tree_using(tree, visit_tree_node, traversal);
+                    std::vector<std::string> expected = visited_nodes;
+
+                    visited_nodes.clear();
+                    syntax_tree_pool_process(pool, root, visit_pool_node, traversal);
+                    EXPECT_EQ(visited_nodes, expected);
+                }
+
+                EXPECT_EQ(root, 1);
+                EXPECT_EQ(syntax_tree_pool_from_tree(pool, NULL), SYNTAX_NODE_NONE);
+                EXPECT_EQ(syntax_tree_pool_type(pool, root), tree->type);
+                syntax_tree_pool_free(pool);
+            }
+
             TEST_F(SyntaxAnalyzerTest, LogicalOperators) {
                 IsSyntaxTreeCorrect("<?php "
                                     "declare(strict_types=1);\n"
@@ -701,4 +850,4 @@ namespace ifj {
             }
         }
     }
-}
\ No newline at end of file
+}